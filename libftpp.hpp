@@ -15,9 +15,12 @@
  */
 
 // Data Structures
+#include "data_structures/byte_swap/byte_swap.hpp"
+#include "data_structures/chunk_pool/chunk_pool.hpp"
 #include "data_structures/data_buffer/data_buffer.hpp"
 #include "data_structures/data_structure.hpp"
 #include "data_structures/pool/pool.hpp"
+#include "data_structures/reflection/reflection.hpp"
 
 // Design Patterns
 #include "design_patterns/design_patterns.hpp"
@@ -28,10 +31,23 @@
 
 // Network
 #include "network/client/client.hpp"
+#include "network/client_pool/client_pool.hpp"
+#include "network/event_loop/event_loop.hpp"
+#include "network/frame_buffer/frame_buffer.hpp"
+#include "network/io_uring/io_uring.hpp"
+#include "network/latency_histogram/latency_histogram.hpp"
+#include "network/lz_codec/lz_codec.hpp"
 #include "network/message/message.hpp"
+#include "network/message_view/message_view.hpp"
+#include "network/net_stats/net_stats.hpp"
+#include "network/output_queue/output_queue.hpp"
+#include "network/reactor_server/reactor_server.hpp"
 #include "network/server/server.hpp"
+#include "network/timer_wheel/timer_wheel.hpp"
+#include "network/token_bucket/token_bucket.hpp"
 
 // Threading
+#include "thread/lock_free_queue/lock_free_queue.hpp"
 #include "thread/persistent_worker/persistent_worker.hpp"
 #include "thread/thread/thread.hpp"
 #include "thread/thread_safe_iostream/thread_safe_iostream.hpp"
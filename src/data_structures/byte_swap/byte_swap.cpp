@@ -0,0 +1,96 @@
+#include "byte_swap.hpp"
+
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BYTE_SWAP_X86 1
+#else
+#define BYTE_SWAP_X86 0
+#endif
+
+#if BYTE_SWAP_X86
+// Compile pour SSSE3 sans -mssse3: n'est appele que si le CPU l'a. Retourne les octets traites
+__attribute__((target("ssse3"))) static size_t swapBlocks(unsigned char*       dst,
+                                                          const unsigned char* src,
+                                                          size_t bytes, size_t width)
+{
+    __m128i mask;
+    if (width == 2)
+        mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    else if (width == 4)
+        mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    else
+        mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+
+    size_t done = 0;
+    for (; done + 16 <= bytes; done += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + done));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + done), _mm_shuffle_epi8(block, mask));
+    }
+    return done;
+}
+#endif
+
+template <typename Bits>
+static void swapScalar(unsigned char* dst, const unsigned char* src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        Bits value;
+        std::memcpy(&value, src + i * sizeof(Bits), sizeof(Bits));
+        value = ByteSwap::value(value);
+        std::memcpy(dst + i * sizeof(Bits), &value, sizeof(Bits));
+    }
+}
+
+/**
+ * @brief True if copy() runs on SSSE3 on this CPU.
+ */
+bool ByteSwap::vectorized()
+{
+#if BYTE_SWAP_X86
+    static const bool ssse3 = __builtin_cpu_supports("ssse3");
+    return ssse3;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Copy count elements of width bytes from src to dst, reversing the bytes of each one.
+ * @details dst may be src (in place), but the two must not partially overlap.
+ * @throw std::invalid_argument if width is not 1, 2, 4 or 8
+ */
+void ByteSwap::copy(void* dst, const void* src, size_t count, size_t width)
+{
+    unsigned char*       out = static_cast<unsigned char*>(dst);
+    const unsigned char* in  = static_cast<const unsigned char*>(src);
+
+    if (width != 1 && width != 2 && width != 4 && width != 8)
+        throw std::invalid_argument("ByteSwap: width must be 1, 2, 4 or 8");
+    if (width == 1)
+    {
+        if (out != in && count > 0)
+            std::memmove(out, in, count);
+        return;
+    }
+
+    size_t done = 0;
+#if BYTE_SWAP_X86
+    if (vectorized())
+        done = swapBlocks(out, in, count * width, width) / width;
+#endif
+
+    // Reste du dernier bloc de 16 octets, ou tout sans SSSE3
+    out += done * width;
+    in += done * width;
+    count -= done;
+    if (width == 2)
+        swapScalar<uint16_t>(out, in, count);
+    else if (width == 4)
+        swapScalar<uint32_t>(out, in, count);
+    else
+        swapScalar<uint64_t>(out, in, count);
+}
@@ -0,0 +1,69 @@
+#ifndef BYTE_SWAP_HPP
+#define BYTE_SWAP_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cstring>
+#include <type_traits>
+
+#define BYTE_SWAP_HOST_IS_LITTLE (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+/**
+ * @brief Byte order reversal, for one value or a whole array.
+ *
+ * copy() reverses each element of an array of 2, 4 or 8 byte elements (16 bytes at a time with
+ * SSSE3 when the CPU has it, checked once at run time) instead of one value per iteration: this
+ * is what DataBuffer's big endian reads and writes run on.
+ *
+ * @code
+ * uint32_t  wire = ByteSwap::value(uint32_t(0x11223344)); // 0x44332211
+ *
+ * std::vector<float> samples(4096);
+ * std::vector<float> swapped(samples.size());
+ * ByteSwap::copy(swapped.data(), samples.data(), samples.size());
+ * ByteSwap::copy(samples.data(), samples.data(), samples.size()); // In place is fine too
+ * @endcode
+ */
+class ByteSwap
+{
+public:
+    template <typename T>
+    static T value(T input)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "ByteSwap needs trivially copyable types");
+        static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8,
+                      "ByteSwap handles 1, 2, 4 and 8 byte types");
+
+        if constexpr (sizeof(T) == 1)
+            return input;
+        else
+        {
+            using Bits = std::conditional_t<
+                sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>;
+            Bits bits;
+            std::memcpy(&bits, &input, sizeof(T));
+            if constexpr (sizeof(T) == 2)
+                bits = __builtin_bswap16(bits);
+            else if constexpr (sizeof(T) == 4)
+                bits = __builtin_bswap32(bits);
+            else
+                bits = __builtin_bswap64(bits);
+            std::memcpy(&input, &bits, sizeof(T));
+            return input;
+        }
+    }
+
+    static void copy(void* dst, const void* src, size_t count, size_t width);
+
+    template <typename T>
+    static void copy(T* dst, const T* src, size_t count)
+    {
+        copy(static_cast<void*>(dst), static_cast<const void*>(src), count, sizeof(T));
+    }
+
+    static bool vectorized();
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "chunk_pool.hpp"
+
+#include <stdexcept>
+
+ChunkPool::ChunkPool(size_t chunkSize, size_t maxFree) : _chunkSize(chunkSize), _maxFree(maxFree)
+{
+    if (chunkSize == 0)
+        throw std::invalid_argument("ChunkPool: chunk size must be positive");
+
+    // _recycle() tourne dans un deleter: son push_back ne doit jamais allouer
+    _free.reserve(maxFree);
+}
+
+ChunkPool::~ChunkPool()
+{
+    for (std::vector<unsigned char>* chunk : _free)
+        delete chunk;
+}
+
+/**
+ * @brief An empty chunk of capacity chunkSize(), recycled or newly allocated.
+ */
+ChunkPool::Chunk ChunkPool::acquire()
+{
+    std::vector<unsigned char>* chunk = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_free.empty())
+        {
+            chunk = _free.back();
+            _free.pop_back();
+        }
+    }
+
+    if (!chunk)
+    {
+        chunk = new std::vector<unsigned char>();
+        chunk->reserve(_chunkSize);
+    }
+
+    // La derniere reference rend le chunk au pool, que la reference garde en vie
+    std::shared_ptr<ChunkPool> self = shared_from_this();
+    return Chunk(chunk, [self](std::vector<unsigned char>* released) { self->_recycle(released); });
+}
+
+void ChunkPool::_recycle(std::vector<unsigned char>* chunk)
+{
+    chunk->clear();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_free.size() < _maxFree)
+        {
+            _free.push_back(chunk);
+            return;
+        }
+    }
+    delete chunk;
+}
+
+size_t ChunkPool::chunkSize() const
+{
+    return _chunkSize;
+}
+
+/**
+ * @brief Chunks waiting to be reused.
+ */
+size_t ChunkPool::available() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _free.size();
+}
@@ -0,0 +1,59 @@
+#ifndef CHUNK_POOL_HPP
+#define CHUNK_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define CHUNK_POOL_CHUNK_SIZE 16384 // Octets par chunk
+#define CHUNK_POOL_MAX_FREE   256   // Chunks gardes pour etre recycles, les suivants sont liberes
+
+/**
+ * @brief Recycler of fixed-size byte chunks, the storage of a chunked DataBuffer.
+ *
+ * acquire() returns an empty std::vector whose capacity is chunkSize(): filling it up to that
+ * size never reallocates. Chunks are reference counted, and the last reference returns the
+ * vector to the pool (up to maxFree of them are kept) instead of freeing it, from any thread:
+ * a chunk handed to an OutputQueue comes back once the socket has taken it. Each chunk holds
+ * a reference on the pool, which outlives the DataBuffers and queues using it.
+ *
+ * @code
+ * std::shared_ptr<ChunkPool> pool = std::make_shared<ChunkPool>();
+ *
+ * DataBuffer buffer(pool);                 // Chunked DataBuffer
+ * buffer.append(bigPayload, bigSize);      // No reallocation, whatever the size
+ *
+ * for (const DataBuffer::Chunk& chunk : buffer.takeChunks())
+ *     outbox.push(chunk.data, chunk.offset); // Sent without copy, recycled once sent
+ * @endcode
+ *
+ * @note Must be owned by a std::shared_ptr (chunks keep the pool alive through it)
+ */
+class ChunkPool : public std::enable_shared_from_this<ChunkPool>
+{
+public:
+    using Chunk = std::shared_ptr<std::vector<unsigned char>>;
+
+private:
+    // Les chunks reviennent de n'importe quel thread
+    mutable std::mutex                       _mutex;
+    std::vector<std::vector<unsigned char>*> _free;
+    size_t                                   _chunkSize;
+    size_t                                   _maxFree;
+
+    void _recycle(std::vector<unsigned char>* chunk);
+
+public:
+    ChunkPool(size_t chunkSize = CHUNK_POOL_CHUNK_SIZE, size_t maxFree = CHUNK_POOL_MAX_FREE);
+    ~ChunkPool();
+
+    ChunkPool(const ChunkPool&)            = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+
+    Chunk  acquire();
+    size_t chunkSize() const;
+    size_t available() const;
+};
+
+#endif
@@ -1,7 +1,72 @@
 #include "data_buffer.hpp"
 
+#include <algorithm>
+
 DataBuffer::DataBuffer() : _cursor(0) {}
 
+/**
+ * @brief Chunked buffer: bytes are stored in chunks taken from pool (see ChunkPool).
+ */
+DataBuffer::DataBuffer(const std::shared_ptr<ChunkPool>& pool)
+    : _cursor(0), _autoCompact(true), _pool(pool)
+{
+    if (!pool)
+        throw std::invalid_argument("DataBuffer: null chunk pool");
+}
+
+// Les chunks ne sont pas partages: les deux buffers rempliraient le meme dernier chunk
+DataBuffer::DataBuffer(const DataBuffer& other)
+    : _buffer(other._buffer), _cursor(other._cursor), _autoCompact(other._autoCompact),
+      _encoding(other._encoding), _pool(other._pool), _chunkedSize(other._chunkedSize)
+{
+    for (const ChunkPool::Chunk& chunk : other._chunks)
+    {
+        _chunks.push_back(_pool->acquire());
+        _chunks.back()->assign(chunk->begin(), chunk->end());
+    }
+}
+
+DataBuffer& DataBuffer::operator=(const DataBuffer& other)
+{
+    if (this == &other)
+        return *this;
+
+    DataBuffer copy(other);
+    _buffer.swap(copy._buffer);
+    _chunks.swap(copy._chunks);
+    _pool        = copy._pool;
+    _cursor      = copy._cursor;
+    _autoCompact = copy._autoCompact;
+    _encoding    = copy._encoding;
+    _chunkedSize = copy._chunkedSize;
+    return *this;
+}
+
+// Le buffer deplace reste utilisable: vide, comme apres clear(), et dans le meme mode
+DataBuffer::DataBuffer(DataBuffer&& other) noexcept
+    : _buffer(std::move(other._buffer)), _cursor(other._cursor), _autoCompact(other._autoCompact),
+      _encoding(other._encoding), _pool(other._pool), _chunks(std::move(other._chunks)),
+      _chunkedSize(other._chunkedSize)
+{
+    other.clear();
+}
+
+DataBuffer& DataBuffer::operator=(DataBuffer&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    _buffer      = std::move(other._buffer);
+    _chunks      = std::move(other._chunks);
+    _pool        = other._pool;
+    _cursor      = other._cursor;
+    _autoCompact = other._autoCompact;
+    _encoding    = other._encoding;
+    _chunkedSize = other._chunkedSize;
+    other.clear();
+    return *this;
+}
+
 /**
  * @brief Reset the read/write cursor to the beginning of the buffer.
  */
@@ -16,47 +81,302 @@ void DataBuffer::reset() const
 void DataBuffer::clear()
 {
     _buffer.clear();
-    _cursor = 0;
-}
-
-void DataBuffer::append(const unsigned char* data, size_t len)
-{
-    if (len == 0 || data == nullptr)
-        return;
-    _buffer.insert(_buffer.end(), data, data + len);
+    _chunks.clear();
+    _chunkedSize = 0;
+    _cursor      = 0;
 }
 
 DataBuffer& DataBuffer::operator<<(const std::string& value)
 {
     size_t size = value.length();
-    *this << size;
+    if (portable())
+        appendVarint(size);
+    else
+        append(reinterpret_cast<const unsigned char*>(&size), sizeof(size));
 
-    _buffer.insert(_buffer.end(), value.begin(), value.end());
+    append(reinterpret_cast<const unsigned char*>(value.data()), size);
     return *this;
 }
 
 const DataBuffer& DataBuffer::operator>>(std::string& value) const
 {
-    size_t size;
-    *this >> size;
+    size_t size = _readCount();
 
-    if (size + _cursor > _buffer.size())
+    if (size + _cursor > _end())
         throw std::out_of_range("Buffer overflow on read");
 
+    if (_pool)
+    {
+        value.resize(size);
+        _readChunked(reinterpret_cast<unsigned char*>(&value[0]), size);
+        return *this;
+    }
+
     value.assign(_buffer.begin() + _cursor, _buffer.begin() + _cursor + size);
     _cursor += size;
 
     return *this;
 }
 
+/**
+ * @brief Choose how values are written and read from now on (Encoding::HOST by default).
+ * @details Bytes already in the buffer are not converted.
+ */
+void DataBuffer::setEncoding(Encoding encoding)
+{
+    _encoding = encoding;
+}
+
+DataBuffer::Encoding DataBuffer::encoding() const
+{
+    return _encoding;
+}
+
+void DataBuffer::_appendVarintSlow(uint64_t value)
+{
+    unsigned char bytes[DATA_BUFFER_VARINT_MAX];
+    size_t        len = 0;
+    while (value >= 0x80)
+    {
+        bytes[len++] = static_cast<unsigned char>(value | 0x80);
+        value >>= 7;
+    }
+    bytes[len++] = static_cast<unsigned char>(value);
+    append(bytes, len);
+}
+
+uint64_t DataBuffer::_readVarintSlow() const
+{
+    size_t   start = _cursor;
+    uint64_t value = 0;
+    for (size_t i = 0; i < DATA_BUFFER_VARINT_MAX; i++)
+    {
+        unsigned char byte;
+        if (_cursor >= _end())
+        {
+            _cursor = start;
+            throw std::out_of_range("Buffer overflow on varint read");
+        }
+        readBytes(&byte, 1);
+        value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+        if (!(byte & 0x80))
+            return value;
+    }
+    _cursor = start;
+    throw std::runtime_error("Malformed varint: more than 10 bytes");
+}
+
+// Longueur d'une string: size_t de la machine, ou varint en encodage portable
+size_t DataBuffer::_readCount() const
+{
+    if (!portable())
+    {
+        size_t count;
+        readBytes(reinterpret_cast<unsigned char*>(&count), sizeof(count));
+        return count;
+    }
+
+    uint64_t count = readVarint();
+    if (static_cast<size_t>(count) != count)
+        throw std::out_of_range("Length too large for this host");
+    return static_cast<size_t>(count);
+}
+
 size_t DataBuffer::size() const
 {
-    return _buffer.size() - _cursor;
+    return _end() - _cursor;
+}
+
+/**
+ * @brief Drop the bytes already read, keeping the unread ones (the cursor goes back to 0).
+ * @details The storage keeps its capacity: the space is reused by the next writes. A chunked
+ *          buffer gives its fully read chunks back to the pool, without moving any byte.
+ */
+void DataBuffer::compact()
+{
+    if (!_pool)
+    {
+        _buffer.erase(_buffer.begin(), _buffer.begin() + _cursor);
+        _cursor = 0;
+        return;
+    }
+
+    size_t done = _cursor / _pool->chunkSize();
+    _chunks.erase(_chunks.begin(), _chunks.begin() + done);
+    _cursor -= done * _pool->chunkSize();
+    _chunkedSize -= done * _pool->chunkSize();
 }
 
+/**
+ * @brief Let writes compact the buffer when enough of it has been read (off by default, on for
+ *        a chunked buffer).
+ */
+void DataBuffer::setAutoCompact(bool enabled)
+{
+    _autoCompact = enabled;
+}
+
+/**
+ * @brief Bytes allocated for the buffer, read ones included.
+ */
+size_t DataBuffer::capacity() const
+{
+    return _pool ? _chunks.size() * _pool->chunkSize() : _buffer.capacity();
+}
+
+bool DataBuffer::chunked() const
+{
+    return _pool != nullptr;
+}
+
+/**
+ * @brief The unread bytes, without copy: one View per chunk (a single one if contiguous).
+ * @details Only valid until the buffer is modified.
+ */
+std::vector<DataBuffer::View> DataBuffer::views() const
+{
+    std::vector<View> views;
+    if (!_pool)
+    {
+        if (size() > 0)
+            views.emplace_back(rawData(), size());
+        return views;
+    }
+
+    size_t chunkSize = _pool->chunkSize();
+    for (size_t i = _cursor / chunkSize; i < _chunks.size(); i++)
+    {
+        size_t offset = i == _cursor / chunkSize ? _cursor % chunkSize : 0;
+        if (_chunks[i]->size() > offset)
+            views.emplace_back(_chunks[i]->data() + offset, _chunks[i]->size() - offset);
+    }
+    return views;
+}
+
+/**
+ * @brief Hand the unread bytes over without copy, and leave the buffer empty.
+ * @details Each Chunk keeps its bytes alive (a chunk goes back to its pool once released). A
+ *          contiguous buffer hands its whole vector over as a single Chunk.
+ */
+std::vector<DataBuffer::Chunk> DataBuffer::takeChunks()
+{
+    std::vector<Chunk> taken;
+    if (!_pool)
+    {
+        if (size() > 0)
+            taken.push_back({std::make_shared<std::vector<unsigned char>>(std::move(_buffer)),
+                             _cursor});
+        clear();
+        return taken;
+    }
+
+    size_t chunkSize = _pool->chunkSize();
+    for (size_t i = _cursor / chunkSize; i < _chunks.size(); i++)
+    {
+        size_t offset = i == _cursor / chunkSize ? _cursor % chunkSize : 0;
+        if (_chunks[i]->size() > offset)
+            taken.push_back({std::move(_chunks[i]), offset});
+    }
+    clear();
+    return taken;
+}
+
+// Remplit le dernier chunk jusqu'a sa capacite avant d'en prendre un autre: rien n'est deplace
+void DataBuffer::_appendChunked(const unsigned char* data, size_t len)
+{
+    size_t chunkSize = _pool->chunkSize();
+    _chunkedSize += len;
+    while (len > 0)
+    {
+        if (_chunks.empty() || _chunks.back()->size() == chunkSize)
+            _chunks.push_back(_pool->acquire());
+
+        std::vector<unsigned char>& chunk = *_chunks.back();
+        size_t                      part  = std::min(len, chunkSize - chunk.size());
+        chunk.insert(chunk.end(), data, data + part);
+        data += part;
+        len -= part;
+    }
+}
+
+void DataBuffer::_readChunked(unsigned char* data, size_t len) const
+{
+    size_t chunkSize = _pool->chunkSize();
+    while (len > 0)
+    {
+        const std::vector<unsigned char>& chunk  = *_chunks[_cursor / chunkSize];
+        size_t                            offset = _cursor % chunkSize;
+        size_t                            part   = std::min(len, chunk.size() - offset);
+        std::memcpy(data, chunk.data() + offset, part);
+        data += part;
+        len -= part;
+        _cursor += part;
+    }
+}
+
+// Retourne directement dans le vector; en mode chunks, par blocs sur la pile
+void DataBuffer::_appendSwapped(const unsigned char* data, size_t count, size_t width)
+{
+    _compactIfWorthIt();
+    if (!_pool)
+    {
+        size_t end = _buffer.size();
+        _buffer.resize(end + count * width);
+        ByteSwap::copy(_buffer.data() + end, data, count, width);
+        return;
+    }
+
+    unsigned char block[DATA_BUFFER_SWAP_BLOCK];
+    while (count > 0)
+    {
+        size_t part = std::min(count, sizeof(block) / width);
+        ByteSwap::copy(block, data, part, width);
+        _appendChunked(block, part * width);
+        data += part * width;
+        count -= part;
+    }
+}
+
+void DataBuffer::_readSwapped(unsigned char* data, size_t count, size_t width) const
+{
+    if (count * width + _cursor > _end())
+        throw std::out_of_range("Buffer overflow on read");
+
+    if (_pool)
+    {
+        _readChunked(data, count * width);
+        ByteSwap::copy(data, data, count, width);
+        return;
+    }
+    ByteSwap::copy(data, _buffer.data() + _cursor, count, width);
+    _cursor += count * width;
+}
+
+/**
+ * @brief Copy of the unread bytes.
+ * @details Allocates on every call: view() gives access to the same bytes without copying.
+ */
 const std::vector<unsigned char> DataBuffer::data() const
 {
-    return std::vector<unsigned char>(_buffer.begin() + _cursor, _buffer.end());
+    if (!_pool)
+        return std::vector<unsigned char>(_buffer.begin() + _cursor, _buffer.end());
+
+    std::vector<unsigned char> bytes;
+    bytes.reserve(size());
+    for (const View& view : views())
+        bytes.insert(bytes.end(), view.begin(), view.end());
+    return bytes;
+}
+
+/**
+ * @brief Pointer to the unread bytes (size() of them), without copying them.
+ * @details Only valid until the buffer is modified.
+ * @throw std::logic_error if the buffer is chunked
+ */
+const unsigned char* DataBuffer::rawData() const
+{
+    _contiguousOnly("rawData");
+    return _buffer.data() + _cursor;
 }
 
 /**
@@ -66,7 +386,7 @@ const std::vector<unsigned char> DataBuffer::data() const
  */
 void DataBuffer::increaseCursor(size_t amount) const
 {
-    if (_cursor + amount > _buffer.size())
+    if (_cursor + amount > _end())
         throw std::out_of_range("Buffer overflow on increaseCursor");
 
     _cursor += amount;
@@ -83,4 +403,4 @@ void DataBuffer::decreaseCursor(size_t amount) const
         throw std::out_of_range("Buffer underflow on decreaseCursor");
 
     _cursor -= amount;
-}
\ No newline at end of file
+}
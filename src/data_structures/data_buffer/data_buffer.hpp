@@ -3,11 +3,23 @@
 
 #include <stdio.h>
 
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <vector>
 
+#include "../byte_swap/byte_swap.hpp"
+#include "../chunk_pool/chunk_pool.hpp"
+#include "../reflection/reflection.hpp"
+
+#define DATA_BUFFER_COMPACT_MIN 4096 // Octets lus avant une compaction automatique
+#define DATA_BUFFER_SWAP_BLOCK  4096 // Octets retournes a la fois avant un ajout en mode chunks
+#define DATA_BUFFER_VARINT_MAX  10   // Octets d'un varint LEB128 de 64 bits
+
 /**
  * @brief A simple LIFO data buffer for serialization and deserialization for simple data types and
  * std::string.
@@ -31,19 +43,162 @@
  * buffer >> readInt;
  *
  * @endcode
+ * @note Structs that declare a Schema are written and read in one operator, and so are
+ *       std::vector, std::array and Span: one memcpy for the whole container when its elements
+ *       are trivially copyable (see Reflection)
+ * @note appendBigEndian() and readBigEndian() write and read arrays of numbers in network byte
+ *       order, reversed 16 bytes at a time on a little endian host (see ByteSwap)
+ * @note By default values are written in the host representation: byte order and width of
+ *       size_t (the length of a std::string, the count of a std::vector) depend on the machine.
+ *       setEncoding(Encoding::PORTABLE) makes the buffer readable by any host, to persist it or
+ *       send it to a different peer: numbers in little endian, lengths and counts as LEB128
+ *       varints. Both sides must use the same encoding, and portable data should use fixed
+ *       width types (int32_t rather than long). On a little endian host only the lengths change:
+ *       the byte order branches are compiled out.
+ * @code
+ * DataBuffer save;
+ * save.setEncoding(DataBuffer::Encoding::PORTABLE);
+ * save << int32_t(42) << std::string("alice") << std::vector<float>{1.5f, 2.5f};
+ * // 2a 00 00 00 | 05 'a' 'l' 'i' 'c' 'e' | 02 00 00 c0 3f 00 00 20 40
+ * @endcode
+ * @note view() exposes the unread bytes without copying them, where data() returns a new vector:
+ * @code
+ * DataBuffer::View unread = buffer.view();   // Everything after the cursor
+ * DataBuffer::View header = buffer.view(4);  // Its first 4 bytes, std::out_of_range if fewer
+ * process(header.data(), header.size());
+ * buffer.increaseCursor(header.size());
+ * @endcode
+ * @note Read bytes are kept (reset() and decreaseCursor() go back to them) until compact() drops
+ *       them. With setAutoCompact(true), a write compacts first once the bytes already read are
+ *       at least DATA_BUFFER_COMPACT_MIN and outnumber the unread ones: each byte is moved at most
+ *       once per byte read before it, so a buffer used as a stream keeps a flat footprint instead
+ *       of growing forever. reset() then goes back to the last compaction only
+ * @note A DataBuffer built with a ChunkPool stores its bytes in a chain of fixed-size chunks
+ *       instead of one vector: appending costs O(len) and never moves what is already stored,
+ *       however large the buffer grows. Chunks fully read are given back to the pool by the next
+ *       write (auto compaction is on by default in this mode). The bytes are not contiguous:
+ *       rawData() and view() throw std::logic_error, views() lists them chunk by chunk.
+ *       takeChunks() hands every unread byte over without copy, e.g. to an OutputQueue
  * @throw std::out_of_range Thrown when trying to read more data than available in the buffer.
  */
 class DataBuffer
 {
+public:
+    /**
+     * @brief Read-only window on bytes of a DataBuffer (pointer + length, like std::span).
+     * @details Only valid until the buffer is modified.
+     */
+    class View
+    {
+    private:
+        const unsigned char* _data = nullptr;
+        size_t               _size = 0;
+
+    public:
+        View() = default;
+        View(const unsigned char* data, size_t size) : _data(data), _size(size) {}
+
+        const unsigned char* data() const
+        {
+            return _data;
+        }
+        size_t size() const
+        {
+            return _size;
+        }
+        bool empty() const
+        {
+            return _size == 0;
+        }
+        const unsigned char* begin() const
+        {
+            return _data;
+        }
+        const unsigned char* end() const
+        {
+            return _data + _size;
+        }
+        unsigned char operator[](size_t index) const
+        {
+            return _data[index];
+        }
+    };
+
+    enum class Encoding : unsigned char
+    {
+        HOST     = 0, // Representation de la machine, tailles en size_t
+        PORTABLE = 1, // Little endian, tailles en varints
+    };
+
+    // Octets non lus remis par takeChunks(): data, a partir de offset
+    struct Chunk
+    {
+        std::shared_ptr<const std::vector<unsigned char>> data;
+        size_t                                            offset;
+    };
+
 private:
     std::vector<unsigned char> _buffer;
     mutable size_t             _cursor;
+    bool                       _autoCompact = false;
+    Encoding                   _encoding    = Encoding::HOST;
+
+    // Mode chunks: tous pleins sauf le dernier, _cursor compte depuis le debut du premier
+    std::shared_ptr<ChunkPool>    _pool; // nullptr: stockage contigu dans _buffer
+    std::vector<ChunkPool::Chunk> _chunks;
+    size_t                        _chunkedSize = 0;
+
+    size_t _end() const
+    {
+        return _pool ? _chunkedSize : _buffer.size();
+    }
+
+    // Deplacer le non lu coute moins que ce qui a ete lu depuis: cout amorti constant par octet.
+    // Un chunk entierement lu se rend sans rien deplacer
+    void _compactIfWorthIt()
+    {
+        if (!_autoCompact)
+            return;
+        if (_pool ? _cursor >= _pool->chunkSize()
+                  : _cursor >= DATA_BUFFER_COMPACT_MIN && _cursor >= _buffer.size() - _cursor)
+            compact();
+    }
+
+    void _contiguousOnly(const char* method) const
+    {
+        if (_pool)
+            throw std::logic_error(std::string("DataBuffer::") + method +
+                                   "(): the bytes of a chunked buffer are not contiguous");
+    }
+
+    void _appendChunked(const unsigned char* data, size_t len);
+    void _readChunked(unsigned char* data, size_t len) const;
+    void _appendSwapped(const unsigned char* data, size_t count, size_t width);
+    void _readSwapped(unsigned char* data, size_t count, size_t width) const;
+
+    template <typename T, bool BigEndian>
+    static constexpr bool _needsSwap()
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                      "Byte order only applies to numbers");
+        return BigEndian == BYTE_SWAP_HOST_IS_LITTLE && sizeof(T) > 1;
+    }
+
+    void     _appendVarintSlow(uint64_t value);
+    uint64_t _readVarintSlow() const;
+    size_t   _readCount() const;
 
 public:
     DataBuffer();
+    explicit DataBuffer(const std::shared_ptr<ChunkPool>& pool);
+    DataBuffer(const DataBuffer& other);
+    DataBuffer& operator=(const DataBuffer& other);
+    DataBuffer(DataBuffer&& other) noexcept;
+    DataBuffer& operator=(DataBuffer&& other) noexcept;
     ~DataBuffer() = default;
 
     const std::vector<unsigned char> data() const;
+    const unsigned char*             rawData() const;
     void                             increaseCursor(size_t amount) const;
     void                             decreaseCursor(size_t amount) const;
 
@@ -51,7 +206,126 @@ public:
     void   clear();
     size_t size() const;
 
-    void append(const unsigned char* data, size_t len);
+    void   compact();
+    void   setAutoCompact(bool enabled);
+    size_t capacity() const;
+
+    void     setEncoding(Encoding encoding);
+    Encoding encoding() const;
+
+    bool portable() const
+    {
+        return _encoding == Encoding::PORTABLE;
+    }
+
+    bool               chunked() const;
+    std::vector<View>  views() const;
+    std::vector<Chunk> takeChunks();
+
+    // Dans le header: appeles pour chaque champ, la taille devient une constante a l'inlining
+    void append(const unsigned char* data, size_t len)
+    {
+        _compactIfWorthIt();
+        if (_pool)
+            return _appendChunked(data, len);
+        _buffer.insert(_buffer.end(), data, data + len);
+    }
+
+    /**
+     * @brief Append value as a LEB128 varint: 7 bits per byte, 1 byte below 128.
+     */
+    void appendVarint(uint64_t value)
+    {
+        if (value >= 0x80)
+            return _appendVarintSlow(value);
+        unsigned char byte = static_cast<unsigned char>(value);
+        append(&byte, 1);
+    }
+
+    /**
+     * @brief Read a varint written by appendVarint().
+     * @throw std::out_of_range if the buffer ends inside the varint (the cursor does not move)
+     * @throw std::runtime_error if it is longer than DATA_BUFFER_VARINT_MAX bytes
+     */
+    uint64_t readVarint() const
+    {
+        if (!_pool && _cursor < _buffer.size() && _buffer[_cursor] < 0x80)
+            return _buffer[_cursor++];
+        return _readVarintSlow();
+    }
+
+    View view() const
+    {
+        _contiguousOnly("view");
+        return View(_buffer.data() + _cursor, _buffer.size() - _cursor);
+    }
+
+    View view(size_t len) const
+    {
+        _contiguousOnly("view");
+        if (len + _cursor > _buffer.size())
+            throw std::out_of_range("Buffer overflow on view");
+        return View(_buffer.data() + _cursor, len);
+    }
+
+    void readBytes(unsigned char* data, size_t len) const
+    {
+        if (len + _cursor > _end())
+            throw std::out_of_range("Buffer overflow on read");
+
+        if (_pool)
+            return _readChunked(data, len);
+        if (len > 0)
+            std::memcpy(data, _buffer.data() + _cursor, len);
+        _cursor += len;
+    }
+
+    /**
+     * @brief Append count numbers in big endian (network) byte order, whatever the host's.
+     * @details Only the values are written: the reader must know count.
+     */
+    template <typename T>
+    void appendBigEndian(const T* values, size_t count)
+    {
+        if constexpr (_needsSwap<T, true>())
+            _appendSwapped(reinterpret_cast<const unsigned char*>(values), count, sizeof(T));
+        else
+            append(reinterpret_cast<const unsigned char*>(values), sizeof(T) * count);
+    }
+
+    /**
+     * @brief Read count numbers written by appendBigEndian() (or by a big endian peer).
+     * @throw std::out_of_range if fewer than count values are left
+     */
+    template <typename T>
+    void readBigEndian(T* values, size_t count) const
+    {
+        if constexpr (_needsSwap<T, true>())
+            _readSwapped(reinterpret_cast<unsigned char*>(values), count, sizeof(T));
+        else
+            readBytes(reinterpret_cast<unsigned char*>(values), sizeof(T) * count);
+    }
+
+    /**
+     * @brief Same as appendBigEndian(), in little endian: the order of Encoding::PORTABLE.
+     */
+    template <typename T>
+    void appendLittleEndian(const T* values, size_t count)
+    {
+        if constexpr (_needsSwap<T, false>())
+            _appendSwapped(reinterpret_cast<const unsigned char*>(values), count, sizeof(T));
+        else
+            append(reinterpret_cast<const unsigned char*>(values), sizeof(T) * count);
+    }
+
+    template <typename T>
+    void readLittleEndian(T* values, size_t count) const
+    {
+        if constexpr (_needsSwap<T, false>())
+            _readSwapped(reinterpret_cast<unsigned char*>(values), count, sizeof(T));
+        else
+            readBytes(reinterpret_cast<unsigned char*>(values), sizeof(T) * count);
+    }
 
     DataBuffer&       operator<<(const std::string& value);
     const DataBuffer& operator>>(std::string& value) const;
@@ -59,20 +333,14 @@ public:
     template <typename T>
     DataBuffer& operator<<(const T& value)
     {
-        const unsigned char* ptr = reinterpret_cast<const unsigned char*>(&value);
-        _buffer.insert(_buffer.end(), ptr, ptr + sizeof(T));
+        Reflection::write(*this, value);
         return *this;
     }
 
     template <typename T>
     const DataBuffer& operator>>(T& value) const
     {
-        if (sizeof(T) + _cursor > _buffer.size())
-            throw std::out_of_range("Buffer overflow on read");
-
-        std::memcpy(&value, _buffer.data() + _cursor, sizeof(T));
-
-        _cursor += sizeof(T);
+        Reflection::read(*this, value);
         return *this;
     }
 };
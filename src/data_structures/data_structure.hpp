@@ -1,7 +1,10 @@
 #ifndef DATA_STRUCTURE_HPP
 #define DATA_STRUCTURE_HPP
 
+#include "byte_swap/byte_swap.hpp"
+#include "chunk_pool/chunk_pool.hpp"
 #include "data_buffer/data_buffer.hpp"
 #include "pool/pool.hpp"
+#include "reflection/reflection.hpp"
 
 #endif
\ No newline at end of file
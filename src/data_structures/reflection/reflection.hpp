@@ -0,0 +1,461 @@
+#ifndef REFLECTION_HPP
+#define REFLECTION_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../byte_swap/byte_swap.hpp"
+
+#define REFLECTION_READ_CHUNK 4096 // Elements alloues a la fois en lisant un std::vector
+
+/**
+ * @brief Field list of a struct: member pointers, in wire order.
+ *
+ * Declare it once, either in the struct (static constexpr schema()) or, for a type you cannot
+ * modify, as a specialization of Schema:
+ *
+ * @code
+ * struct Player
+ * {
+ *     int         id;
+ *     float       x;
+ *     float       y;
+ *     std::string name;
+ *
+ *     static constexpr auto schema()
+ *     {
+ *         return std::make_tuple(&Player::id, &Player::x, &Player::y, &Player::name);
+ *     }
+ * };
+ *
+ * // Struct from a third-party header
+ * template <>
+ * struct Schema<Color>
+ * {
+ *     static constexpr auto fields() { return std::make_tuple(&Color::r, &Color::g, &Color::b); }
+ * };
+ * @endcode
+ */
+template <typename T, typename = void>
+struct Schema
+{
+};
+
+template <typename T>
+struct Schema<T, std::void_t<decltype(T::schema())>>
+{
+    static constexpr auto fields()
+    {
+        return T::schema();
+    }
+};
+
+template <typename T, typename = void>
+struct IsReflected : std::false_type
+{
+};
+
+template <typename T>
+struct IsReflected<T, std::void_t<decltype(Schema<T>::fields())>> : std::true_type
+{
+};
+
+template <typename T>
+struct IsVector : std::false_type
+{
+};
+
+template <typename E, typename A>
+struct IsVector<std::vector<E, A>> : std::true_type
+{
+};
+
+template <typename T>
+struct IsArray : std::false_type
+{
+};
+
+template <typename E, size_t N>
+struct IsArray<std::array<E, N>> : std::true_type
+{
+};
+
+/**
+ * @brief Elements that are not in a std::vector (pointer + count), serialized like one.
+ * @details Written as [size_t count][elements], so a span and a std::vector of the same
+ *          elements can be read back as each other. Reading into a span throws
+ *          std::out_of_range if more than size elements were written, and sets size to the
+ *          number read otherwise.
+ * @code
+ * float samples[256];
+ * msg << Span<const float>{samples, 256};
+ *
+ * Span<float> into{samples, 256};
+ * msg >> into;                    // into.size: the count read
+ * @endcode
+ */
+template <typename E>
+struct Span
+{
+    E*     data;
+    size_t size;
+};
+
+template <typename T>
+struct IsSpan : std::false_type
+{
+};
+
+template <typename E>
+struct IsSpan<Span<E>> : std::true_type
+{
+};
+
+// Archive dont l'encodage se choisit (DataBuffer::setEncoding()): portable() dit s'il est portable
+template <typename Archive, typename = void>
+struct HasEncoding : std::false_type
+{
+};
+
+template <typename Archive>
+struct HasEncoding<Archive, std::void_t<decltype(std::declval<const Archive&>().portable())>>
+    : std::true_type
+{
+};
+
+/**
+ * @brief Compile-time serialization of the types that declare a Schema.
+ *
+ * DataBuffer, Message, MessageView and Memento::Snapshot route their operator<< and operator>>
+ * through Reflection: a struct with a Schema is written and read with a single operator, field
+ * by field in schema order, instead of a hand-ordered chain of operators that must match on
+ * both sides. The loops are unrolled at compile time (std::apply over the member pointers).
+ *
+ * Wire representation, identical for every archive:
+ * - trivially copyable types: their bytes (sizeof(T)), as before
+ * - std::string: [size_t length][chars], as before
+ * - std::vector<E> and Span<E>: [size_t count] then each element
+ * - std::array<E, N>: its N elements (the count is in the type)
+ * - reflected struct: each field, recursively
+ *
+ * Bulk copies: a reflected struct whose fields are trivially copyable and cover its memory
+ * without padding, in declaration order, has the same wire and memory image. It is written with
+ * one memcpy, and so is a std::vector, std::array or Span of it (or of any trivially copyable
+ * type): one reserve and one memcpy for the whole container instead of one write per element.
+ *
+ * An archive only needs append(const unsigned char*, size_t) to be written to, and
+ * readBytes(unsigned char*, size_t) (throwing past the end) plus operator>>(std::string&) to be
+ * read from.
+ *
+ * Portable encoding: an archive with portable() returning true (a DataBuffer set to
+ * Encoding::PORTABLE) gets numbers in little endian and counts as LEB128 varints through its
+ * appendVarint() / readVarint() and appendLittleEndian() / readLittleEndian(). On a little
+ * endian host the numbers are already in that order: only the counts change, the byte order
+ * branches are compiled out and the bulk copies stay single memcpys.
+ *
+ * @code
+ * Player player = {7, 1.5f, 2.5f, "alice"};
+ * Message msg(MESSAGE_PLAYER);
+ * msg << player;              // id, x, y, name
+ *
+ * Player copy;
+ * msg >> copy;
+ *
+ * Reflection::forEachField(player, [](const auto& field) { std::cout << field << ' '; });
+ * static_assert(Reflection::fieldCount<Player>() == 4, "");
+ * @endcode
+ *
+ * @note Types without a Schema must be trivially copyable: anything else (a pointer owning
+ *       container, a std::map...) is rejected at compile time instead of being memcpy'd
+ */
+class Reflection
+{
+private:
+    template <typename Archive, typename T>
+    static void _writeRaw(Archive& out, const T* value, size_t count)
+    {
+        out.append(reinterpret_cast<const unsigned char*>(value), sizeof(T) * count);
+    }
+
+    template <typename Archive, typename T>
+    static void _readRaw(Archive& in, T* value, size_t count)
+    {
+        in.readBytes(reinterpret_cast<unsigned char*>(value), sizeof(T) * count);
+    }
+
+    // Offset de chaque champ == somme des tailles precedentes, et rien apres le dernier
+    template <typename T>
+    static bool _computeContiguous()
+    {
+        const T              probe{};
+        const unsigned char* base     = reinterpret_cast<const unsigned char*>(&probe);
+        size_t               expected = 0;
+        bool                 result   = true;
+
+        forEachField(probe,
+                     [&](const auto& field)
+                     {
+                         using F = std::decay_t<decltype(field)>;
+                         size_t offset =
+                             reinterpret_cast<const unsigned char*>(&field) - base;
+                         if (!std::is_trivially_copyable<F>::value || !contiguous<F>() ||
+                             offset != expected)
+                             result = false;
+                         expected += sizeof(F);
+                     });
+        return result && expected == sizeof(T);
+    }
+
+    template <typename E>
+    static constexpr bool _bulkElement()
+    {
+        return std::is_trivially_copyable<E>::value && !std::is_same<E, bool>::value;
+    }
+
+    template <typename T>
+    static constexpr bool _isNumber()
+    {
+        return std::is_arithmetic<T>::value || std::is_enum<T>::value;
+    }
+
+    template <typename Archive>
+    static bool _portable(const Archive& archive)
+    {
+        if constexpr (HasEncoding<Archive>::value)
+            return archive.portable();
+        else
+        {
+            (void)archive;
+            return false;
+        }
+    }
+
+    // Memoire == fil: vrai partout en encodage hote, et en portable sur un hote little endian
+    template <typename Archive, typename E>
+    static bool _sameImage(const Archive& archive)
+    {
+        return contiguous<E>() && (BYTE_SWAP_HOST_IS_LITTLE || !_portable(archive));
+    }
+
+    template <typename Archive>
+    static void _writeCount(Archive& out, size_t count)
+    {
+        if constexpr (HasEncoding<Archive>::value)
+        {
+            if (out.portable())
+                return out.appendVarint(count);
+        }
+        _writeRaw(out, &count, 1);
+    }
+
+    template <typename Archive>
+    static size_t _readCount(Archive& in)
+    {
+        if constexpr (HasEncoding<Archive>::value)
+        {
+            if (in.portable())
+            {
+                uint64_t count = in.readVarint();
+                if (static_cast<size_t>(count) != count)
+                    throw std::out_of_range("Count too large for this host");
+                return static_cast<size_t>(count);
+            }
+        }
+        size_t count;
+        _readRaw(in, &count, 1);
+        return count;
+    }
+
+    // Nombres: little endian en portable, donc retournes uniquement sur un hote big endian
+    template <typename Archive, typename T>
+    static void _writeNumbers(Archive& out, const T* values, size_t count)
+    {
+        if constexpr (HasEncoding<Archive>::value && !BYTE_SWAP_HOST_IS_LITTLE && sizeof(T) > 1)
+        {
+            if (out.portable())
+                return out.appendLittleEndian(values, count);
+        }
+        _writeRaw(out, values, count);
+    }
+
+    template <typename Archive, typename T>
+    static void _readNumbers(Archive& in, T* values, size_t count)
+    {
+        if constexpr (HasEncoding<Archive>::value && !BYTE_SWAP_HOST_IS_LITTLE && sizeof(T) > 1)
+        {
+            if (in.portable())
+                return in.readLittleEndian(values, count);
+        }
+        _readRaw(in, values, count);
+    }
+
+    template <typename Archive, typename E>
+    static void _writeElements(Archive& out, const E* elements, size_t count)
+    {
+        if constexpr (_isNumber<E>() && !std::is_same<E, bool>::value)
+            return _writeNumbers(out, elements, count);
+        else if constexpr (_bulkElement<E>())
+        {
+            if (_sameImage<Archive, E>(out))
+                return _writeRaw(out, elements, count);
+        }
+        for (size_t i = 0; i < count; i++)
+            write(out, elements[i]);
+    }
+
+    template <typename Archive, typename E>
+    static void _readElements(Archive& in, E* elements, size_t count)
+    {
+        if constexpr (_isNumber<E>() && !std::is_same<E, bool>::value)
+            return _readNumbers(in, elements, count);
+        else if constexpr (_bulkElement<E>())
+        {
+            if (_sameImage<Archive, E>(in))
+                return _readRaw(in, elements, count);
+        }
+        for (size_t i = 0; i < count; i++)
+            read(in, elements[i]);
+    }
+
+public:
+    template <typename T>
+    static constexpr size_t fieldCount()
+    {
+        return std::tuple_size<decltype(Schema<T>::fields())>::value;
+    }
+
+    /**
+     * @brief Call visit(field) on each field of value, in schema order (const or not).
+     */
+    template <typename T, typename Visitor>
+    static void forEachField(T& value, Visitor&& visit)
+    {
+        std::apply([&](auto... member) { (visit(value.*member), ...); },
+                   Schema<std::remove_const_t<T>>::fields());
+    }
+
+    /**
+     * @brief True if the wire image of T is its memory image (one memcpy per value).
+     * @details Always true for trivially copyable types without a Schema. Checked once per
+     *          reflected type.
+     */
+    template <typename T>
+    static bool contiguous()
+    {
+        if constexpr (!IsReflected<T>::value)
+            return std::is_trivially_copyable<T>::value;
+        else if constexpr (!std::is_trivially_copyable<T>::value ||
+                           !std::is_default_constructible<T>::value)
+            return false;
+        else
+        {
+            static const bool result = _computeContiguous<T>();
+            return result;
+        }
+    }
+
+    template <typename Archive, typename T>
+    static void write(Archive& out, const T& value)
+    {
+        if constexpr (std::is_same<T, std::string>::value)
+            out << value;
+        else if constexpr (IsVector<T>::value)
+        {
+            using E = typename T::value_type;
+            _writeCount(out, value.size());
+            if constexpr (_bulkElement<E>())
+                _writeElements(out, value.data(), value.size());
+            else
+                for (const E& element : value)
+                    write(out, element);
+        }
+        else if constexpr (IsSpan<T>::value)
+        {
+            _writeCount(out, value.size);
+            _writeElements(out, value.data, value.size);
+        }
+        else if constexpr (IsArray<T>::value)
+            _writeElements(out, value.data(), value.size());
+        else if constexpr (IsReflected<T>::value)
+        {
+            if (_sameImage<Archive, T>(out))
+                return _writeRaw(out, &value, 1);
+            forEachField(value, [&out](const auto& field) { write(out, field); });
+        }
+        else if constexpr (_isNumber<T>())
+            _writeNumbers(out, &value, 1);
+        else
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "Type without a Schema must be trivially copyable to be serialized");
+            _writeRaw(out, &value, 1);
+        }
+    }
+
+    template <typename Archive, typename T>
+    static void read(Archive& in, T& value)
+    {
+        if constexpr (std::is_same<T, std::string>::value)
+            in >> value;
+        else if constexpr (IsVector<T>::value)
+        {
+            using E      = typename T::value_type;
+            size_t count = _readCount(in);
+            value.clear();
+
+            // Un compte corrompu ne doit pas allouer des Go: on grandit au fil des lectures
+            while (value.size() < count)
+            {
+                size_t chunk = std::min<size_t>(count - value.size(), REFLECTION_READ_CHUNK);
+                if constexpr (_bulkElement<E>())
+                {
+                    size_t done = value.size();
+                    value.resize(done + chunk);
+                    _readElements(in, value.data() + done, chunk);
+                }
+                else
+                    for (size_t i = 0; i < chunk; i++)
+                    {
+                        E element{};
+                        read(in, element);
+                        value.push_back(std::move(element));
+                    }
+            }
+        }
+        else if constexpr (IsSpan<T>::value)
+        {
+            size_t count = _readCount(in);
+            if (count > value.size)
+                throw std::out_of_range("Span too small for the elements read");
+            _readElements(in, value.data, count);
+            value.size = count;
+        }
+        else if constexpr (IsArray<T>::value)
+            _readElements(in, value.data(), value.size());
+        else if constexpr (IsReflected<T>::value)
+        {
+            if (_sameImage<Archive, T>(in))
+                return _readRaw(in, &value, 1);
+            forEachField(value, [&in](auto& field) { read(in, field); });
+        }
+        else if constexpr (_isNumber<T>())
+            _readNumbers(in, &value, 1);
+        else
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "Type without a Schema must be trivially copyable to be serialized");
+            _readRaw(in, &value, 1);
+        }
+    }
+};
+
+#endif
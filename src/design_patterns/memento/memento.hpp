@@ -5,8 +5,11 @@
 #include <string.h>
 
 #include <stdexcept>
+#include <string>
 #include <vector>
 
+#include "../../data_structures/reflection/reflection.hpp"
+
 /**
  * @brief Memento Design Pattern
  * @warning You must implement _saveToSnapshot and _loadFromSnapshot
@@ -43,6 +46,11 @@
  *
  * // Now obj has _value = 42 and _name = "Initial"
  * @endcode
+ * @note A struct that declares a Schema (see Reflection) is saved in one operator:
+ * @code
+ * void _saveToSnapshot(Memento::Snapshot& snapshot) const override { snapshot << _state; }
+ * void _loadFromSnapshot(Memento::Snapshot& snapshot) override { snapshot >> _state; }
+ * @endcode
  *
  */
 class Memento
@@ -59,21 +67,32 @@ public:
         template <typename T>
         Snapshot& operator<<(const T& value)
         {
-            const unsigned char* ptr = reinterpret_cast<const unsigned char*>(&value);
-            _buffer.insert(_buffer.end(), ptr, ptr + sizeof(T));
+            Reflection::write(*this, value);
             return *this;
         }
 
         // LECTURE
         template <typename T>
-        Snapshot operator>>(T& value)
+        Snapshot& operator>>(T& value)
         {
-            if (sizeof(T) + _cursor > _buffer.size())
+            Reflection::read(*this, value);
+            return *this;
+        }
+
+        // Dans le header: appeles pour chaque champ
+        void append(const unsigned char* data, size_t len)
+        {
+            _buffer.insert(_buffer.end(), data, data + len);
+        }
+
+        void readBytes(unsigned char* data, size_t len)
+        {
+            if (len + _cursor > _buffer.size())
                 throw std::out_of_range("Buffer overflow on read");
 
-            memcpy(&value, _buffer.data() + _cursor, sizeof(T));
-            _cursor += sizeof(T);
-            return *this;
+            if (len > 0)
+                memcpy(data, _buffer.data() + _cursor, len);
+            _cursor += len;
         }
 
         Snapshot& operator<<(const std::string& value);
@@ -1,12 +1,92 @@
 #include "client.hpp"
 
-Client::Client() : _tmpMsg(), _fd(-1) {}
+// user_data des requetes io_uring du client: une seule connexion, seul l'evenement compte
+#define CLIENT_URING_RECV    1
+#define CLIENT_URING_POLLOUT 2
+#define CLIENT_URING_ENTRIES 16
 
-Client::Client(const std::string& address, const size_t& port) : _tmpMsg(), _fd(-1)
+Client::Client(Backend backend)
+    : _inbox(), _fd(-1), _backend(backend), _stats(new NetStats())
+{
+}
+
+Client::Client(const std::string& address, const size_t& port, Backend backend)
+    : _inbox(), _fd(-1), _backend(backend), _stats(new NetStats())
 {
     connect(address, port);
 }
 
+// La connexion est reenregistree: le handler de la boucle pointe sur le nouvel objet
+Client::Client(Client&& other) noexcept
+    : _triggers(std::move(other._triggers)), _inbox(std::move(other._inbox)),
+      _outbox(std::move(other._outbox)), _fd(other._fd), _backend(other._backend),
+      _format(other._format), _requestedFormat(other._requestedFormat),
+      _uring(std::move(other._uring)), _uringPollOut(other._uringPollOut), _loop(other._loop),
+      _ownLoop(std::move(other._ownLoop)), _calls(std::move(other._calls)),
+      _nextCorrelationId(other._nextCorrelationId), _channelSink(std::move(other._channelSink)),
+      _backpressureAction(std::move(other._backpressureAction)), _stats(std::move(other._stats)),
+      _statsQueued(other._statsQueued), _receivedAt(other._receivedAt)
+{
+    if (_loop && _fd >= 0)
+    {
+        _loop->remove(_fd);
+        _watch();
+    }
+    other._fd   = -1;
+    other._loop = nullptr;
+    other._stats.reset(new NetStats());
+    other._statsQueued = 0;
+}
+
+Client::~Client()
+{
+    disconnect();
+}
+
+/**
+ * @brief Register the connection in a shared EventLoop instead of the client's own one.
+ * @details Can be called before or after connect(). Messages are then handled by the loop as
+ * soon as they arrive; update() still works and runs one round of that loop.
+ * @throws std::invalid_argument with Backend::IO_URING, which waits on its own ring
+ */
+void Client::attach(EventLoop& loop)
+{
+    if (_backend == Backend::IO_URING)
+        throw std::invalid_argument("Client::attach(): not available with the io_uring backend");
+
+    if (_loop && _fd >= 0)
+        _loop->remove(_fd);
+    _loop = &loop;
+    _ownLoop.reset();
+    if (_fd >= 0)
+        _watch();
+}
+
+// Edge-triggered: _receiveMessage() lit jusqu'a EAGAIN, _flush() ecrit jusqu'a EAGAIN
+void Client::_watch()
+{
+    if (!_loop)
+    {
+        _ownLoop.reset(new EventLoop());
+        _loop = _ownLoop.get();
+    }
+    _loop->add(_fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+               [this](uint32_t events) { _onEvents(events); });
+}
+
+void Client::_onEvents(uint32_t events)
+{
+    if ((events & EPOLLOUT) && _fd >= 0 && !_outbox.empty())
+        _flush(_outbox.congested());
+
+    if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) && _fd >= 0)
+        _receiveMessage();
+
+    // Boucle partagee: personne n'appelle update(), les messages sont distribues tout de suite
+    if (!_deferDispatch)
+        _dispatch(0);
+}
+
 void Client::_networkError(std::string&& errorMsg)
 {
     disconnect();
@@ -18,10 +98,15 @@ void Client::_networkError(std::string&& errorMsg)
 void Client::connect(const std::string& address, const size_t& port)
 {
     disconnect();
+    _connects++;
+    _inbox.clear();
+    _outbox.clear();
+    _countQueued();
 
     _fd = ::socket(AF_INET, SOCK_STREAM, 0);
     if (_fd < 0)
         return _networkError("Cannot create socket");
+    _stats->connected();
 
     sockaddr_in sockaddr;
     sockaddr.sin_family = AF_INET;
@@ -38,28 +123,242 @@ void Client::connect(const std::string& address, const size_t& port)
 
     if (::connect(_fd, (struct sockaddr*)&sockaddr, sizeof(sockaddr)) < 0)
         return _networkError("Cannot connect to socket: ");
+
+    // Une fois connecte, send() ne doit plus jamais bloquer: le surplus part dans _outbox
+    fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    if (_backend == Backend::IO_URING)
+    {
+        try
+        {
+            _uring.reset(new IoUring(CLIENT_URING_ENTRIES));
+            _uring->provideBuffers(IO_URING_BUFFER_COUNT, IO_URING_BUFFER_SIZE);
+        }
+        catch (const std::exception&)
+        {
+            disconnect();
+            throw;
+        }
+        _uring->recvMultishot(_fd, CLIENT_URING_RECV);
+    }
+    else
+    {
+        try
+        {
+            _watch();
+        }
+        catch (const std::exception&)
+        {
+            disconnect();
+            throw;
+        }
+    }
+
+    _format = Message::WireFormat::LEGACY;
+    _requestWireFormat();
 }
 
 void Client::disconnect()
 {
+    // Detruire l'instance annule la requete recv, qui garde une reference sur la socket
+    _uring.reset();
+    _uringPollOut = false;
+
+    // Les reponses attendues ne viendront plus (les futures recoivent broken_promise)
+    _calls.clear();
+
     if (_fd > 0)
     {
         // shutdown(_fd, SHUT_RDWR);
+        if (_loop)
+            _loop->remove(_fd);
         close(_fd);
+        _stats->disconnected();
     }
     _fd = -1;
 }
 
-void Client::defineAction(const Message::Type&                           messageType,
-                          const std::function<void(const Message& msg)>& action)
+void Client::defineAction(const Message::Type&                               messageType,
+                          const std::function<void(const MessageView& msg)>& action)
 {
     _triggers[messageType].push_back(action);
 }
 
+/**
+ * @brief Ask the server to use another wire format on this connection (see Message::WireFormat).
+ */
+void Client::setWireFormat(Message::WireFormat format)
+{
+    _requestedFormat = format;
+    if (_fd >= 0)
+        _requestWireFormat();
+}
+
+/**
+ * @brief Wire format of the messages received, which the server switches when it acknowledges.
+ */
+Message::WireFormat Client::wireFormat() const
+{
+    return _inbox.format();
+}
+
+// La demande part dans le format courant, tout ce qui suit dans le nouveau
+void Client::_requestWireFormat()
+{
+    if (_requestedFormat == _format)
+        return;
+
+    Message request(MESSAGE_TYPE_WIRE_FORMAT);
+    request << static_cast<unsigned char>(_requestedFormat);
+    send(request);
+    _format = _requestedFormat;
+}
+
 void Client::send(const Message& message)
 {
-    auto data = message.getSerializedData();
-    ::send(_fd, data.data(), data.size(), 0);
+    _send(message, 0);
+}
+
+/**
+ * @brief Send a request and call onResponse, from update(), with the response of the server.
+ * @note The server must answer with Server::reply(). Nothing is called if the connection is
+ *       lost first.
+ */
+void Client::call(const Message&                                          request,
+                  const std::function<void(const MessageView& response)>& onResponse)
+{
+    _call(request, 0, onResponse);
+}
+
+// Les ids sont propres a la connexion: les canaux d'un ClientPool partagent la meme sequence
+void Client::_call(const Message& request, uint64_t channel,
+                   const std::function<void(const MessageView& response)>& onResponse)
+{
+    if (_fd < 0)
+        return;
+
+    uint64_t correlationId = _nextCorrelationId++;
+    if (_nextCorrelationId == 0)
+        _nextCorrelationId = 1;
+
+    _calls[correlationId] = onResponse;
+    _send(request, correlationId, channel);
+}
+
+/**
+ * @brief Send a request; the future is fulfilled by the update() that receives the response.
+ * @warning Waiting on the future from the thread that calls update() never returns.
+ */
+std::future<Message> Client::call(const Message& request)
+{
+    auto                 promise = std::make_shared<std::promise<Message>>();
+    std::future<Message> future  = promise->get_future();
+
+    call(request, [promise](const MessageView& response)
+         { promise->set_value(static_cast<Message>(response)); });
+    return future;
+}
+
+/**
+ * @brief Number of call() still waiting for their response.
+ */
+size_t Client::pendingCalls() const
+{
+    return _calls.size();
+}
+
+void Client::_send(const Message& message, uint64_t correlationId, uint64_t channel)
+{
+    if (_fd < 0)
+        return;
+
+    bool wasCongested = _outbox.congested();
+
+    // Header et payload partent dans un seul sendmsg(): seul ce qui n'est pas envoye est copie
+    Message::Header            wire = {};
+    std::vector<unsigned char> packed;
+    wire.correlationId = correlationId;
+    wire.channel       = channel;
+
+    const unsigned char* payload = message.packPayload(wire, packed);
+    unsigned char        header[MESSAGE_HEADER_MAX_SIZE];
+    size_t               headerSize = Message::encodeHeader(wire, _format, header);
+
+    iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len  = headerSize;
+    iov[1].iov_base = const_cast<unsigned char*>(payload);
+    iov[1].iov_len  = wire.size;
+
+    size_t before = _outbox.size();
+    if (!_outbox.write(_fd, iov, 2))
+    {
+        disconnect();
+        _outbox.clear();
+    }
+    else
+    {
+        _stats->frameSent();
+        _stats->wrote(before + headerSize + wire.size - _outbox.size(), !_outbox.empty());
+    }
+    _notifyBackpressure(wasCongested);
+}
+
+void Client::_flush(bool wasCongested)
+{
+    // Erreur fatale: le serveur est parti, comme pour la reception on ne leve pas d'exception
+    size_t before = _outbox.size();
+    if (!_outbox.flush(_fd))
+    {
+        disconnect();
+        _outbox.clear();
+    }
+    else
+        _stats->wrote(before - _outbox.size(), !_outbox.empty());
+    _notifyBackpressure(wasCongested);
+}
+
+// Appele apres chaque changement de _outbox: la jauge des statistiques suit
+void Client::_notifyBackpressure(bool wasCongested)
+{
+    _countQueued();
+    if (_outbox.congested() != wasCongested && _backpressureAction)
+        _backpressureAction(_outbox.congested());
+}
+
+void Client::_countQueued()
+{
+    _stats->queued(_statsQueued, _outbox.size());
+    _statsQueued = _outbox.size();
+}
+
+/**
+ * @brief Traffic counters and latency histograms of the client, readable from any thread.
+ */
+NetStats& Client::stats()
+{
+    return *_stats;
+}
+
+/**
+ * @brief Configure the output queue size at which the client is reported as congested.
+ */
+void Client::setOutputWaterMarks(size_t highWaterMark, size_t lowWaterMark)
+{
+    _outbox.setWaterMarks(highWaterMark, lowWaterMark);
+}
+
+void Client::defineBackpressureAction(const std::function<void(bool congested)>& action)
+{
+    _backpressureAction = action;
+}
+
+/**
+ * @brief Number of bytes sent with send() but not yet accepted by the socket.
+ */
+size_t Client::pendingOutput() const
+{
+    return _outbox.size();
 }
 
 bool Client::_isConnected() const
@@ -76,13 +375,14 @@ bool Client::_isConnected() const
 
 void Client::_receiveMessage()
 {
-
-    char buffRead[MAX_READ_BUFFER];
-    int  bytes;
-    while ((bytes = recv(_fd, buffRead, sizeof(buffRead), MSG_DONTWAIT)) > 0)
+    ssize_t bytes;
+    while ((bytes = recv(_fd, _inbox.prepare(MAX_READ_BUFFER), MAX_READ_BUFFER, MSG_DONTWAIT)) > 0)
     {
-        _tmpMsg.appendBytes(reinterpret_cast<unsigned char*>(buffRead), bytes);
+        _inbox.commit(bytes);
+        _stats->read(bytes);
+        _received = true;
     }
+    _extractFrames();
 
     if (bytes == 0)
     {
@@ -105,51 +405,228 @@ void Client::_receiveMessage()
 
         _networkError("Cannot receive message: ");
     }
+}
 
-    while (_tmpMsg.isComplet())
-    {
-        Message::Type msgType;
-        _tmpMsg >> msgType;
+Client::Backend Client::backend() const
+{
+    return _backend;
+}
 
-        Message newMsg(msgType);
+// Un tour de la boucle: false si rien ne s'est passe pendant timeoutMs
+bool Client::_pollLoop(int timeoutMs)
+{
+    size_t handled;
+
+    // Les messages recus restent dans _inbox: update() les distribue avec son budget
+    _deferDispatch = true;
+    try
+    {
+        handled = _loop->runOnce(timeoutMs);
+    }
+    catch (...)
+    {
+        _deferDispatch = false;
+        throw;
+    }
+    _deferDispatch = false;
+    return handled > 0;
+}
 
-        size_t dataSize;
-        _tmpMsg >> dataSize;
+bool Client::_pollUring(int timeoutMs)
+{
+    if (!_uring)
+        return false;
 
-        newMsg.appendBytes(_tmpMsg.getBuffer()->data().data(), dataSize);
+    if (!_outbox.empty() && !_uringPollOut)
+    {
+        _uring->pollOut(_fd, CLIENT_URING_POLLOUT);
+        _uringPollOut = true;
+    }
 
-        _tmpMsg.incr_cursor(dataSize);
+    _uring->wait(timeoutMs);
 
-        _msgs.push_back(newMsg);
+    bool                handled = false;
+    IoUring::Completion completion;
+    while (_uring && _uring->next(completion))
+    {
+        handled = true;
+        _handleUringCompletion(completion);
     }
+    _extractFrames();
+    return handled;
 }
 
-void Client::update()
+// Un header invalide rend le reste du flux illisible: la connexion est fermee
+void Client::_extractFrames()
 {
-    if (!_isConnected())
+    if (!_received)
         return;
-    while (_fd > 0)
+    _received = false;
+
+    bool wasIdle = _inbox.frames().empty();
+    try
+    {
+        size_t count = _inbox.extract();
+        _stats->framesReceived(count, _inbox.pending() > 0);
+        if (count > 0 && wasIdle && _stats->timing())
+            _receivedAt = NetStats::Clock::now();
+    }
+    catch (const std::runtime_error&)
     {
-        FD_ZERO(&_readyRead);
-        FD_SET(_fd, &_readyRead);
+        disconnect();
+        throw;
+    }
+}
+
+void Client::_handleUringCompletion(const IoUring::Completion& completion)
+{
+    if (completion.userData == CLIENT_URING_POLLOUT)
+    {
+        _uringPollOut = false;
+        return _flush(_outbox.congested());
+    }
+
+    if (completion.hasBuffer())
+    {
+        if (completion.result > 0)
+        {
+            _inbox.append(_uring->buffer(completion.bufferId()), completion.result);
+            _stats->read(completion.result);
+            _received = true;
+        }
+        _uring->recycle(completion.bufferId());
+    }
+
+    if (completion.result == 0)
+        return disconnect(); // Connexion fermée par le serveur
 
-        timeval timeout = {0, 10000}; // Pour que le select soit non bloquant
+    if (completion.result < 0 && completion.result != -ENOBUFS)
+    {
+        errno = -completion.result;
+        if (errno == ENOTCONN || errno == ECONNRESET || errno == EPIPE || errno == EBADF)
+            return disconnect();
+        return _networkError("Cannot receive message: ");
+    }
+
+    // Plus de buffer libre, ou requete terminee par le noyau: on la rearme
+    if (!completion.more())
+        _uring->recvMultishot(_fd, CLIENT_URING_RECV);
+}
+
+/**
+ * @brief Receive and handle messages until the network is idle or the budget is spent.
+ * @param maxMessages Maximum number of messages handled (0: no limit)
+ * @param maxDuration Maximum time spent in update() (0: no limit), checked after each handler
+ * @return Number of messages handled
+ */
+size_t Client::update(size_t maxMessages, std::chrono::milliseconds maxDuration)
+{
+    using Clock                  = std::chrono::steady_clock;
+    Clock::time_point deadline   = maxDuration.count() > 0 ? Clock::now() + maxDuration
+                                                           : Clock::time_point::max();
+    size_t            dispatched = 0;
+    bool              connected  = _isConnected();
 
-        int ready = select(_fd + 1, &_readyRead, NULL, NULL, &timeout);
-        if (ready <= 0 || !FD_ISSET(_fd, &_readyRead))
+    while (true)
+    {
+        // Les messages deja recus passent avant toute nouvelle lecture
+        dispatched += _dispatch(maxMessages > 0 ? maxMessages - dispatched : 0, deadline);
+        if (!connected || _fd <= 0 || (maxMessages > 0 && dispatched >= maxMessages))
             break;
 
-        _receiveMessage();
+        int timeoutMs = CLIENT_POLL_TIMEOUT_MS;
+        if (maxDuration.count() > 0)
+        {
+            auto remaining = deadline - Clock::now();
+            if (remaining <= Clock::duration::zero())
+                break;
+            // Arrondi au superieur: une attente de 0 ms ferait tourner la boucle a vide
+            auto remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                remaining + std::chrono::milliseconds(1) - Clock::duration(1));
+            if (remainingMs.count() < timeoutMs)
+                timeoutMs = static_cast<int>(remainingMs.count());
+        }
+
+        bool active =
+            _backend == Backend::IO_URING ? _pollUring(timeoutMs) : _pollLoop(timeoutMs);
+        if (!active)
+            break;
+    }
+    return dispatched;
+}
+
+/**
+ * @brief Call the handlers of the received messages, at most maxMessages of them (0: all).
+ * @details Stops after the first handler that returns past the deadline: the remaining frames
+ *          stay in the inbox for the next call. Stops as well after a handler that reconnects,
+ *          since connect() drops the frames of the old connection. The frames handled before a
+ *          handler throws, and the one that threw, are released before the exception goes on.
+ */
+size_t Client::_dispatch(size_t maxMessages, std::chrono::steady_clock::time_point deadline)
+{
+    bool     timing   = _stats->timing();
+    bool     bounded  = deadline != std::chrono::steady_clock::time_point::max();
+    uint64_t connects = _connects;
+    size_t   handled  = 0;
+    while ((maxMessages == 0 || handled < maxMessages) && handled < _inbox.frames().size())
+    {
+        const FrameBuffer::Frame& frame = _inbox.frames()[handled++];
+        _stats->dispatched(frame.type, frame.size);
+        try
+        {
+            if (!timing)
+                _dispatchFrame(frame);
+            else
+            {
+                NetStats::Clock::time_point start = NetStats::Clock::now();
+                _stats->dispatchDelay(start - _receivedAt);
+                _dispatchFrame(frame);
+                _stats->handlerTime(NetStats::Clock::now() - start);
+            }
+        }
+        catch (...)
+        {
+            if (_connects == connects)
+                _inbox.release(handled);
+            throw;
+        }
+
+        if (_connects != connects)
+            return handled;
+        if (bounded && std::chrono::steady_clock::now() >= deadline)
+            break;
     }
+    _inbox.release(handled);
+    return handled;
+}
+
+void Client::_dispatchFrame(const FrameBuffer::Frame& frame)
+{
+    // Keepalive du serveur: repondu ici, jamais vu par les actions
+    if (frame.type == MESSAGE_TYPE_PING)
+        return send(Message(MESSAGE_TYPE_PONG));
+
+    MessageView msg = _inbox.view(frame);
 
-    for (auto& msg : _msgs)
+    // Reponse a un call(): un seul destinataire, retrouve par son id
+    auto callIt = msg.correlationId() != 0 ? _calls.find(msg.correlationId()) : _calls.end();
+    if (callIt != _calls.end())
     {
-        auto it = _triggers.find(msg.type());
-        if (it == _triggers.end())
-            continue;
+        auto onResponse = std::move(callIt->second);
+        _calls.erase(callIt);
+        return onResponse(msg);
+    }
 
-        for (auto& funct : it->second)
-            funct(msg);
+    if (_channelSink)
+        return _channelSink(frame.channel, msg);
+
+    auto it = _triggers.find(frame.type);
+    if (it == _triggers.end())
+        return;
+
+    for (auto& funct : it->second)
+    {
+        msg.reset();
+        funct(msg);
     }
-    _msgs.clear();
-}
\ No newline at end of file
+}
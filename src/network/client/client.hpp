@@ -2,6 +2,7 @@
 #define CLIENT_HPP
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <string.h>
@@ -9,34 +10,74 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <future>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
-#define MAX_READ_BUFFER 16000
+#define MAX_READ_BUFFER        16000
+#define CLIENT_POLL_TIMEOUT_MS 10 // Attente maximale d'un tour de poll sans evenement
 
+#include "../event_loop/event_loop.hpp"
+#include "../frame_buffer/frame_buffer.hpp"
+#include "../io_uring/io_uring.hpp"
 #include "../message/message.hpp"
+#include "../message_view/message_view.hpp"
+#include "../net_stats/net_stats.hpp"
+#include "../output_queue/output_queue.hpp"
 
 /**
- * @brief Basic TCP client class using POSIX sockets and select() for network communication.
+ * @brief Basic TCP client class using POSIX sockets and an EventLoop for network communication.
  *
  * This class provides a simple TCP client implementation with message-based communication.
  * It supports asynchronous message handling through callback functions and maintains
- * connection state using file descriptors and select() for non-blocking operations.
+ * connection state using file descriptors and an epoll based EventLoop for non-blocking
+ * operations.
  *
  * @note Limited by the maximum number of bytes that can be read at once (MAX_READ_BUFFER = 16000)
- * @note Uses select() for non-blocking socket operations
+ * @note The connection is registered once in the EventLoop (edge-triggered): update() waits in a
+ *       single epoll_wait() and rebuilds nothing between calls. By default the client owns its
+ *       loop; attach() registers it in a shared one instead, so that one thread and one wait
+ *       serve a Server and any number of clients. Messages are then handled from the loop
+ *       (EventLoop::run() or runOnce()) as soon as they arrive. Backend::SELECT is the former
+ *       name of the default backend and is kept as an alias of Backend::EPOLL
  * @note Supports callback-based message handling with type-specific actions
  * @note Automatically handles message parsing and reconstruction for partial reads
+ * @note Received messages are never copied: actions get a MessageView into the receive buffer
+ * @note send() never blocks: what the socket cannot take right away is queued and sent by the
+ *       next update(). The backpressure action reports when that queue crosses its water marks
+ * @note Backend::IO_URING (Linux, see IoUring::available()) replaces epoll and recv() by a
+ *       multishot recv armed once per connection: update() then costs one io_uring_enter()
+ *       however many messages arrive
+ * @note setWireFormat(Message::WireFormat::COMPACT) switches the connection to varint headers
+ *       (2 bytes instead of 12 for small messages). The request is sent in the current format and
+ *       everything sent after it uses the new one; wireFormat() tells once the server has
+ *       acknowledged it and answers in that format too. It is renewed on each connect()
+ * @note call() sends a request tagged with a new correlation id and keeps its callback until
+ *       the response carrying the same id arrives (see Server::reply()): any number of requests
+ *       can be in flight, responses are matched in O(1) whatever their order, and they are not
+ *       passed to the type actions. Pending calls are dropped on disconnect() (a future from
+ *       call() then reports std::future_error broken_promise)
+ * @note update() returns once the network has been idle for CLIENT_POLL_TIMEOUT_MS, or earlier
+ *       when its budget is spent (maxMessages handled, maxDuration elapsed, 0 means no limit).
+ *       update(1) waits for the next message at most CLIENT_POLL_TIMEOUT_MS
+ * @note Keepalive pings of a server (Server::setIdleTimeout()) are answered from update(): a
+ *       client that keeps calling it stays connected even when it has nothing to send
+ * @note stats() counts bytes, frames (per type) and the output queue, and can time handlers
+ *       (see NetStats). It can be read from any thread, and stays valid if the client is moved
  *
  * @code
  * // Create and connect to server
  * Client client;
  * client.connect("127.0.0.1", 8080);
+ * client.setWireFormat(Message::WireFormat::COMPACT); // Optional: smaller headers
  *
  * // Define message handler for specific message type
- * client.defineAction(1001, [](const Message& msg) {
+ * client.defineAction(1001, [](const MessageView& msg) {
  *     std::string response;
  *     msg >> response;
  *     std::cout << "Received: " << response << std::endl;
@@ -47,9 +88,18 @@
  * msg << std::string("Hello Server");
  * client.send(msg);
  *
+ * // Request / response: the callback runs in update() when the matching response arrives
+ * client.call(request, [](const MessageView& response) { ... });
+ * std::future<Message> answer = client.call(request);
+ *
  * // Process incoming messages
  * client.update(); // Call regularly in your main loop
  *
+ * // Or share the thread of a server (see EventLoop)
+ * EventLoop loop;
+ * client.attach(loop);
+ * loop.run();
+ *
  * client.disconnect();
  * @endcode
  *
@@ -58,36 +108,109 @@
  * @throws May re-throw any exceptions from registered callback functions
  * @see Message for message format and usage
  * @see Server for corresponding server implementation
+ * @see ClientPool to multiplex many logical sessions over a few connections
  */
 class Client
 {
+    friend class ClientPool;
+
+public:
+    enum class Backend
+    {
+        EPOLL,
+        IO_URING,
+        SELECT = EPOLL // Ancien nom du backend par defaut
+    };
+
 private:
-    std::vector<Message> _msgs;
-    std::unordered_map<Message::Type, std::vector<std::function<void(const Message& msg)>>>
+    std::unordered_map<Message::Type, std::vector<std::function<void(const MessageView& msg)>>>
         _triggers;
 
-    Message _tmpMsg;
-    int     _fd;
+    FrameBuffer         _inbox;
+    uint64_t            _connects = 0; // Par connect(), qui vide _inbox: un handler peut l'appeler
+    OutputQueue         _outbox;
+    int                 _fd;
+    Backend             _backend;
+    Message::WireFormat _format          = Message::WireFormat::LEGACY;
+    Message::WireFormat _requestedFormat = Message::WireFormat::LEGACY;
+
+    std::unique_ptr<IoUring> _uring;
+    bool                     _uringPollOut = false;
+
+    EventLoop*                 _loop = nullptr; // _ownLoop, ou la boucle partagee de attach()
+    std::unique_ptr<EventLoop> _ownLoop;
+    bool                       _deferDispatch = false; // update() distribue avec son budget
+
+    std::unordered_map<uint64_t, std::function<void(const MessageView& response)>> _calls;
+    uint64_t _nextCorrelationId = 1;
 
-    fd_set _readyRead;
+    // ClientPool: recoit les messages (hors reponses a call()) a la place des actions
+    std::function<void(uint64_t channel, const MessageView& msg)> _channelSink;
 
-    void _networkError(std::string&& errorMessage);
-    void _receiveMessage();
-    bool _isConnected() const;
+    std::function<void(bool congested)> _backpressureAction;
+
+    // Sur le tas: une reference prise par un autre thread survit au deplacement du client
+    std::unique_ptr<NetStats>   _stats;
+    size_t                      _statsQueued = 0; // Part de _outbox deja comptee dans _stats
+    NetStats::Clock::time_point _receivedAt; // Arrivee de la plus ancienne frame en attente
+    bool                        _received = false; // Octets recus depuis le dernier decoupage
+
+    void   _networkError(std::string&& errorMessage);
+    void   _send(const Message& message, uint64_t correlationId, uint64_t channel = 0);
+    void   _call(const Message& request, uint64_t channel,
+                 const std::function<void(const MessageView& response)>& onResponse);
+    void   _receiveMessage();
+    void   _extractFrames();
+    void   _requestWireFormat();
+    void   _watch();
+    void   _onEvents(uint32_t events);
+    bool   _pollLoop(int timeoutMs);
+    bool   _pollUring(int timeoutMs);
+    size_t _dispatch(size_t                                maxMessages,
+                     std::chrono::steady_clock::time_point deadline =
+                         std::chrono::steady_clock::time_point::max());
+    void   _dispatchFrame(const FrameBuffer::Frame& frame);
+    void   _handleUringCompletion(const IoUring::Completion& completion);
+    void   _flush(bool wasCongested);
+    void   _notifyBackpressure(bool wasCongested);
+    void   _countQueued();
+    bool   _isConnected() const;
 
 public:
-    Client();
-    Client(const std::string& address, const size_t& port);
+    Client(Backend backend = Backend::EPOLL);
+    Client(const std::string& address, const size_t& port, Backend backend = Backend::EPOLL);
+    Client(Client&& other) noexcept;
+    Client& operator=(Client&& other) = delete;
+    ~Client();
+
+    void attach(EventLoop& loop);
 
     void connect(const std::string& address, const size_t& port);
     void disconnect();
 
-    void defineAction(const Message::Type&                           messageType,
-                      const std::function<void(const Message& msg)>& action);
+    void defineAction(const Message::Type&                               messageType,
+                      const std::function<void(const MessageView& msg)>& action);
 
     void send(const Message& message);
 
-    void update();
+    void call(const Message& request,
+              const std::function<void(const MessageView& response)>& onResponse);
+    std::future<Message> call(const Message& request);
+    size_t               pendingCalls() const;
+
+    void   setOutputWaterMarks(size_t highWaterMark, size_t lowWaterMark);
+    void   defineBackpressureAction(const std::function<void(bool congested)>& action);
+    size_t pendingOutput() const;
+
+    NetStats& stats();
+
+    void                setWireFormat(Message::WireFormat format);
+    Message::WireFormat wireFormat() const;
+
+    Backend backend() const;
+
+    size_t update(size_t                    maxMessages = 0,
+                  std::chrono::milliseconds maxDuration = std::chrono::milliseconds::zero());
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "client_pool.hpp"
+
+ClientPool::Channel::Channel(ClientPool* pool, size_t id) : _pool(pool), _id(id) {}
+
+void ClientPool::Channel::send(const Message& message)
+{
+    _pool->_connection(_id)._send(message, 0, _pool->_wireChannel(_id));
+}
+
+/**
+ * @brief Like Client::call(): the response of the server (Server::reply()) goes to onResponse.
+ */
+void ClientPool::Channel::call(const Message&                                          request,
+                               const std::function<void(const MessageView& response)>& onResponse)
+{
+    _pool->_connection(_id)._call(request, _pool->_wireChannel(_id), onResponse);
+}
+
+std::future<Message> ClientPool::Channel::call(const Message& request)
+{
+    auto                 promise = std::make_shared<std::promise<Message>>();
+    std::future<Message> future  = promise->get_future();
+
+    call(request, [promise](const MessageView& response)
+         { promise->set_value(static_cast<Message>(response)); });
+    return future;
+}
+
+void ClientPool::Channel::defineAction(const Message::Type& messageType,
+                                       const std::function<void(const MessageView& msg)>& action)
+{
+    _pool->_channels[_id][messageType].push_back(action);
+}
+
+size_t ClientPool::Channel::id() const
+{
+    return _id;
+}
+
+ClientPool::ClientPool(size_t nbConnections) : _ownLoop(new EventLoop())
+{
+    if (nbConnections == 0)
+        throw std::invalid_argument("ClientPool needs at least one connection");
+
+    _loop = _ownLoop.get();
+    for (size_t i = 0; i < nbConnections; i++)
+    {
+        _connections.emplace_back(new Client());
+        _connections[i]->attach(*_loop);
+        _connections[i]->_channelSink = [this, i](uint64_t channel, const MessageView& msg)
+        { _deliver(i, channel, msg); };
+    }
+}
+
+ClientPool::ClientPool(const std::string& address, const size_t& port, size_t nbConnections)
+    : ClientPool(nbConnections)
+{
+    connect(address, port);
+}
+
+ClientPool::~ClientPool()
+{
+    disconnect();
+}
+
+/**
+ * @brief Register every connection in a shared EventLoop (see Client::attach()).
+ */
+void ClientPool::attach(EventLoop& loop)
+{
+    for (auto& connection : _connections)
+        connection->attach(loop);
+    _loop = &loop;
+    _ownLoop.reset();
+}
+
+void ClientPool::connect(const std::string& address, const size_t& port)
+{
+    for (auto& connection : _connections)
+        connection->connect(address, port);
+}
+
+void ClientPool::disconnect()
+{
+    for (auto& connection : _connections)
+        connection->disconnect();
+}
+
+/**
+ * @brief Create a new logical session. The server sees it on its first message.
+ */
+ClientPool::Channel ClientPool::open()
+{
+    _channels.emplace_back();
+    return Channel(this, _channels.size() - 1);
+}
+
+size_t ClientPool::channels() const
+{
+    return _channels.size();
+}
+
+/**
+ * @brief Number of connections still open.
+ */
+size_t ClientPool::connections() const
+{
+    size_t count = 0;
+    for (const auto& connection : _connections)
+        count += connection->_fd >= 0;
+    return count;
+}
+
+size_t ClientPool::pendingCalls() const
+{
+    size_t count = 0;
+    for (const auto& connection : _connections)
+        count += connection->pendingCalls();
+    return count;
+}
+
+/**
+ * @brief Switch every connection to another wire format (see Client::setWireFormat()).
+ */
+void ClientPool::setWireFormat(Message::WireFormat format)
+{
+    for (auto& connection : _connections)
+        connection->setWireFormat(format);
+}
+
+Client& ClientPool::_connection(size_t channel)
+{
+    return *_connections[channel % _connections.size()];
+}
+
+uint64_t ClientPool::_wireChannel(size_t channel) const
+{
+    return channel / _connections.size();
+}
+
+void ClientPool::_deliver(size_t connection, uint64_t wireChannel, const MessageView& msg)
+{
+    size_t channel = wireChannel * _connections.size() + connection;
+    if (channel >= _channels.size())
+        return;
+
+    auto it = _channels[channel].find(msg.type());
+    if (it == _channels[channel].end())
+        return;
+
+    for (auto& funct : it->second)
+    {
+        msg.reset();
+        funct(msg);
+    }
+}
+
+/**
+ * @brief Receive and handle messages of every connection until the network is idle or the
+ * budget is spent (see Client::update()).
+ * @return Number of messages handled
+ */
+size_t ClientPool::update(size_t maxMessages, std::chrono::milliseconds maxDuration)
+{
+    using Clock                  = std::chrono::steady_clock;
+    Clock::time_point deadline   = maxDuration.count() > 0 ? Clock::now() + maxDuration
+                                                           : Clock::time_point::max();
+    size_t            dispatched = 0;
+
+    while (true)
+    {
+        // Les messages deja recus passent avant toute nouvelle lecture
+        dispatched += _dispatch(maxMessages > 0 ? maxMessages - dispatched : 0, deadline);
+        if (connections() == 0 || (maxMessages > 0 && dispatched >= maxMessages))
+            break;
+
+        int timeoutMs = CLIENT_POLL_TIMEOUT_MS;
+        if (maxDuration.count() > 0)
+        {
+            auto remaining = deadline - Clock::now();
+            if (remaining <= Clock::duration::zero())
+                break;
+            // Arrondi au superieur: une attente de 0 ms ferait tourner la boucle a vide
+            auto remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                remaining + std::chrono::milliseconds(1) - Clock::duration(1));
+            if (remainingMs.count() < timeoutMs)
+                timeoutMs = static_cast<int>(remainingMs.count());
+        }
+
+        if (!_poll(timeoutMs))
+            break;
+    }
+    return dispatched;
+}
+
+size_t ClientPool::_dispatch(size_t maxMessages, std::chrono::steady_clock::time_point deadline)
+{
+    size_t dispatched = 0;
+    for (auto& connection : _connections)
+    {
+        if (maxMessages > 0 && dispatched >= maxMessages)
+            break;
+        if (deadline != std::chrono::steady_clock::time_point::max() &&
+            std::chrono::steady_clock::now() >= deadline)
+            break;
+        dispatched +=
+            connection->_dispatch(maxMessages > 0 ? maxMessages - dispatched : 0, deadline);
+    }
+    return dispatched;
+}
+
+// Un seul epoll_wait() pour toutes les connexions: false si rien ne s'est passe pendant timeoutMs
+bool ClientPool::_poll(int timeoutMs)
+{
+    // Comme Client::update(): les messages recus attendent _dispatch() et son budget
+    for (auto& connection : _connections)
+        connection->_deferDispatch = true;
+
+    size_t handled;
+    try
+    {
+        handled = _loop->runOnce(timeoutMs);
+    }
+    catch (...)
+    {
+        for (auto& connection : _connections)
+            connection->_deferDispatch = false;
+        throw;
+    }
+    for (auto& connection : _connections)
+        connection->_deferDispatch = false;
+    return handled > 0;
+}
@@ -0,0 +1,116 @@
+#ifndef CLIENT_POOL_HPP
+#define CLIENT_POOL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../client/client.hpp"
+#include "../event_loop/event_loop.hpp"
+
+/**
+ * @brief Many logical client sessions multiplexed over a few TCP connections to one Server.
+ *
+ * Each channel behaves like its own Client: it has its own actions, its own call() responses,
+ * and the server sees it as a distinct client ID (see Server). Channels are spread over the
+ * connections in turn: channel c uses connection c % N, where it is tagged with the wire
+ * channel c / N in the message header. The first channel of each connection uses the default
+ * channel 0, so its frames carry no extra header byte.
+ *
+ * Every connection is registered in a single EventLoop: update() waits for all of them with one
+ * epoll_wait(), instead of one Client::update() and one wait per session. attach() moves them
+ * to a loop shared with other clients or a Server.
+ *
+ * @code
+ * ClientPool pool("127.0.0.1", 8080, 4); // 4 TCP connections
+ * pool.setWireFormat(Message::WireFormat::COMPACT);
+ *
+ * std::vector<ClientPool::Channel> sessions;
+ * for (int i = 0; i < 1000; i++)
+ *     sessions.push_back(pool.open());   // 1000 sessions, 4 sockets
+ *
+ * sessions[42].defineAction(1002, [](const MessageView& msg) { ... });
+ * sessions[42].send(request);
+ * sessions[42].call(request, [](const MessageView& response) { ... });
+ *
+ * while (running)
+ *     pool.update(); // one epoll_wait() for every connection
+ * @endcode
+ *
+ * @note The server opens a session on the first message of a channel and keeps it until the
+ *       connection closes: a channel cannot be closed on its own
+ * @note Channels are only valid as long as the pool; connect() keeps them but the server sees
+ *       new sessions afterwards
+ * @note Not thread-safe, like Client: one thread sends and calls update()
+ *
+ * @throws std::runtime_error on network errors (see Client::connect()) or if epoll fails
+ * @see Client, Server
+ */
+class ClientPool
+{
+public:
+    class Channel
+    {
+    private:
+        ClientPool* _pool;
+        size_t      _id;
+
+    public:
+        Channel(ClientPool* pool, size_t id);
+
+        void send(const Message& message);
+        void call(const Message& request,
+                  const std::function<void(const MessageView& response)>& onResponse);
+        std::future<Message> call(const Message& request);
+
+        void defineAction(const Message::Type&                               messageType,
+                          const std::function<void(const MessageView& msg)>& action);
+
+        size_t id() const;
+    };
+
+private:
+    using Triggers =
+        std::unordered_map<Message::Type, std::vector<std::function<void(const MessageView&)>>>;
+
+    EventLoop*                           _loop = nullptr; // Detruite apres les connexions
+    std::unique_ptr<EventLoop>           _ownLoop;
+    std::vector<std::unique_ptr<Client>> _connections;
+    std::vector<Triggers>                _channels;
+
+    Client&  _connection(size_t channel);
+    uint64_t _wireChannel(size_t channel) const;
+    void     _deliver(size_t connection, uint64_t wireChannel, const MessageView& msg);
+    size_t   _dispatch(size_t maxMessages, std::chrono::steady_clock::time_point deadline);
+    bool     _poll(int timeoutMs);
+
+public:
+    ClientPool(size_t nbConnections);
+    ClientPool(const std::string& address, const size_t& port, size_t nbConnections);
+    ~ClientPool();
+
+    ClientPool(const ClientPool&)            = delete;
+    ClientPool& operator=(const ClientPool&) = delete;
+
+    void attach(EventLoop& loop);
+    void connect(const std::string& address, const size_t& port);
+    void disconnect();
+
+    Channel open();
+    size_t  channels() const;
+    size_t  connections() const;
+    size_t  pendingCalls() const;
+
+    void setWireFormat(Message::WireFormat format);
+
+    size_t update(size_t                    maxMessages = 0,
+                  std::chrono::milliseconds maxDuration = std::chrono::milliseconds::zero());
+};
+
+#endif
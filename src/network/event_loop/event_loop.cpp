@@ -0,0 +1,293 @@
+#include "event_loop.hpp"
+
+// data.u64 de l'eventfd de reveil: les enregistrements commencent a 1
+#define EVENT_LOOP_WAKE_ID 0
+
+EventLoop::EventLoop() : _events(EVENT_LOOP_MAX_EVENTS)
+{
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd < 0)
+        throw std::runtime_error("Failed to create epoll instance. errno: " +
+                                 std::to_string(errno));
+}
+
+EventLoop::~EventLoop()
+{
+    if (_wakeFd >= 0)
+        close(_wakeFd);
+    close(_epollFd);
+}
+
+/**
+ * @brief Watch fd and call handler with the epoll events (EPOLLET for edge-triggered).
+ * @throws std::invalid_argument if fd is already registered
+ */
+void EventLoop::add(int fd, uint32_t events, const Handler& handler)
+{
+    if (_fds.count(fd))
+        throw std::invalid_argument("EventLoop::add(): fd already registered");
+
+    uint64_t    id = _nextRegistration++;
+    epoll_event ev;
+    ev.events   = events;
+    ev.data.u64 = id;
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+        throw std::runtime_error("EventLoop::add(): epoll_ctl failed. errno: " +
+                                 std::to_string(errno));
+
+    _registrations[id] = {fd, std::make_shared<Handler>(handler)};
+    _fds[fd]           = id;
+}
+
+void EventLoop::modify(int fd, uint32_t events)
+{
+    auto fdIt = _fds.find(fd);
+    if (fdIt == _fds.end())
+        throw std::invalid_argument("EventLoop::modify(): fd not registered");
+
+    epoll_event ev;
+    ev.events   = events;
+    ev.data.u64 = fdIt->second;
+    if (epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &ev) < 0)
+        throw std::runtime_error("EventLoop::modify(): epoll_ctl failed. errno: " +
+                                 std::to_string(errno));
+}
+
+/**
+ * @brief Stop watching fd. Must be called before closing it.
+ */
+void EventLoop::remove(int fd)
+{
+    auto fdIt = _fds.find(fd);
+    if (fdIt == _fds.end())
+        return;
+
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+    _registrations.erase(fdIt->second);
+    _fds.erase(fdIt);
+}
+
+bool EventLoop::watches(int fd) const
+{
+    return _fds.count(fd) > 0;
+}
+
+/**
+ * @brief Call callback on the loop thread after delay, then every interval if it is not zero.
+ * @return Id for cancelTimer()
+ */
+EventLoop::TimerId EventLoop::addTimer(std::chrono::milliseconds    delay,
+                                       const std::function<void()>& callback,
+                                       std::chrono::milliseconds    interval)
+{
+    TimerId           id       = _nextTimer++;
+    Clock::time_point deadline = Clock::now() + delay;
+
+    _timers[{deadline, id}] = {callback, interval};
+    _deadlines[id]          = deadline;
+    return id;
+}
+
+/**
+ * @brief Cancel a timer, also from its own callback.
+ * @return false if it already fired (one-shot) or was cancelled
+ */
+bool EventLoop::cancelTimer(TimerId id)
+{
+    auto deadlineIt = _deadlines.find(id);
+    if (deadlineIt == _deadlines.end())
+        return false;
+
+    _timers.erase({deadlineIt->second, id});
+    _deadlines.erase(deadlineIt);
+    return true;
+}
+
+size_t EventLoop::timers() const
+{
+    return _deadlines.size();
+}
+
+/**
+ * @brief Queue a task for the loop thread. Thread-safe, wakes the loop up if it is waiting.
+ */
+void EventLoop::post(const std::function<void()>& task)
+{
+    _posted.push_back(task);
+    _wakeup();
+}
+
+// L'eventfd n'est cree qu'au premier besoin: un Client seul n'en a jamais
+void EventLoop::_wakeup()
+{
+    std::call_once(_wakeOnce,
+                   [this]()
+                   {
+                       _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                       if (_wakeFd < 0)
+                           throw std::runtime_error("Failed to create eventfd. errno: " +
+                                                    std::to_string(errno));
+
+                       epoll_event ev;
+                       ev.events   = EPOLLIN;
+                       ev.data.u64 = EVENT_LOOP_WAKE_ID;
+                       epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &ev);
+                   });
+
+    uint64_t one = 1;
+    if (write(_wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        perror("Failed to wake up event loop");
+}
+
+// Attente raccourcie jusqu'a la prochaine echeance, arrondie au superieur
+int EventLoop::_timeout(int timeoutMs) const
+{
+    if (!_posted.empty())
+        return 0;
+    if (_timers.empty())
+        return timeoutMs;
+
+    auto remaining = _timers.begin()->first.first - Clock::now();
+    if (remaining <= Clock::duration::zero())
+        return 0;
+
+    auto remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        remaining + std::chrono::milliseconds(1) - Clock::duration(1));
+    if (timeoutMs < 0 || remainingMs.count() < timeoutMs)
+        return static_cast<int>(remainingMs.count());
+    return timeoutMs;
+}
+
+// Meme regle que les handlers: une exception est gardee pour la fin du tour
+static void runGuarded(const std::function<void()>& callback, std::exception_ptr& failure)
+{
+    try
+    {
+        callback();
+    }
+    catch (...)
+    {
+        if (!failure)
+            failure = std::current_exception();
+    }
+}
+
+size_t EventLoop::_runTimers(std::exception_ptr& failure)
+{
+    size_t            fired = 0;
+    Clock::time_point now   = Clock::now();
+
+    // Les timers ajoutes pendant ce tour avec un delai nul attendent le suivant
+    while (!_timers.empty() && _timers.begin()->first.first <= now)
+    {
+        auto              timerIt  = _timers.begin();
+        Clock::time_point deadline = timerIt->first.first;
+        TimerId           id       = timerIt->first.second;
+        Timer             timer    = std::move(timerIt->second);
+        _timers.erase(timerIt);
+
+        // Timer ponctuel: oublie avant l'appel, meme s'il leve une exception
+        if (timer.interval.count() <= 0)
+            _deadlines.erase(id);
+
+        runGuarded(timer.callback, failure);
+        fired++;
+
+        // Termine, ou annule pendant son propre appel
+        auto deadlineIt = _deadlines.find(id);
+        if (deadlineIt == _deadlines.end())
+            continue;
+
+        // En retard de plus d'une periode: on ne rattrape pas les tours manques
+        deadline += timer.interval;
+        if (deadline <= now)
+            deadline = now + timer.interval;
+        deadlineIt->second         = deadline;
+        _timers[{deadline, id}] = std::move(timer);
+    }
+    return fired;
+}
+
+size_t EventLoop::_runPosted(std::exception_ptr& failure)
+{
+    size_t                ran = 0;
+    std::function<void()> task;
+    while (_posted.try_pop_front(task))
+    {
+        runGuarded(task, failure);
+        ran++;
+    }
+    return ran;
+}
+
+/**
+ * @brief Wait for events at most timeoutMs (-1: until something happens), then call the
+ * handlers, the due timers and the posted tasks.
+ * @return Number of handlers, timers and tasks run (0: the wait timed out)
+ * @throw The first exception thrown by a handler, timer or task, once the whole round has run:
+ *        the other registrations of the batch still get their events (with EPOLLET they would
+ *        not come back)
+ */
+size_t EventLoop::runOnce(int timeoutMs)
+{
+    int nbEvents = epoll_wait(_epollFd, _events.data(), static_cast<int>(_events.size()),
+                              _timeout(timeoutMs));
+    if (nbEvents < 0 && errno != EINTR)
+        throw std::runtime_error("EventLoop: epoll_wait failed. errno: " + std::to_string(errno));
+
+    size_t             handled = 0;
+    std::exception_ptr failure;
+    for (int i = 0; i < nbEvents; i++)
+    {
+        uint64_t id = _events[i].data.u64;
+        if (id == EVENT_LOOP_WAKE_ID)
+        {
+            uint64_t count;
+            while (read(_wakeFd, &count, sizeof(count)) > 0)
+                ;
+            continue;
+        }
+
+        // Retire par un handler precedent de ce tour: l'evenement est perime
+        auto registrationIt = _registrations.find(id);
+        if (registrationIt == _registrations.end())
+            continue;
+
+        std::shared_ptr<Handler> handler = registrationIt->second.handler;
+        try
+        {
+            (*handler)(_events[i].events);
+        }
+        catch (...)
+        {
+            if (!failure)
+                failure = std::current_exception();
+        }
+        handled++;
+    }
+
+    handled += _runTimers(failure);
+    handled += _runPosted(failure);
+    if (failure)
+        std::rethrow_exception(failure);
+    return handled;
+}
+
+/**
+ * @brief Run the loop until stop(), at once if stop() was already called.
+ * @details Each stop() ends one run(): the loop can be run again afterwards.
+ */
+void EventLoop::run()
+{
+    while (!_stopRequested.exchange(false))
+        runOnce(-1);
+}
+
+/**
+ * @brief Make run() return after the current round, or as soon as it is called. Thread-safe.
+ */
+void EventLoop::stop()
+{
+    _stopRequested = true;
+    _wakeup();
+}
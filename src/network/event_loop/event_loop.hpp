@@ -0,0 +1,131 @@
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../../thread/lock_free_queue/lock_free_queue.hpp"
+
+#define EVENT_LOOP_MAX_EVENTS 256 // Evenements epoll traites par appel systeme
+
+/**
+ * @brief Single-threaded reactor: file descriptors, timers and posted tasks behind one
+ * epoll_wait().
+ *
+ * Anything that owns sockets can register them with a handler called with the epoll events
+ * (EPOLLIN, EPOLLOUT...). Client and ClientPool register their connections, a Server with the
+ * epoll backend registers its own epoll instance: an application with one server and several
+ * outbound clients runs them all from one thread, waiting in a single system call.
+ *
+ * Timers run on the loop thread, once or periodically. The wait is shortened to the next
+ * deadline, so they fire on time without any extra file descriptor.
+ *
+ * post() and stop() are the only thread-safe methods: tasks are queued without lock and the
+ * loop is woken up through an eventfd, created the first time another thread needs it.
+ *
+ * @code
+ * EventLoop loop;
+ *
+ * Server server("0.0.0.0", 8080, Server::Backend::EPOLL);
+ * server.start();
+ * server.attach(loop);
+ *
+ * Client upstream(Client::Backend::EPOLL);
+ * upstream.attach(loop);
+ * upstream.connect("10.0.0.2", 9000);
+ *
+ * loop.addTimer(std::chrono::seconds(1), []() { printStats(); }, std::chrono::seconds(1));
+ * loop.run(); // until loop.stop()
+ * @endcode
+ *
+ * @note Handlers may add or remove any registration, including their own, while they run
+ * @note A handler, timer or task that throws (a Client on a malformed frame) does not cut the
+ *       round short: runOnce() rethrows the first exception after every other one ran. A
+ *       one-shot timer that throws is gone all the same, a periodic one stays scheduled
+ * @note A handler only sees the events of its own registration: after remove() and a new add()
+ *       of the same fd number, pending events of the old one are dropped
+ *
+ * @throws std::runtime_error if epoll or eventfd cannot be created, or if epoll_ctl() fails
+ */
+class EventLoop
+{
+public:
+    using Handler = std::function<void(uint32_t events)>;
+    using TimerId = uint64_t;
+    using Clock   = std::chrono::steady_clock;
+
+private:
+    struct Registration
+    {
+        int                      fd;
+        std::shared_ptr<Handler> handler; // Garde le handler en vie s'il se retire lui-meme
+    };
+
+    struct Timer
+    {
+        std::function<void()>     callback;
+        std::chrono::milliseconds interval;
+    };
+
+    int                                        _epollFd = -1;
+    std::vector<epoll_event>                   _events;
+    std::unordered_map<uint64_t, Registration> _registrations; // Cle: epoll_event.data.u64
+    std::unordered_map<int, uint64_t>          _fds;
+    uint64_t                                   _nextRegistration = 1; // 0: eventfd de reveil
+
+    std::map<std::pair<Clock::time_point, TimerId>, Timer> _timers;
+    std::unordered_map<TimerId, Clock::time_point>         _deadlines;
+    TimerId                                                _nextTimer = 1;
+
+    int                                  _wakeFd = -1;
+    std::once_flag                       _wakeOnce;
+    LockFreeQueue<std::function<void()>> _posted;
+    std::atomic<bool>                    _stopRequested{false}; // Consomme par run() en sortant
+
+    void   _wakeup();
+    int    _timeout(int timeoutMs) const;
+    size_t _runTimers(std::exception_ptr& failure);
+    size_t _runPosted(std::exception_ptr& failure);
+
+public:
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&)            = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    void add(int fd, uint32_t events, const Handler& handler);
+    void modify(int fd, uint32_t events);
+    void remove(int fd);
+    bool watches(int fd) const;
+
+    TimerId addTimer(std::chrono::milliseconds     delay,
+                     const std::function<void()>& callback,
+                     std::chrono::milliseconds     interval = std::chrono::milliseconds::zero());
+    bool    cancelTimer(TimerId id);
+    size_t  timers() const;
+
+    void post(const std::function<void()>& task);
+
+    size_t runOnce(int timeoutMs = -1);
+    void   run();
+    void   stop();
+};
+
+#endif
@@ -0,0 +1,301 @@
+#include "frame_buffer.hpp"
+
+FrameBuffer::FrameBuffer(const FrameBuffer& other)
+    : _begin(other._begin), _frames(other._frames), _firstFrame(other._firstFrame),
+      _consumed(other._consumed), _format(other._format),
+      _correlationId(other._correlationId), _channel(other._channel),
+      _originalSize(other._originalSize), _maxFrameSize(other._maxFrameSize)
+{
+    // _end reste a 0 pendant _reallocate(): il n'y a encore rien a recopier
+    _reallocate(other._capacity);
+    _end = other._end;
+    if (_end > 0)
+        memcpy(_storage.get(), other._storage.get(), _end);
+}
+
+FrameBuffer& FrameBuffer::operator=(const FrameBuffer& other)
+{
+    if (this != &other)
+    {
+        FrameBuffer copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+// Contrairement a std::vector::resize(), la nouvelle memoire n'est pas remise a zero
+void FrameBuffer::_reallocate(size_t capacity)
+{
+    std::unique_ptr<unsigned char[]> storage(capacity > 0 ? new unsigned char[capacity] : nullptr);
+
+    if (_end > 0)
+        memcpy(storage.get(), _storage.get(), _end);
+
+    _storage  = std::move(storage);
+    _capacity = capacity;
+}
+
+/**
+ * @brief Make room for at least len bytes after the received data.
+ * @return Pointer where the next bytes can be written, to be followed by commit().
+ */
+unsigned char* FrameBuffer::prepare(size_t len)
+{
+    // Les octets deja liberes passent avant une reallocation, qui les aurait recopies
+    if (_capacity - _end < len && _consumed > 0)
+        _compact();
+    if (_capacity - _end < len)
+        _reallocate(std::max(_capacity * 2, _end + len));
+
+    return _storage.get() + _end;
+}
+
+/**
+ * @brief Validate len bytes written after a prepare().
+ */
+void FrameBuffer::commit(size_t len)
+{
+    if (_end + len > _capacity)
+        throw std::out_of_range("FrameBuffer::commit(): more bytes than prepared");
+
+    _end += len;
+}
+
+void FrameBuffer::append(const unsigned char* data, size_t len)
+{
+    if (len == 0 || data == nullptr)
+        return;
+
+    memcpy(prepare(len), data, len);
+    commit(len);
+}
+
+/**
+ * @brief Parse every complete frame available.
+ * @return Number of new frames.
+ */
+size_t FrameBuffer::extract()
+{
+    size_t found = 0;
+
+    while (_begin < _end)
+    {
+        Message::Header header;
+        size_t          headerSize =
+            Message::decodeHeader(_storage.get() + _begin, _end - _begin, _format, header);
+
+        if (headerSize == 0)
+            break;
+
+        // Verifie avant d'attendre le payload: une taille annoncee ne doit rien faire allouer
+        if (_maxFrameSize > 0 && header.size > _maxFrameSize)
+            throw std::length_error("FrameBuffer::extract(): frame of " +
+                                    std::to_string(header.size) + " bytes exceeds the limit");
+        if (_end - _begin - headerSize < header.size)
+            break;
+
+        Frame frame = {header.type,          _begin + headerSize, header.size,
+                       header.correlationId, header.channel,      nullptr};
+        _begin      = frame.offset + frame.size;
+
+        // Changement de format: la suite du flux est decoupee avec le nouveau
+        if (frame.type == MESSAGE_TYPE_WIRE_FORMAT)
+        {
+            unsigned char format = frame.size == 1 ? _storage[frame.offset] : 0xFF;
+            if (format > static_cast<unsigned char>(Message::WireFormat::COMPACT))
+                throw std::runtime_error("FrameBuffer::extract(): unknown wire format");
+            _format = static_cast<Message::WireFormat>(format);
+            continue;
+        }
+        if (frame.type == MESSAGE_TYPE_CORRELATION || frame.type == MESSAGE_TYPE_CHANNEL ||
+            frame.type == MESSAGE_TYPE_COMPRESSED)
+        {
+            if (frame.size != sizeof(uint64_t))
+                throw std::runtime_error("FrameBuffer::extract(): malformed prefix frame");
+            uint64_t value;
+            memcpy(&value, _storage.get() + frame.offset, sizeof(uint64_t));
+            if (frame.type == MESSAGE_TYPE_CORRELATION)
+                _correlationId = value;
+            else if (frame.type == MESSAGE_TYPE_CHANNEL)
+                _channel = value;
+            else
+                _originalSize = static_cast<size_t>(value);
+            continue;
+        }
+
+        if (frame.correlationId == 0)
+            frame.correlationId = _correlationId;
+        if (frame.channel == 0)
+            frame.channel = _channel;
+        size_t originalSize = header.originalSize != 0 ? header.originalSize : _originalSize;
+        _correlationId      = 0;
+        _channel            = 0;
+        _originalSize       = 0;
+        if (originalSize != 0)
+            _inflate(frame, originalSize);
+        _frames.push_back(std::move(frame));
+        found++;
+    }
+    return found;
+}
+
+// Le bloc reste dans le buffer de reception: seul le payload decompresse est alloue
+void FrameBuffer::_inflate(Frame& frame, size_t originalSize) const
+{
+    if (_maxFrameSize > 0 && originalSize > _maxFrameSize)
+        throw std::length_error("FrameBuffer::extract(): decompressed frame exceeds the limit");
+    if (originalSize > FRAME_BUFFER_MAX_INFLATED)
+        throw std::runtime_error("FrameBuffer::extract(): compressed payload too large");
+
+    auto inflated = std::make_shared<std::vector<unsigned char>>(originalSize);
+    LzCodec::decompress(_storage.get() + frame.offset, frame.size, inflated->data(),
+                        originalSize);
+    frame.inflated = std::move(inflated);
+}
+
+FrameBuffer::Frames::Frames(const std::vector<Frame>& frames, size_t first)
+    : _frames(&frames), _first(first)
+{
+}
+
+std::vector<FrameBuffer::Frame>::const_iterator FrameBuffer::Frames::begin() const
+{
+    return _frames->begin() + _first;
+}
+
+std::vector<FrameBuffer::Frame>::const_iterator FrameBuffer::Frames::end() const
+{
+    return _frames->end();
+}
+
+size_t FrameBuffer::Frames::size() const
+{
+    return _frames->size() - _first;
+}
+
+bool FrameBuffer::Frames::empty() const
+{
+    return size() == 0;
+}
+
+const FrameBuffer::Frame& FrameBuffer::Frames::operator[](size_t i) const
+{
+    return (*_frames)[_first + i];
+}
+
+FrameBuffer::Frames FrameBuffer::frames() const
+{
+    return Frames(_frames, _firstFrame);
+}
+
+MessageView FrameBuffer::view(const Frame& frame, int fd) const
+{
+    if (frame.inflated)
+        return MessageView(frame.type, frame.inflated->data(), frame.inflated->size(), fd,
+                           frame.correlationId);
+    return MessageView(frame.type, _storage.get() + frame.offset, frame.size, fd,
+                       frame.correlationId);
+}
+
+/**
+ * @brief Forget the extracted frames and reclaim their space.
+ * @details Only the bytes of the trailing incomplete frame are moved.
+ */
+void FrameBuffer::release()
+{
+    _frames.clear();
+    _firstFrame = 0;
+    _consumed   = 0;
+
+    size_t remaining = _end - _begin;
+    if (remaining > 0 && _begin > 0)
+        memmove(_storage.get(), _storage.get() + _begin, remaining);
+    _begin = 0;
+    _end   = remaining;
+
+    // Un gros message ne doit pas garder sa memoire pour toute la duree de la connexion
+    if (_capacity > FRAME_BUFFER_KEEP && _end <= FRAME_BUFFER_KEEP)
+        _reallocate(FRAME_BUFFER_KEEP);
+}
+
+/**
+ * @brief Forget the first count frames only; the others stay available through frames().
+ */
+void FrameBuffer::release(size_t count)
+{
+    if (count >= _frames.size() - _firstFrame)
+        return release();
+    if (count == 0)
+        return;
+
+    _firstFrame += count;
+    _consumed = _frames[_firstFrame - 1].offset + _frames[_firstFrame - 1].size;
+
+    // Chaque octet n'est deplace qu'apres la liberation d'au moins autant d'octets
+    if (_consumed > _capacity / 2)
+        _compact();
+}
+
+// Les frames restantes (et la frame partielle) sont ramenees au debut du buffer
+void FrameBuffer::_compact()
+{
+    memmove(_storage.get(), _storage.get() + _consumed, _end - _consumed);
+
+    _frames.erase(_frames.begin(), _frames.begin() + _firstFrame);
+    for (auto& frame : _frames)
+        frame.offset -= _consumed;
+    _begin -= _consumed;
+    _end -= _consumed;
+    _firstFrame = 0;
+    _consumed   = 0;
+}
+
+// Nouvelle connexion: on repart du format LEGACY
+void FrameBuffer::clear()
+{
+    _frames.clear();
+    _firstFrame    = 0;
+    _consumed      = 0;
+    _begin         = 0;
+    _end           = 0;
+    _format        = Message::WireFormat::LEGACY;
+    _correlationId = 0;
+    _channel       = 0;
+    _originalSize  = 0;
+}
+
+void FrameBuffer::setFormat(Message::WireFormat format)
+{
+    _format = format;
+}
+
+Message::WireFormat FrameBuffer::format() const
+{
+    return _format;
+}
+
+/**
+ * @brief Largest payload accepted by extract() (0: no limit, the default).
+ */
+void FrameBuffer::setMaxFrameSize(size_t maxFrameSize)
+{
+    _maxFrameSize = maxFrameSize;
+}
+
+size_t FrameBuffer::maxFrameSize() const
+{
+    return _maxFrameSize;
+}
+
+/**
+ * @brief Number of received bytes not yet part of a complete frame.
+ */
+size_t FrameBuffer::pending() const
+{
+    return _end - _begin;
+}
+
+size_t FrameBuffer::capacity() const
+{
+    return _capacity;
+}
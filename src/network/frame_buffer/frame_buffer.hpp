@@ -0,0 +1,142 @@
+#ifndef FRAME_BUFFER_HPP
+#define FRAME_BUFFER_HPP
+
+#include <stddef.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../message/message.hpp"
+#include "../message_view/message_view.hpp"
+
+#define FRAME_BUFFER_KEEP         65536    // Capacite conservee entre deux rafales
+#define FRAME_BUFFER_MAX_INFLATED 67108864 // 64 MB: taille max annoncee d'un payload compresse
+
+/**
+ * @brief Per-connection receive buffer that splits a byte stream into message frames in place.
+ *
+ * Bytes are received straight into the buffer (prepare() / commit()), then extract() parses the
+ * [type][size][payload] headers and records where each complete frame lives. Frames are handed
+ * out as MessageView pointing into the buffer: the payload is never copied.
+ *
+ * Frames are stored as offsets, so receiving more data (which may reallocate the storage) does
+ * not invalidate them. Once every frame has been handled, release() drops them and moves the
+ * trailing partial frame, if any, back to the beginning of the buffer. release(count) only drops
+ * the first count frames, for callers that handle frames in bounded batches: it just moves past
+ * them, and the remaining bytes are moved back only once the released ones fill half the storage.
+ *
+ * Headers are parsed in the current wire format (Message::WireFormat, LEGACY at first). A frame
+ * of type MESSAGE_TYPE_WIRE_FORMAT is not returned: its 1 byte payload is the format of the
+ * bytes that follow it, and format() changes accordingly. Neither is a frame of type
+ * MESSAGE_TYPE_CORRELATION: its id is attached to the next frame (Frame::correlationId), nor a
+ * frame of type MESSAGE_TYPE_CHANNEL (Frame::channel).
+ *
+ * Compressed frames (Message::setCompression()) are decompressed by extract() into a buffer
+ * owned by the frame (Frame::inflated): view() always shows the original payload. The announced
+ * size is checked against FRAME_BUFFER_MAX_INFLATED before anything is allocated.
+ *
+ * setMaxFrameSize() bounds the payload a peer may announce: the check is made as soon as a
+ * header is parsed, before its payload is waited for, so a peer cannot make the buffer grow
+ * by announcing a huge frame. It applies to the decompressed size as well.
+ *
+ * @code
+ * FrameBuffer inbox;
+ *
+ * ssize_t bytes = recv(fd, inbox.prepare(4096), 4096, 0);
+ * if (bytes > 0)
+ *     inbox.commit(bytes);
+ *
+ * inbox.extract();
+ * for (const auto& frame : inbox.frames())
+ *     handle(inbox.view(frame));
+ * inbox.release();
+ * @endcode
+ *
+ * @warning A MessageView, like the result of frames(), is only valid until the next prepare(),
+ *          append() or release().
+ * @throws std::runtime_error from extract() on a malformed header, format change or compressed
+ *         block
+ * @throws std::length_error from extract() on a frame larger than setMaxFrameSize()
+ * @see MessageView
+ */
+class FrameBuffer
+{
+public:
+    struct Frame
+    {
+        Message::Type type;
+        size_t        offset;
+        size_t        size;
+        uint64_t      correlationId;
+        uint64_t      channel;
+        std::shared_ptr<const std::vector<unsigned char>> inflated; // Payload decompresse
+    };
+
+    // Frames pas encore liberees: reste valide quand extract() en ajoute
+    class Frames
+    {
+        const std::vector<Frame>* _frames;
+        size_t                    _first;
+
+    public:
+        Frames(const std::vector<Frame>& frames, size_t first);
+
+        std::vector<Frame>::const_iterator begin() const;
+        std::vector<Frame>::const_iterator end() const;
+        size_t                             size() const;
+        bool                               empty() const;
+        const Frame&                       operator[](size_t i) const;
+    };
+
+private:
+    std::unique_ptr<unsigned char[]> _storage;
+    size_t                           _capacity = 0;
+    size_t                           _begin    = 0; // Premier octet pas encore decoupe en frame
+    size_t                           _end      = 0; // Fin des donnees recues
+    std::vector<Frame>               _frames;
+    size_t                           _firstFrame = 0; // Frames deja liberees par release(count)
+    size_t                           _consumed   = 0; // Fin de la derniere frame liberee
+    Message::WireFormat              _format        = Message::WireFormat::LEGACY;
+    uint64_t                         _correlationId = 0; // Annonce pour la prochaine frame
+    uint64_t                         _channel       = 0; // Idem
+    size_t                           _originalSize  = 0; // Idem
+    size_t                           _maxFrameSize  = 0; // 0: pas de limite
+
+    void _reallocate(size_t capacity);
+    void _compact();
+    void _inflate(Frame& frame, size_t originalSize) const;
+
+public:
+    FrameBuffer() = default;
+    FrameBuffer(const FrameBuffer& other);
+    FrameBuffer& operator=(const FrameBuffer& other);
+    FrameBuffer(FrameBuffer&& other)            = default;
+    FrameBuffer& operator=(FrameBuffer&& other) = default;
+
+    unsigned char* prepare(size_t len);
+    void           commit(size_t len);
+    void           append(const unsigned char* data, size_t len);
+
+    size_t                    extract();
+    Frames                    frames() const;
+    MessageView               view(const Frame& frame, int fd = -1) const;
+
+    void release();
+    void release(size_t count);
+    void clear();
+
+    void                setFormat(Message::WireFormat format);
+    Message::WireFormat format() const;
+
+    void   setMaxFrameSize(size_t maxFrameSize);
+    size_t maxFrameSize() const;
+
+    size_t pending() const;
+    size_t capacity() const;
+};
+
+#endif
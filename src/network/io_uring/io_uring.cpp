@@ -0,0 +1,397 @@
+#include "io_uring.hpp"
+
+#if LIBFTPP_HAS_IO_URING
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Les index des anneaux sont partages avec le noyau: acquire en lecture, release en ecriture
+static unsigned loadAcquire(const unsigned* value)
+{
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static void storeRelease(unsigned* value, unsigned newValue)
+{
+    __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+}
+
+static int ioUringSetup(unsigned entries, io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags,
+                        void* arg, size_t argSize)
+{
+    return static_cast<int>(
+        syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize));
+}
+
+static int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned nbArgs)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nbArgs));
+}
+
+IoUring::IoUring(unsigned entries)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags      = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 4; // Les requetes multishot produisent plusieurs completions
+
+    _fd = ioUringSetup(entries, &params);
+    if (_fd < 0)
+        throw std::runtime_error("Failed to create io_uring. errno: " + std::to_string(errno));
+
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG))
+    {
+        _destroy();
+        throw std::runtime_error("Kernel io_uring is too old");
+    }
+
+    size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    _ringSize     = sqSize > cqSize ? sqSize : cqSize;
+
+    _ring = mmap(nullptr, _ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd,
+                 IORING_OFF_SQ_RING);
+    if (_ring == MAP_FAILED)
+    {
+        _ring = nullptr;
+        _destroy();
+        throw std::runtime_error("Failed to map io_uring. errno: " + std::to_string(errno));
+    }
+
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      _fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        _destroy();
+        throw std::runtime_error("Failed to map io_uring entries. errno: " + std::to_string(errno));
+    }
+    _sqes = static_cast<io_uring_sqe*>(sqes);
+
+    unsigned char* ring = static_cast<unsigned char*>(_ring);
+    _sqHead             = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+    _sqTail             = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+    _sqArray            = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+    _sqMask             = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+    _sqEntries          = params.sq_entries;
+
+    _cqHead = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+    _cqTail = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+    _cqMask = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+    _cqes   = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+}
+
+IoUring::~IoUring()
+{
+    _destroy();
+}
+
+void IoUring::_destroy()
+{
+    // Fermer l'instance annule toutes les requetes en cours
+    if (_bufferRing)
+        munmap(_bufferRing, _bufferRingSize);
+    if (_sqes)
+        munmap(_sqes, _sqesSize);
+    if (_ring)
+        munmap(_ring, _ringSize);
+    if (_fd >= 0)
+        close(_fd);
+
+    _bufferRing = nullptr;
+    _sqes       = nullptr;
+    _ring       = nullptr;
+    _fd         = -1;
+}
+
+/**
+ * @brief Whether io_uring is compiled in and usable on the running kernel.
+ */
+bool IoUring::available()
+{
+    static const bool supported = []()
+    {
+        try
+        {
+            IoUring probe(4);
+            probe.provideBuffers(1, 64);
+            return true;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }();
+    return supported;
+}
+
+/**
+ * @brief Register `count` buffers of `size` bytes that recv requests fill directly.
+ * @param count Number of buffers, must be a power of two (at most 32768).
+ */
+void IoUring::provideBuffers(unsigned count, unsigned size)
+{
+    if (count == 0 || (count & (count - 1)) != 0 || count > 32768)
+        throw std::invalid_argument("Provided buffer count must be a power of two");
+    if (_bufferRing)
+        throw std::logic_error("Buffers are already provided");
+
+    _bufferRingSize = count * sizeof(io_uring_buf);
+    void* bufferRing =
+        mmap(nullptr, _bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bufferRing == MAP_FAILED)
+        throw std::runtime_error("Failed to map provided buffers. errno: " + std::to_string(errno));
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr    = reinterpret_cast<uint64_t>(bufferRing);
+    reg.ring_entries = count;
+    reg.bgid         = 0;
+    if (ioUringRegister(_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        munmap(bufferRing, _bufferRingSize);
+        throw std::runtime_error("Failed to register provided buffers. errno: " +
+                                 std::to_string(errno));
+    }
+
+    _bufferRing  = bufferRing;
+    _bufferCount = count;
+    _bufferSize  = size;
+    _buffers.reset(new unsigned char[static_cast<size_t>(count) * size]);
+    for (unsigned id = 0; id < count; id++)
+        recycle(static_cast<uint16_t>(id));
+}
+
+const unsigned char* IoUring::buffer(uint16_t id) const
+{
+    return _buffers.get() + static_cast<size_t>(id) * _bufferSize;
+}
+
+/**
+ * @brief Give a provided buffer back to the kernel once its content has been consumed.
+ */
+void IoUring::recycle(uint16_t id)
+{
+    // La queue de l'anneau recouvre le champ resv du premier buffer: on ne touche jamais a resv
+    io_uring_buf* bufs  = static_cast<io_uring_buf*>(_bufferRing);
+    io_uring_buf& entry = bufs[_bufferTail & (_bufferCount - 1)];
+    entry.addr          = reinterpret_cast<uint64_t>(_buffers.get()) +
+                 static_cast<uint64_t>(id) * _bufferSize;
+    entry.len = _bufferSize;
+    entry.bid = id;
+
+    _bufferTail++;
+    uint16_t* tail = reinterpret_cast<uint16_t*>(static_cast<unsigned char*>(_bufferRing) +
+                                                 offsetof(io_uring_buf, resv));
+    __atomic_store_n(tail, _bufferTail, __ATOMIC_RELEASE);
+}
+
+void IoUring::_push(const io_uring_sqe& entry)
+{
+    unsigned tail = *_sqTail;
+    if (tail - loadAcquire(_sqHead) >= _sqEntries)
+    {
+        // File pleine: on soumet ce qui attend sans attendre de completion
+        if (ioUringEnter(_fd, _pending, 0, 0, nullptr, 0) >= 0)
+            _pending = 0;
+        if (tail - loadAcquire(_sqHead) >= _sqEntries)
+            throw std::runtime_error("io_uring submission queue is full");
+    }
+
+    unsigned index = tail & _sqMask;
+    _sqes[index]   = entry;
+    _sqArray[index] = index;
+    storeRelease(_sqTail, tail + 1);
+    _pending++;
+}
+
+void IoUring::acceptMultishot(int fd, uint64_t userData)
+{
+    io_uring_sqe entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.opcode       = IORING_OP_ACCEPT;
+    entry.fd           = fd;
+    entry.ioprio       = IORING_ACCEPT_MULTISHOT;
+    entry.accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    entry.user_data    = userData;
+    _push(entry);
+}
+
+void IoUring::recvMultishot(int fd, uint64_t userData)
+{
+    io_uring_sqe entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.opcode    = IORING_OP_RECV;
+    entry.fd        = fd;
+    entry.ioprio    = IORING_RECV_MULTISHOT;
+    entry.flags     = IOSQE_BUFFER_SELECT;
+    entry.buf_group = 0;
+    entry.user_data = userData;
+    _push(entry);
+}
+
+void IoUring::pollMultishot(int fd, uint64_t userData)
+{
+    io_uring_sqe entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.opcode        = IORING_OP_POLL_ADD;
+    entry.fd            = fd;
+    entry.len           = IORING_POLL_ADD_MULTI;
+    entry.poll32_events = POLLIN;
+    entry.user_data     = userData;
+    _push(entry);
+}
+
+void IoUring::pollOut(int fd, uint64_t userData)
+{
+    io_uring_sqe entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.opcode        = IORING_OP_POLL_ADD;
+    entry.fd            = fd;
+    entry.poll32_events = POLLOUT;
+    entry.user_data     = userData;
+    _push(entry);
+}
+
+/**
+ * @brief Cancel the pending request submitted with target as user data.
+ * @details The cancelled request completes with -ECANCELED; the cancellation itself completes
+ * under userData (-ENOENT if the request had already ended).
+ */
+void IoUring::cancel(uint64_t target, uint64_t userData)
+{
+    io_uring_sqe entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.opcode    = IORING_OP_ASYNC_CANCEL;
+    entry.fd        = -1;
+    entry.addr      = target;
+    entry.user_data = userData;
+    _push(entry);
+}
+
+/**
+ * @brief Submit the prepared requests and wait up to timeoutMs for at least one completion.
+ * @return The number of submitted requests, or -errno (-ETIME when nothing completed in time).
+ */
+int IoUring::wait(int timeoutMs)
+{
+    __kernel_timespec timeout;
+    timeout.tv_sec  = timeoutMs / 1000;
+    timeout.tv_nsec = (timeoutMs % 1000) * 1000000LL;
+
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = reinterpret_cast<uint64_t>(&timeout);
+
+    int submitted = ioUringEnter(_fd, _pending, 1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                                 &arg, sizeof(arg));
+    if (submitted < 0)
+        return -errno;
+
+    _pending -= static_cast<unsigned>(submitted) < _pending ? submitted : _pending;
+    return submitted;
+}
+
+/**
+ * @brief Pop the next completion, if any (no system call).
+ */
+bool IoUring::next(Completion& completion)
+{
+    unsigned head = *_cqHead;
+    if (head == loadAcquire(_cqTail))
+        return false;
+
+    const io_uring_cqe& cqe = _cqes[head & _cqMask];
+    completion.userData     = cqe.user_data;
+    completion.result       = cqe.res;
+    completion.flags        = cqe.flags;
+
+    storeRelease(_cqHead, head + 1);
+    return true;
+}
+
+bool IoUring::Completion::more() const
+{
+    return flags & IORING_CQE_F_MORE;
+}
+
+bool IoUring::Completion::hasBuffer() const
+{
+    return flags & IORING_CQE_F_BUFFER;
+}
+
+uint16_t IoUring::Completion::bufferId() const
+{
+    return static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+}
+
+#else
+
+// Sans <linux/io_uring.h> la classe existe mais ne peut pas etre instanciee
+IoUring::IoUring(unsigned)
+{
+    throw std::runtime_error("io_uring is not available on this platform");
+}
+
+IoUring::~IoUring() {}
+
+void IoUring::_destroy() {}
+
+bool IoUring::available()
+{
+    return false;
+}
+
+void IoUring::provideBuffers(unsigned, unsigned) {}
+
+const unsigned char* IoUring::buffer(uint16_t) const
+{
+    return nullptr;
+}
+
+void IoUring::recycle(uint16_t) {}
+void IoUring::_push(const io_uring_sqe&) {}
+void IoUring::acceptMultishot(int, uint64_t) {}
+void IoUring::recvMultishot(int, uint64_t) {}
+void IoUring::pollMultishot(int, uint64_t) {}
+void IoUring::pollOut(int, uint64_t) {}
+void IoUring::cancel(uint64_t, uint64_t) {}
+
+int IoUring::wait(int)
+{
+    return -1;
+}
+
+bool IoUring::next(Completion&)
+{
+    return false;
+}
+
+bool IoUring::Completion::more() const
+{
+    return false;
+}
+
+bool IoUring::Completion::hasBuffer() const
+{
+    return false;
+}
+
+uint16_t IoUring::Completion::bufferId() const
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef IO_URING_HPP
+#define IO_URING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define LIBFTPP_HAS_IO_URING 1
+#else
+#define LIBFTPP_HAS_IO_URING 0
+#endif
+
+#define IO_URING_ENTRIES      256  // Taille de la file de soumission (la file de completion x4)
+#define IO_URING_BUFFER_COUNT 256  // Buffers fournis au noyau pour les recv (puissance de 2)
+#define IO_URING_BUFFER_SIZE  4096 // Taille de chacun de ces buffers
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * @brief Minimal io_uring instance driven through the raw system calls (no liburing).
+ *
+ * Requests are prepared in the submission ring and only handed to the kernel by wait(), which
+ * submits everything pending and waits for completions in the same io_uring_enter() call.
+ * Completions are then consumed with next() without any further system call.
+ *
+ * The operations used by the network backends are multishot: one accept or recv request keeps
+ * producing completions (Completion::more()) until it is cancelled or fails, so a busy
+ * connection costs no system call per message. Received data lands in a ring of provided
+ * buffers registered once with the kernel; each buffer must be given back with recycle().
+ *
+ * @code
+ * IoUring ring;
+ * ring.provideBuffers(IO_URING_BUFFER_COUNT, IO_URING_BUFFER_SIZE);
+ * ring.recvMultishot(fd, 42);
+ *
+ * ring.wait(10);
+ * IoUring::Completion completion;
+ * while (ring.next(completion))
+ * {
+ *     if (completion.hasBuffer())
+ *     {
+ *         consume(ring.buffer(completion.bufferId()), completion.result);
+ *         ring.recycle(completion.bufferId());
+ *     }
+ *     if (!completion.more())
+ *         ring.recvMultishot(fd, 42); // re-arm (out of buffers, error...)
+ * }
+ * @endcode
+ *
+ * @note Requires Linux 6.0 (multishot recv, provided buffer rings, timed waits).
+ *       available() tells whether the library was built with io_uring and the kernel accepts it.
+ * @note Not thread-safe: one thread prepares, waits and consumes completions.
+ *
+ * @throws std::runtime_error if the ring cannot be created or io_uring is not compiled in
+ */
+class IoUring
+{
+public:
+    struct Completion
+    {
+        uint64_t userData;
+        int32_t  result;
+        uint32_t flags;
+
+        bool     more() const;
+        bool     hasBuffer() const;
+        uint16_t bufferId() const;
+    };
+
+private:
+    int _fd = -1;
+
+    void*         _ring     = nullptr;
+    size_t        _ringSize = 0;
+    io_uring_sqe* _sqes     = nullptr;
+    size_t        _sqesSize = 0;
+
+    unsigned* _sqHead    = nullptr;
+    unsigned* _sqTail    = nullptr;
+    unsigned* _sqArray   = nullptr;
+    unsigned  _sqMask    = 0;
+    unsigned  _sqEntries = 0;
+    unsigned  _pending   = 0;
+
+    unsigned*     _cqHead = nullptr;
+    unsigned*     _cqTail = nullptr;
+    unsigned      _cqMask = 0;
+    io_uring_cqe* _cqes   = nullptr;
+
+    void*                            _bufferRing     = nullptr;
+    size_t                           _bufferRingSize = 0;
+    std::unique_ptr<unsigned char[]> _buffers;
+    unsigned                         _bufferCount = 0;
+    unsigned                         _bufferSize  = 0;
+    uint16_t                         _bufferTail  = 0;
+
+    void _push(const io_uring_sqe& entry);
+    void _destroy();
+
+public:
+    explicit IoUring(unsigned entries = IO_URING_ENTRIES);
+    ~IoUring();
+
+    IoUring(const IoUring&)            = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    static bool available();
+
+    void                 provideBuffers(unsigned count, unsigned size);
+    const unsigned char* buffer(uint16_t id) const;
+    void                 recycle(uint16_t id);
+
+    void acceptMultishot(int fd, uint64_t userData);
+    void recvMultishot(int fd, uint64_t userData);
+    void pollMultishot(int fd, uint64_t userData);
+    void pollOut(int fd, uint64_t userData);
+    void cancel(uint64_t target, uint64_t userData);
+
+    int  wait(int timeoutMs);
+    bool next(Completion& completion);
+};
+
+#endif
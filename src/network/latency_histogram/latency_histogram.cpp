@@ -0,0 +1,103 @@
+#include "latency_histogram.hpp"
+
+#define SUB_BUCKETS (static_cast<uint64_t>(1) << LATENCY_HISTOGRAM_SUB_BITS)
+
+/**
+ * @brief Index of the bucket holding a value: exponent, then the next 4 bits of the value.
+ */
+size_t LatencyHistogram::bucketOf(uint64_t nanoseconds)
+{
+    if (nanoseconds < SUB_BUCKETS)
+        return static_cast<size_t>(nanoseconds);
+
+    size_t   exponent = 63 - __builtin_clzll(nanoseconds);
+    size_t   shift    = exponent - LATENCY_HISTOGRAM_SUB_BITS;
+    uint64_t mantissa = (nanoseconds >> shift) - SUB_BUCKETS;
+    return ((shift + 1) << LATENCY_HISTOGRAM_SUB_BITS) + static_cast<size_t>(mantissa);
+}
+
+/**
+ * @brief Largest value that falls in bucket: what a percentile ending there reports.
+ */
+uint64_t LatencyHistogram::highestValueOf(size_t bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+
+    size_t   shift    = (bucket >> LATENCY_HISTOGRAM_SUB_BITS) - 1;
+    uint64_t mantissa = bucket & (SUB_BUCKETS - 1);
+    return ((SUB_BUCKETS + mantissa) << shift) + ((static_cast<uint64_t>(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds)
+{
+    _buckets[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while (nanoseconds > max &&
+           !_max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+        ;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+    record(duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0);
+}
+
+/**
+ * @brief Copy of the counters, readable at leisure (thread-safe, does not block record()).
+ */
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.buckets.resize(_buckets.size());
+    for (size_t i = 0; i < _buckets.size(); i++)
+        snapshot.buckets[i] = _buckets[i].load(std::memory_order_relaxed);
+    snapshot.count = _count.load(std::memory_order_relaxed);
+    snapshot.sum   = _sum.load(std::memory_order_relaxed);
+    snapshot.max   = _max.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto& bucket : _buckets)
+        bucket.store(0, std::memory_order_relaxed);
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Value under which percent % of the recorded values fall (0 if nothing was recorded).
+ * @details Reported as the top of its bucket, capped by the largest value recorded.
+ */
+uint64_t LatencyHistogram::Snapshot::percentile(double percent) const
+{
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets)
+        total += bucket;
+    if (total == 0)
+        return 0;
+
+    // Rang de la valeur cherchee, au moins la premiere
+    uint64_t rank = static_cast<uint64_t>(percent / 100.0 * static_cast<double>(total) + 0.5);
+    if (rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return highestValueOf(i) < max ? highestValueOf(i) : max;
+    }
+    return max;
+}
+
+double LatencyHistogram::Snapshot::mean() const
+{
+    return count == 0 ? 0 : static_cast<double>(sum) / static_cast<double>(count);
+}
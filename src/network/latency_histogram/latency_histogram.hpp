@@ -0,0 +1,72 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#define LATENCY_HISTOGRAM_SUB_BITS 4 // 16 sous-intervalles par puissance de 2: ~6% de precision
+#define LATENCY_HISTOGRAM_BUCKETS  ((65 - LATENCY_HISTOGRAM_SUB_BITS) << LATENCY_HISTOGRAM_SUB_BITS)
+
+/**
+ * @brief Lock-free log-linear histogram of durations (HDR style), in nanoseconds.
+ *
+ * Values below 16 ns have a bucket each; above, every power of two is split into 16 buckets of
+ * equal width, so a percentile is known within about 6% of its value over the whole range (a
+ * nanosecond to centuries) with a fixed table of LATENCY_HISTOGRAM_BUCKETS counters.
+ *
+ * record() is a relaxed atomic increment: any number of threads may record while others call
+ * snapshot(), which copies the counters without stopping the writers (a snapshot taken during
+ * a record may miss that one value).
+ *
+ * @code
+ * LatencyHistogram handlerTime;
+ *
+ * auto start = std::chrono::steady_clock::now();
+ * handle(msg);
+ * handlerTime.record(std::chrono::steady_clock::now() - start);
+ *
+ * LatencyHistogram::Snapshot snapshot = handlerTime.snapshot();
+ * std::cout << "p99: " << snapshot.percentile(99) << " ns" << std::endl;
+ * @endcode
+ */
+class LatencyHistogram
+{
+public:
+    struct Snapshot
+    {
+        std::vector<uint64_t> buckets;
+        uint64_t              count = 0;
+        uint64_t              sum   = 0; // Nanosecondes
+        uint64_t              max   = 0;
+
+        uint64_t percentile(double percent) const;
+        double   mean() const;
+    };
+
+private:
+    std::array<std::atomic<uint64_t>, LATENCY_HISTOGRAM_BUCKETS> _buckets{};
+    std::atomic<uint64_t>                                        _count{0};
+    std::atomic<uint64_t>                                        _sum{0};
+    std::atomic<uint64_t>                                        _max{0};
+
+public:
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram&)            = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void     record(uint64_t nanoseconds);
+    void     record(std::chrono::nanoseconds duration);
+    Snapshot snapshot() const;
+    void     reset();
+
+    static size_t   bucketOf(uint64_t nanoseconds);
+    static uint64_t highestValueOf(size_t bucket);
+};
+
+#endif
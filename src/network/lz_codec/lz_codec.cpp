@@ -0,0 +1,191 @@
+#include "lz_codec.hpp"
+
+static uint32_t read32(const unsigned char* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Hash multiplicatif de Knuth: les LZ_HASH_LOG bits de poids fort
+static uint32_t hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - LZ_HASH_LOG);
+}
+
+// Longueur >= 15: le nibble vaut 15, le reste suit par tranches de 255
+static unsigned char* writeLength(unsigned char* op, size_t length)
+{
+    length -= 15;
+    while (length >= 255)
+    {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<unsigned char>(length);
+    return op;
+}
+
+static unsigned char* writeSequence(unsigned char* op, const unsigned char* literals,
+                                    size_t literalCount, size_t offset, size_t matchLength)
+{
+    unsigned char* token = op++;
+    *token = static_cast<unsigned char>((literalCount < 15 ? literalCount : 15) << 4);
+    if (literalCount >= 15)
+        op = writeLength(op, literalCount);
+    memcpy(op, literals, literalCount);
+    op += literalCount;
+
+    // Derniere sequence: des literals seulement
+    if (offset == 0)
+        return op;
+
+    *op++ = static_cast<unsigned char>(offset);
+    *op++ = static_cast<unsigned char>(offset >> 8);
+    matchLength -= LZ_MIN_MATCH;
+    *token |= static_cast<unsigned char>(matchLength < 15 ? matchLength : 15);
+    if (matchLength >= 15)
+        op = writeLength(op, matchLength);
+    return op;
+}
+
+/**
+ * @brief Worst case compressed size of size bytes (incompressible data).
+ */
+size_t LzCodec::bound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+/**
+ * @brief Compress size bytes of src into dst.
+ * @return Compressed size
+ * @throws std::invalid_argument if capacity is smaller than bound(size)
+ */
+size_t LzCodec::compress(const unsigned char* src, size_t size, unsigned char* dst,
+                         size_t capacity)
+{
+    if (capacity < bound(size))
+        throw std::invalid_argument("LzCodec::compress(): output buffer smaller than bound()");
+
+    const unsigned char* ip     = src;
+    const unsigned char* anchor = src; // Debut des literals pas encore ecrits
+    const unsigned char* end    = src + size;
+    unsigned char*       op     = dst;
+
+    if (size > LZ_MF_LIMIT)
+    {
+        // Position + 1 de la derniere occurrence de chaque hash (0: aucune)
+        uint32_t table[1 << LZ_HASH_LOG] = {};
+        const unsigned char* matchLimit = end - LZ_LAST_LITERALS;
+        const unsigned char* mfLimit    = end - LZ_MF_LIMIT;
+
+        while (ip < mfLimit)
+        {
+            uint32_t  sequence  = read32(ip);
+            uint32_t& slot      = table[hash(sequence)];
+            size_t    candidate = slot;
+            slot                = static_cast<uint32_t>(ip - src + 1);
+
+            const unsigned char* ref = candidate == 0 ? src : src + candidate - 1;
+            if (candidate == 0 || ip - ref > LZ_MAX_OFFSET || read32(ref) != sequence)
+            {
+                // Donnees incompressibles: on accelere au fil des echecs
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            // La repetition s'etend aussi vers l'arriere, sur les literals en attente
+            while (ip > anchor && ref > src && ip[-1] == ref[-1])
+            {
+                ip--;
+                ref--;
+            }
+            const unsigned char* matchEnd = ip + LZ_MIN_MATCH;
+            ref += LZ_MIN_MATCH;
+            while (matchEnd < matchLimit && *matchEnd == *ref)
+            {
+                matchEnd++;
+                ref++;
+            }
+
+            op = writeSequence(op, anchor, ip - anchor, matchEnd - ref, matchEnd - ip);
+            ip = anchor = matchEnd;
+        }
+    }
+
+    op = writeSequence(op, anchor, end - anchor, 0, 0);
+    return op - dst;
+}
+
+// Octets d'extension d'une longueur dont le nibble vaut 15
+static size_t readLength(const unsigned char*& ip, const unsigned char* end)
+{
+    size_t        length = 0;
+    unsigned char byte;
+    do
+    {
+        if (ip >= end)
+            throw std::runtime_error("LzCodec::decompress(): truncated block");
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return length;
+}
+
+/**
+ * @brief Decompress a block into exactly originalSize bytes.
+ * @throws std::runtime_error if the block is malformed, truncated, or does not decode to
+ *         originalSize bytes
+ */
+void LzCodec::decompress(const unsigned char* src, size_t size, unsigned char* dst,
+                         size_t originalSize)
+{
+    const unsigned char* ip   = src;
+    const unsigned char* iend = src + size;
+    unsigned char*       op   = dst;
+    unsigned char*       oend = dst + originalSize;
+
+    while (ip < iend)
+    {
+        unsigned char token    = *ip++;
+        size_t        literals = token >> 4;
+        if (literals == 15)
+            literals += readLength(ip, iend);
+        if (literals > static_cast<size_t>(iend - ip) ||
+            literals > static_cast<size_t>(oend - op))
+            throw std::runtime_error("LzCodec::decompress(): literals out of bounds");
+        memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            throw std::runtime_error("LzCodec::decompress(): truncated block");
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<size_t>(op - dst))
+            throw std::runtime_error("LzCodec::decompress(): offset out of bounds");
+
+        size_t length = token & 15;
+        if (length == 15)
+            length += readLength(ip, iend);
+        length += LZ_MIN_MATCH;
+        if (length > static_cast<size_t>(oend - op))
+            throw std::runtime_error("LzCodec::decompress(): match out of bounds");
+
+        // Repetition qui chevauche sa propre sortie (ex: "aaaa" offset 1): octet par octet
+        const unsigned char* match = op - offset;
+        if (offset >= length)
+            memcpy(op, match, length);
+        else
+            for (size_t i = 0; i < length; i++)
+                op[i] = match[i];
+        op += length;
+    }
+
+    if (op != oend)
+        throw std::runtime_error("LzCodec::decompress(): size mismatch");
+}
@@ -0,0 +1,51 @@
+#ifndef LZ_CODEC_HPP
+#define LZ_CODEC_HPP
+
+#include <stddef.h>
+#include <string.h>
+
+#include <cstdint>
+#include <stdexcept>
+
+#define LZ_MIN_MATCH     4     // Plus courte repetition encodee
+#define LZ_HASH_LOG      12    // Table de 4096 positions (16 KB sur la pile)
+#define LZ_MAX_OFFSET    65535 // Distance max d'une repetition (offset sur 2 octets)
+#define LZ_LAST_LITERALS 5     // Les derniers octets sont toujours des literals
+#define LZ_MF_LIMIT      12    // Pas de repetition qui commence dans les 12 derniers octets
+
+/**
+ * @brief Fast LZ77 block codec, byte compatible with the LZ4 block format.
+ *
+ * A block is a list of sequences: a token byte (literal count in the high nibble, match length
+ * minus LZ_MIN_MATCH in the low nibble, 15 meaning that 255-terminated extra bytes follow), the
+ * literals, then the 16-bit little-endian offset of the match. The last sequence only holds
+ * literals.
+ *
+ * The compressor is a single greedy pass with a 4096 entry hash table of 4-byte sequences:
+ * no entropy coding, so it runs at several hundreds of MB/s and decompression is mostly
+ * memcpy(). It is meant for redundant data (serialized structures, repeated fields, text),
+ * not for maximal ratios. Incompressible input grows by at most bound(size) - size bytes.
+ *
+ * @code
+ * std::vector<unsigned char> packed(LzCodec::bound(data.size()));
+ * packed.resize(LzCodec::compress(data.data(), data.size(), packed.data(), packed.size()));
+ *
+ * std::vector<unsigned char> restored(data.size()); // the original size travels separately
+ * LzCodec::decompress(packed.data(), packed.size(), restored.data(), restored.size());
+ * @endcode
+ *
+ * @note The original size is not stored in the block: the caller transmits it
+ * @throws std::invalid_argument if the compression buffer is smaller than bound()
+ * @throws std::runtime_error from decompress() on a malformed or truncated block
+ */
+class LzCodec
+{
+public:
+    static size_t bound(size_t size);
+    static size_t compress(const unsigned char* src, size_t size, unsigned char* dst,
+                           size_t capacity);
+    static void   decompress(const unsigned char* src, size_t size, unsigned char* dst,
+                             size_t originalSize);
+};
+
+#endif
@@ -1,5 +1,9 @@
 #include "message.hpp"
 
+std::mutex                                           Message::_compressionMutex;
+std::atomic<const Message::TypeSet*>                 Message::_compressedTypes{nullptr};
+std::vector<std::unique_ptr<const Message::TypeSet>> Message::_compressionSets;
+
 Message::Message(Message::Type type) : _type(type) {}
 
 void Message::appendBytes(const unsigned char* data, size_t len)
@@ -23,28 +27,291 @@ bool Message::isComplet()
     return (_buffer.size() >= sizeof(Message::Type) + sizeof(size_t) + messageSize);
 }
 
-std::vector<unsigned char> Message::getSerializedData() const
+std::vector<unsigned char> Message::getSerializedData(WireFormat format) const
 {
-    std::vector<unsigned char> result;
-    size_t                     totalSize = sizeof(Message::Type) + sizeof(size_t) + _buffer.size();
-    result.reserve(totalSize);
+    Header                     wire = {};
+    std::vector<unsigned char> packed;
+    const unsigned char*       data = packPayload(wire, packed);
 
-    result.insert(result.end(),
-                  reinterpret_cast<const unsigned char*>(&_type),
-                  reinterpret_cast<const unsigned char*>(&_type) + sizeof(Message::Type));
+    unsigned char header[MESSAGE_HEADER_MAX_SIZE];
+    size_t        headerSize = encodeHeader(wire, format, header);
 
-    size_t bufferSize = _buffer.size();
-    result.insert(result.end(),
-                  reinterpret_cast<const unsigned char*>(&bufferSize),
-                  reinterpret_cast<const unsigned char*>(&bufferSize) + sizeof(size_t));
+    std::vector<unsigned char> result(headerSize + wire.size);
+    memcpy(result.data(), header, headerSize);
 
-    // Mettre les données
-    auto bufData = _buffer.data(); // récupérer une seule fois le vector tempora
-    result.insert(result.end(), bufData.begin(), bufData.end());
+    // Une seule copie du payload, directement depuis le DataBuffer (ou le bloc compresse)
+    if (wire.size > 0)
+        memcpy(result.data() + headerSize, data, wire.size);
 
     return result;
 }
 
+/**
+ * @brief Write the wire header ([type][payload size]) that precedes payload() on the socket.
+ */
+void Message::serializeHeader(unsigned char (&header)[MESSAGE_HEADER_SIZE]) const
+{
+    size_t payloadSize = _buffer.size();
+
+    memcpy(header, &_type, sizeof(Message::Type));
+    memcpy(header + sizeof(Message::Type), &payloadSize, sizeof(size_t));
+}
+
+/**
+ * @brief Write the wire header of the given format, for payload() as is (never compressed).
+ * @return Number of header bytes written
+ */
+size_t Message::serializeHeader(unsigned char (&header)[MESSAGE_HEADER_MAX_SIZE],
+                                WireFormat format, uint64_t correlationId, uint64_t channel) const
+{
+    return encodeHeader({_type, _buffer.size(), correlationId, channel, 0}, format, header);
+}
+
+/**
+ * @brief Payload as it goes on the wire: compressed into packed if the type asks for it and the
+ * block is smaller, payload() otherwise.
+ * @details Sets the type, size and originalSize of header; its correlation id and channel are
+ *          left untouched. The result is valid as long as packed and the message are.
+ * @return Bytes to send after the header, header.size of them
+ */
+const unsigned char* Message::packPayload(Header&                     header,
+                                          std::vector<unsigned char>& packed) const
+{
+    header.type         = _type;
+    header.size         = _buffer.size();
+    header.originalSize = 0;
+    if (header.size < MESSAGE_COMPRESSION_MIN_SIZE || !compression(_type))
+        return _buffer.rawData();
+
+    packed.resize(LzCodec::bound(header.size));
+    size_t packedSize =
+        LzCodec::compress(_buffer.rawData(), header.size, packed.data(), packed.size());
+    // Incompressible: le payload part tel quel, sans extension
+    if (packedSize >= header.size)
+        return _buffer.rawData();
+
+    packed.resize(packedSize);
+    header.originalSize = header.size;
+    header.size         = packedSize;
+    return packed.data();
+}
+
+/**
+ * @brief Compress the payloads of this type when they are sent (see packPayload()).
+ * @note Process-wide and thread-safe. Receivers need no setting: they decompress any frame.
+ *       Meant to be set up front: each change keeps a copy of the registered types for good, so
+ *       that compression() never takes a lock
+ */
+void Message::setCompression(Type type, bool enabled)
+{
+    std::lock_guard<std::mutex> lock(_compressionMutex);
+    if (compression(type) == enabled)
+        return;
+
+    const TypeSet* current = _compressedTypes.load(std::memory_order_relaxed);
+    auto           next    = current ? std::make_unique<TypeSet>(*current)
+                                     : std::make_unique<TypeSet>();
+    if (enabled)
+        next->insert(type);
+    else
+        next->erase(type);
+
+    _compressedTypes.store(next.get(), std::memory_order_release);
+    _compressionSets.push_back(std::move(next));
+}
+
+bool Message::compression(Type type)
+{
+    const TypeSet* types = _compressedTypes.load(std::memory_order_acquire);
+    return types && types->count(type) > 0;
+}
+
+static size_t writeVarint(uint64_t value, unsigned char* out)
+{
+    size_t len = 0;
+    while (value >= 0x80)
+    {
+        out[len++] = static_cast<unsigned char>(value | 0x80);
+        value >>= 7;
+    }
+    out[len++] = static_cast<unsigned char>(value);
+    return len;
+}
+
+// Retourne le nombre d'octets lus, 0 si le varint est incomplet
+static size_t readVarint(const unsigned char* data, size_t len, size_t maxLen, uint64_t& value)
+{
+    value = 0;
+    for (size_t i = 0; i < len && i < maxLen; i++)
+    {
+        value |= static_cast<uint64_t>(data[i] & 0x7F) << (7 * i);
+        if (!(data[i] & 0x80))
+            return i + 1;
+    }
+    if (len >= maxLen)
+        throw std::runtime_error("Malformed message header: varint too long");
+    return 0;
+}
+
+static size_t writeLegacyHeader(Message::Type type, size_t size, unsigned char* out)
+{
+    memcpy(out, &type, sizeof(Message::Type));
+    memcpy(out + sizeof(Message::Type), &size, sizeof(size_t));
+    return MESSAGE_HEADER_SIZE;
+}
+
+// Frame de controle qui annonce une valeur pour la frame suivante (format LEGACY)
+static size_t writeLegacyPrefix(Message::Type type, uint64_t value, unsigned char* out)
+{
+    size_t len = writeLegacyHeader(type, sizeof(uint64_t), out);
+    memcpy(out + len, &value, sizeof(uint64_t));
+    return len + sizeof(uint64_t);
+}
+
+/**
+ * @brief Encode a header without a Message (type and payload size are enough).
+ * @return Number of header bytes written
+ */
+size_t Message::encodeHeader(const Header& header, WireFormat format,
+                             unsigned char (&out)[MESSAGE_HEADER_MAX_SIZE])
+{
+    size_t len = 0;
+    if (format == WireFormat::LEGACY)
+    {
+        if (header.correlationId != 0)
+            len += writeLegacyPrefix(MESSAGE_TYPE_CORRELATION, header.correlationId, out + len);
+        if (header.channel != 0)
+            len += writeLegacyPrefix(MESSAGE_TYPE_CHANNEL, header.channel, out + len);
+        if (header.originalSize != 0)
+            len += writeLegacyPrefix(MESSAGE_TYPE_COMPRESSED, header.originalSize, out + len);
+        return len + writeLegacyHeader(header.type, header.size, out + len);
+    }
+
+    // Zigzag: les petits types negatifs restent sur un octet. Les 2 bits de poids faible sont
+    // les flags
+    uint32_t type   = static_cast<uint32_t>(header.type);
+    uint32_t zigzag = (type << 1) ^ static_cast<uint32_t>(header.type >> 31);
+    uint64_t tag    = static_cast<uint64_t>(zigzag) << 2;
+    uint64_t ext    = 0;
+    if (header.channel != 0)
+        ext |= MESSAGE_EXT_CHANNEL;
+    if (header.originalSize != 0)
+        ext |= MESSAGE_EXT_COMPRESSED;
+    if (header.correlationId != 0)
+        tag |= MESSAGE_FLAG_CORRELATION;
+    if (ext != 0)
+        tag |= MESSAGE_FLAG_EXTENSIONS;
+
+    len += writeVarint(tag, out + len);
+    len += writeVarint(header.size, out + len);
+    if (header.correlationId != 0)
+        len += writeVarint(header.correlationId, out + len);
+    if (ext != 0)
+        len += writeVarint(ext, out + len);
+    if (ext & MESSAGE_EXT_CHANNEL)
+        len += writeVarint(header.channel, out + len);
+    if (ext & MESSAGE_EXT_COMPRESSED)
+        len += writeVarint(header.originalSize, out + len);
+    return len;
+}
+
+/**
+ * @brief Decode the header at the beginning of data.
+ * @details In LEGACY format the correlation id, the channel and the original size are not part
+ *          of the header: they come as frames of type MESSAGE_TYPE_CORRELATION,
+ *          MESSAGE_TYPE_CHANNEL and MESSAGE_TYPE_COMPRESSED (see FrameBuffer::extract())
+ * @return Header size, or 0 if more bytes are needed
+ * @throws std::runtime_error if the header is malformed
+ */
+size_t Message::decodeHeader(const unsigned char* data, size_t len, WireFormat format,
+                             Header& header)
+{
+    header.correlationId = 0;
+    header.channel       = 0;
+    header.originalSize  = 0;
+    if (format == WireFormat::LEGACY)
+    {
+        if (len < MESSAGE_HEADER_SIZE)
+            return 0;
+        memcpy(&header.type, data, sizeof(Message::Type));
+        memcpy(&header.size, data + sizeof(Message::Type), sizeof(size_t));
+        return MESSAGE_HEADER_SIZE;
+    }
+
+    // Cas courant (petit type, petit payload, pas de flag): un octet chacun
+    if (len >= 2 && data[0] < 0x80 && data[1] < 0x80 && !(data[0] & 0x3))
+    {
+        uint32_t zigzag = data[0] >> 2;
+        header.type     = static_cast<Type>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+        header.size     = data[1];
+        return 2;
+    }
+
+    uint64_t tag;
+    size_t   pos = readVarint(data, len, 5, tag);
+    if (pos == 0)
+        return 0;
+    if ((tag >> 2) > UINT32_MAX)
+        throw std::runtime_error("Malformed message header: type too large");
+
+    uint64_t value;
+    size_t   fieldLen = readVarint(data + pos, len - pos, 10, value);
+    if (fieldLen == 0)
+        return 0;
+    pos += fieldLen;
+
+    if (tag & MESSAGE_FLAG_CORRELATION)
+    {
+        if ((fieldLen = readVarint(data + pos, len - pos, 10, header.correlationId)) == 0)
+            return 0;
+        pos += fieldLen;
+    }
+    if (tag & MESSAGE_FLAG_EXTENSIONS)
+    {
+        uint64_t ext;
+        if ((fieldLen = readVarint(data + pos, len - pos, 10, ext)) == 0)
+            return 0;
+        pos += fieldLen;
+        if (ext & ~static_cast<uint64_t>(MESSAGE_EXT_CHANNEL | MESSAGE_EXT_COMPRESSED))
+            throw std::runtime_error("Malformed message header: unknown extension");
+
+        if (ext & MESSAGE_EXT_CHANNEL)
+        {
+            if ((fieldLen = readVarint(data + pos, len - pos, 10, header.channel)) == 0)
+                return 0;
+            pos += fieldLen;
+        }
+        if (ext & MESSAGE_EXT_COMPRESSED)
+        {
+            uint64_t originalSize;
+            if ((fieldLen = readVarint(data + pos, len - pos, 10, originalSize)) == 0)
+                return 0;
+            pos += fieldLen;
+            if (originalSize == 0)
+                throw std::runtime_error("Malformed message header: empty compressed payload");
+            header.originalSize = static_cast<size_t>(originalSize);
+        }
+    }
+
+    uint32_t zigzag = static_cast<uint32_t>(tag >> 2);
+    header.type     = static_cast<Type>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+    header.size     = static_cast<size_t>(value);
+    return pos;
+}
+
+/**
+ * @brief Unread payload bytes, without copying them. Only valid until the message is modified.
+ */
+const unsigned char* Message::payload() const
+{
+    return _buffer.rawData();
+}
+
+size_t Message::payloadSize() const
+{
+    return _buffer.size();
+}
+
 void Message::reset()
 {
     _buffer.reset();
@@ -4,11 +4,37 @@
 #include <stddef.h>
 #include <string.h>
 
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "../../data_structures/data_buffer/data_buffer.hpp"
+#include "../lz_codec/lz_codec.hpp"
+
+// [type][size] devant chaque message
+#define MESSAGE_HEADER_SIZE (sizeof(int) + sizeof(size_t))
+// Plus long header: legacy avec correlation, canal et compression (3 frames prefixes)
+#define MESSAGE_HEADER_MAX_SIZE (4 * MESSAGE_HEADER_SIZE + 3 * sizeof(uint64_t))
+// Types reserves au protocole, jamais distribues aux handlers
+#define MESSAGE_TYPE_WIRE_FORMAT INT_MIN
+#define MESSAGE_TYPE_CORRELATION (INT_MIN + 1)
+#define MESSAGE_TYPE_CHANNEL     (INT_MIN + 2)
+#define MESSAGE_TYPE_COMPRESSED  (INT_MIN + 3)
+#define MESSAGE_TYPE_PING        (INT_MIN + 4) // Keepalive du serveur, le client repond PONG
+#define MESSAGE_TYPE_PONG        (INT_MIN + 5)
+// Flags du header compact, puis extensions annoncees par MESSAGE_FLAG_EXTENSIONS
+#define MESSAGE_FLAG_CORRELATION 0x1
+#define MESSAGE_FLAG_EXTENSIONS  0x2
+#define MESSAGE_EXT_CHANNEL      0x1
+#define MESSAGE_EXT_COMPRESSED   0x2
+// En dessous, la compression ne gagne presque rien et coute un header plus long
+#define MESSAGE_COMPRESSION_MIN_SIZE 256
 
 /**
  * @brief Class representing a structured message for network communication.
@@ -19,6 +45,26 @@
  *
  * @note Uses a DataBuffer to store message data efficiently
  * @note The transfer format is: [type (int)][size (size_t)][data (variable)]
+ * @note WireFormat::COMPACT replaces this 12 bytes host-endian header by two LEB128 varints:
+ *       (zigzag(type) << 2 | flags) then the payload size: 2 bytes for types from -16 to 15 and
+ *       payloads under 128 bytes. Server and Client switch a connection to it on request (see
+ *       Client::setWireFormat()); payloads are unchanged
+ * @note A frame may carry a correlation id (non-zero) that matches a response to its request
+ *       (see Client::call() and Server::reply()). In COMPACT format it is a third varint,
+ *       announced by the MESSAGE_FLAG_CORRELATION flag. In LEGACY format a frame of type
+ *       MESSAGE_TYPE_CORRELATION holding the id (uint64_t) precedes the message frame.
+ * @note The second flag bit announces a varint bit mask of header extensions, each followed by
+ *       its varint value. MESSAGE_EXT_CHANNEL is the logical channel of a ClientPool (in LEGACY
+ *       format: a MESSAGE_TYPE_CHANNEL frame, like the correlation id). Unknown extensions are
+ *       rejected
+ * @note Compression is opt-in per message type (setCompression()): payloads of at least
+ *       MESSAGE_COMPRESSION_MIN_SIZE bytes are sent as an LzCodec block when that makes them
+ *       smaller. MESSAGE_EXT_COMPRESSED carries the original size (in LEGACY format: a
+ *       MESSAGE_TYPE_COMPRESSED frame). getSerializedData(), Server, Client and OutputQueue
+ *       compress through packPayload(); FrameBuffer decompresses on receive, so handlers always
+ *       see the original payload
+ * @note MESSAGE_TYPE_PING and MESSAGE_TYPE_PONG are the keepalive of Server::setIdleTimeout():
+ *       empty frames, a Client answers each PING with a PONG without calling any handler
  * @note During usage, the buffer contains only the data (without type), and the
  *       Message::Type is stored separately in _type
  * @note Supports stream operators (<<, >>) for easy data insertion and extraction
@@ -33,6 +79,19 @@
  * // Serialize for network transmission
  * auto serialized = msg.getSerializedData();
  *
+ * // Or send header and payload without building a contiguous copy
+ * unsigned char header[MESSAGE_HEADER_MAX_SIZE];
+ * size_t        headerSize = msg.serializeHeader(header, Message::WireFormat::COMPACT);
+ * iovec iov[2] = {{header, headerSize},
+ *                 {const_cast<unsigned char*>(msg.payload()), msg.payloadSize()}};
+ *
+ * // Same, compressed if the type was registered with Message::setCompression()
+ * Message::Header            wire = {};
+ * std::vector<unsigned char> packed;
+ * const unsigned char*       data = msg.packPayload(wire, packed);
+ * headerSize = Message::encodeHeader(wire, Message::WireFormat::COMPACT, header);
+ * iovec packedIov[2] = {{header, headerSize}, {const_cast<unsigned char*>(data), wire.size}};
+ *
  * // Extract data (order matters!)
  * std::string text;
  * int number;
@@ -48,11 +107,33 @@ class Message
 public:
     using Type = int;
 
+    enum class WireFormat : unsigned char
+    {
+        LEGACY  = 0,
+        COMPACT = 1
+    };
+
+    struct Header
+    {
+        Type     type;
+        size_t   size;
+        uint64_t correlationId; // 0: pas de correlation
+        uint64_t channel;       // 0: canal par defaut de la connexion
+        size_t   originalSize;  // 0: payload non compresse, sinon sa taille decompresse
+    };
+
 private:
     int        _fd;
     Type       _type;
     DataBuffer _buffer;
 
+    // Lu sans verrou a chaque envoi: setCompression() publie une copie modifiee de l'ensemble.
+    // Les anciennes copies ne sont jamais liberees, un envoi en cours peut encore les lire
+    using TypeSet = std::unordered_set<Type>;
+    static std::mutex                                  _compressionMutex; // Entre ecrivains
+    static std::atomic<const TypeSet*>                 _compressedTypes;
+    static std::vector<std::unique_ptr<const TypeSet>> _compressionSets;
+
 public:
     Message(Type type);
     Message(int fd, Type type) : _fd(fd), _type(type) {}
@@ -73,7 +154,21 @@ public:
     }
 
     void                       appendBytes(const unsigned char* data, size_t len);
-    std::vector<unsigned char> getSerializedData() const;
+    std::vector<unsigned char> getSerializedData(WireFormat format = WireFormat::LEGACY) const;
+    void   serializeHeader(unsigned char (&header)[MESSAGE_HEADER_SIZE]) const;
+    size_t serializeHeader(unsigned char (&header)[MESSAGE_HEADER_MAX_SIZE], WireFormat format,
+                           uint64_t correlationId = 0, uint64_t channel = 0) const;
+    const unsigned char* payload() const;
+    size_t               payloadSize() const;
+    const unsigned char* packPayload(Header& header, std::vector<unsigned char>& packed) const;
+
+    static void setCompression(Type type, bool enabled = true);
+    static bool compression(Type type);
+
+    static size_t encodeHeader(const Header& header, WireFormat format,
+                               unsigned char (&out)[MESSAGE_HEADER_MAX_SIZE]);
+    static size_t decodeHeader(const unsigned char* data, size_t len, WireFormat format,
+                               Header& header);
 
     void          setType(Message::Type type);
     Message::Type type() const;
@@ -90,4 +185,10 @@ public:
 
     const int& getFd() const;
 };
+
+static_assert(MESSAGE_HEADER_SIZE == sizeof(Message::Type) + sizeof(size_t),
+              "MESSAGE_HEADER_SIZE must match the wire header");
+static_assert(MESSAGE_HEADER_MAX_SIZE >= 5 + 10 + 10 + 1 + 10 + 10, // Plus long header compact
+              "MESSAGE_HEADER_MAX_SIZE must hold a header of any format");
+
 #endif
\ No newline at end of file
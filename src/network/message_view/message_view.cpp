@@ -0,0 +1,70 @@
+#include "message_view.hpp"
+
+MessageView::MessageView(Message::Type type, const unsigned char* data, size_t size, int fd,
+                         uint64_t correlationId)
+    : _fd(fd), _type(type), _data(data), _size(size), _cursor(0), _correlationId(correlationId)
+{
+}
+
+const MessageView& MessageView::operator>>(std::string& value) const
+{
+    size_t size;
+    *this >> size;
+
+    if (size + _cursor > _size)
+        throw std::out_of_range("Buffer overflow on read");
+
+    value.assign(reinterpret_cast<const char*>(_data + _cursor), size);
+    _cursor += size;
+    return *this;
+}
+
+Message::Type MessageView::type() const
+{
+    return _type;
+}
+
+/**
+ * @brief Id of the request this message answers, or that its answer must carry (0: none).
+ * @see Client::call(), Server::reply()
+ */
+uint64_t MessageView::correlationId() const
+{
+    return _correlationId;
+}
+
+const int& MessageView::getFd() const
+{
+    return _fd;
+}
+
+/**
+ * @brief Pointer to the first unread byte of the payload.
+ */
+const unsigned char* MessageView::data() const
+{
+    return _data + _cursor;
+}
+
+/**
+ * @brief Number of unread bytes left in the payload.
+ */
+size_t MessageView::size() const
+{
+    return _size - _cursor;
+}
+
+void MessageView::reset() const
+{
+    _cursor = 0;
+}
+
+/**
+ * @brief Copy the whole payload into an owning Message.
+ */
+MessageView::operator Message() const
+{
+    Message msg(_fd, _type);
+    msg.appendBytes(_data, _size);
+    return msg;
+}
@@ -0,0 +1,82 @@
+#ifndef MESSAGE_VIEW_HPP
+#define MESSAGE_VIEW_HPP
+
+#include <stddef.h>
+#include <string.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "../../data_structures/reflection/reflection.hpp"
+#include "../message/message.hpp"
+
+/**
+ * @brief Read-only, non-owning view over the payload of a received message.
+ *
+ * Server and Client carve MessageViews directly out of their per-connection receive buffer
+ * (see FrameBuffer): no byte is copied between recv() and the handler. A MessageView reads
+ * exactly like a Message (same operator>> and wire representation of std::string).
+ *
+ * @warning The view points into the receive buffer of the connection: it is only valid during
+ *          the handler call. Convert it to a Message to keep the data.
+ *
+ * @code
+ * server.defineAction(1001, [](long long& clientID, const MessageView& msg) {
+ *     int         value;
+ *     std::string text;
+ *     msg >> value >> text;
+ * });
+ *
+ * // Handlers taking a const Message& still work: the view is copied into a Message
+ * server.defineAction(1002, [](long long& clientID, const Message& msg) { ... });
+ * @endcode
+ *
+ * @throws std::out_of_range when reading past the end of the payload
+ * @see FrameBuffer for the buffer the views point into
+ */
+class MessageView
+{
+private:
+    int                  _fd;
+    Message::Type        _type;
+    const unsigned char* _data;
+    size_t               _size;
+    mutable size_t       _cursor;
+    uint64_t             _correlationId;
+
+public:
+    MessageView(Message::Type type, const unsigned char* data, size_t size, int fd = -1,
+                uint64_t correlationId = 0);
+
+    template <typename T>
+    const MessageView& operator>>(T& value) const
+    {
+        Reflection::read(*this, value);
+        return *this;
+    }
+
+    const MessageView& operator>>(std::string& value) const;
+
+    // Inline pour operator>>: la taille d'un champ devient une constante et le memcpy disparait
+    void readBytes(unsigned char* data, size_t len) const
+    {
+        if (len + _cursor > _size)
+            throw std::out_of_range("Buffer overflow on read");
+
+        if (len > 0)
+            memcpy(data, _data + _cursor, len);
+        _cursor += len;
+    }
+
+    Message::Type        type() const;
+    const int&           getFd() const;
+    const unsigned char* data() const;
+    size_t               size() const;
+    uint64_t             correlationId() const;
+
+    void reset() const;
+
+    operator Message() const;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#include "net_stats.hpp"
+
+// Un seul thread ecrit: pas besoin d'un fetch_add et de son prefixe lock
+void NetStats::_add(std::atomic<uint64_t>& counter, uint64_t amount)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void NetStats::read(size_t bytes)
+{
+    _add(_bytesIn, bytes);
+    _add(_reads, 1);
+}
+
+/**
+ * @brief What was read was cut into count frames, partial if an incomplete frame is left.
+ */
+void NetStats::framesReceived(size_t count, bool partial)
+{
+    _add(_framesIn, count);
+    if (partial)
+        _add(_partialReads, 1);
+}
+
+/**
+ * @brief bytes accepted by a socket, blocked if it did not take everything that was pending.
+ */
+void NetStats::wrote(size_t bytes, bool blocked)
+{
+    _add(_bytesOut, bytes);
+    if (blocked)
+        _add(_blockedWrites, 1);
+}
+
+void NetStats::frameSent()
+{
+    _add(_framesOut, 1);
+}
+
+/**
+ * @brief An output queue went from before to after pending bytes.
+ */
+void NetStats::queued(size_t before, size_t after)
+{
+    // Arithmetique modulo 2^64: une baisse s'ajoute comme un nombre negatif
+    _add(_outputQueued, static_cast<uint64_t>(after) - static_cast<uint64_t>(before));
+}
+
+void NetStats::connected()
+{
+    _add(_connections, 1);
+}
+
+void NetStats::disconnected()
+{
+    _add(_connections, static_cast<uint64_t>(-1));
+}
+
+/**
+ * @brief A frame of type with a payload of bytes was handed to the handlers.
+ */
+void NetStats::dispatched(Message::Type type, size_t bytes)
+{
+    size_t start = (static_cast<uint32_t>(type) * 2654435761u) % NET_STATS_TYPES;
+    for (size_t i = 0; i < NET_STATS_TYPES; i++)
+    {
+        TypeSlot& slot = _types[(start + i) % NET_STATS_TYPES];
+        if (slot.state.load(std::memory_order_relaxed) == 0)
+        {
+            slot.type = type;
+            slot.state.store(1, std::memory_order_release);
+        }
+        else if (slot.type != type)
+            continue;
+
+        _add(slot.frames, 1);
+        _add(slot.bytes, bytes);
+        return;
+    }
+    _add(_otherTypes.frames, 1);
+    _add(_otherTypes.bytes, bytes);
+}
+
+// Les histogrammes acceptent plusieurs ecrivains: les handlers d'un WorkerPool mesurent leur duree
+void NetStats::dispatchDelay(Clock::duration delay)
+{
+    _dispatchDelay.record(std::chrono::duration_cast<std::chrono::nanoseconds>(delay));
+}
+
+void NetStats::handlerTime(Clock::duration duration)
+{
+    _handlerTime.record(std::chrono::duration_cast<std::chrono::nanoseconds>(duration));
+}
+
+/**
+ * @brief Feed the latency histograms (off by default: a few clock reads per message).
+ */
+void NetStats::setTiming(bool enabled)
+{
+    _timing.store(enabled, std::memory_order_relaxed);
+}
+
+bool NetStats::timing() const
+{
+    return _timing.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Copy of every counter, thread-safe.
+ */
+NetStats::Snapshot NetStats::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.bytesIn       = _bytesIn.load(std::memory_order_relaxed);
+    snapshot.bytesOut      = _bytesOut.load(std::memory_order_relaxed);
+    snapshot.framesIn      = _framesIn.load(std::memory_order_relaxed);
+    snapshot.framesOut     = _framesOut.load(std::memory_order_relaxed);
+    snapshot.reads         = _reads.load(std::memory_order_relaxed);
+    snapshot.partialReads  = _partialReads.load(std::memory_order_relaxed);
+    snapshot.blockedWrites = _blockedWrites.load(std::memory_order_relaxed);
+    snapshot.outputQueued  = _outputQueued.load(std::memory_order_relaxed);
+    snapshot.connections   = _connections.load(std::memory_order_relaxed);
+
+    for (const TypeSlot& slot : _types)
+    {
+        if (slot.state.load(std::memory_order_acquire) == 0)
+            continue;
+        snapshot.types.push_back({slot.type, slot.frames.load(std::memory_order_relaxed),
+                                  slot.bytes.load(std::memory_order_relaxed)});
+    }
+    snapshot.otherTypes.frames = _otherTypes.frames.load(std::memory_order_relaxed);
+    snapshot.otherTypes.bytes  = _otherTypes.bytes.load(std::memory_order_relaxed);
+
+    snapshot.dispatchDelay = _dispatchDelay.snapshot();
+    snapshot.handlerTime   = _handlerTime.snapshot();
+    return snapshot;
+}
@@ -0,0 +1,128 @@
+#ifndef NET_STATS_HPP
+#define NET_STATS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "../latency_histogram/latency_histogram.hpp"
+#include "../message/message.hpp"
+
+#define NET_STATS_TYPES 64 // Types de message comptes separement, les suivants vont dans otherTypes
+
+/**
+ * @brief Traffic counters and latency histograms of a Server or a Client, readable from any
+ * thread.
+ *
+ * The owner updates the counters from its network thread only: each update is a relaxed load
+ * and store, without any locked instruction. snapshot() may be called from any thread at any
+ * time and copies everything into plain values. Counters are read one by one: a snapshot taken
+ * in the middle of a round may be a few bytes or frames off between two counters, never torn.
+ *
+ * Frames are also counted per message type, in a fixed open-addressing table of
+ * NET_STATS_TYPES types filled on first use (later types share the otherTypes entry).
+ *
+ * The two histograms are only fed when timing is enabled (setTiming()), since it costs a few
+ * clock reads per message: dispatchDelay is the time between the arrival of the bytes of a
+ * message and the call of its handler (queueing behind a budget, a rate limit or other
+ * clients), handlerTime the time spent in handlers. Handlers running on a WorkerPool record
+ * their own duration, the histograms accept writers from any thread.
+ *
+ * @code
+ * Server server("0.0.0.0", 8080, Server::Backend::EPOLL);
+ * server.stats().setTiming(true);
+ *
+ * // From a monitoring thread
+ * NetStats::Snapshot stats = server.stats().snapshot();
+ * std::cout << stats.bytesIn << " bytes in, p99 handler " << stats.handlerTime.percentile(99)
+ *           << " ns" << std::endl;
+ * @endcode
+ */
+class NetStats
+{
+public:
+    struct TypeCount
+    {
+        Message::Type type;
+        uint64_t      frames;
+        uint64_t      bytes; // Payloads
+    };
+
+    struct Snapshot
+    {
+        uint64_t bytesIn       = 0;
+        uint64_t bytesOut      = 0; // Acceptes par les sockets
+        uint64_t framesIn      = 0;
+        uint64_t framesOut     = 0;
+        uint64_t reads         = 0; // recv() ou completions io_uring avec des donnees
+        uint64_t partialReads  = 0; // Tours de reception termines au milieu d'une frame
+        uint64_t blockedWrites = 0; // Envois dont la socket n'a pas tout pris
+        uint64_t outputQueued  = 0; // Octets en file d'envoi en ce moment
+        uint64_t connections   = 0; // Ouvertes en ce moment
+
+        std::vector<TypeCount> types; // Frames distribuees, par type
+        TypeCount              otherTypes = {0, 0, 0};
+
+        LatencyHistogram::Snapshot dispatchDelay;
+        LatencyHistogram::Snapshot handlerTime;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+private:
+    // Emplacement de la table des types: state passe a 1 une fois type ecrit (release)
+    struct TypeSlot
+    {
+        std::atomic<int>      state{0};
+        Message::Type         type = 0;
+        std::atomic<uint64_t> frames{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    std::atomic<uint64_t> _bytesIn{0};
+    std::atomic<uint64_t> _bytesOut{0};
+    std::atomic<uint64_t> _framesIn{0};
+    std::atomic<uint64_t> _framesOut{0};
+    std::atomic<uint64_t> _reads{0};
+    std::atomic<uint64_t> _partialReads{0};
+    std::atomic<uint64_t> _blockedWrites{0};
+    std::atomic<uint64_t> _outputQueued{0};
+    std::atomic<uint64_t> _connections{0};
+
+    std::array<TypeSlot, NET_STATS_TYPES> _types;
+    TypeSlot                              _otherTypes;
+
+    LatencyHistogram  _dispatchDelay;
+    LatencyHistogram  _handlerTime;
+    std::atomic<bool> _timing{false};
+
+    static void _add(std::atomic<uint64_t>& counter, uint64_t amount);
+
+public:
+    NetStats() = default;
+
+    NetStats(const NetStats&)            = delete;
+    NetStats& operator=(const NetStats&) = delete;
+
+    void read(size_t bytes);
+    void framesReceived(size_t count, bool partial);
+    void wrote(size_t bytes, bool blocked);
+    void frameSent();
+    void queued(size_t before, size_t after);
+    void connected();
+    void disconnected();
+    void dispatched(Message::Type type, size_t bytes);
+    void dispatchDelay(Clock::duration delay);
+    void handlerTime(Clock::duration duration);
+
+    void setTiming(bool enabled);
+    bool timing() const;
+
+    Snapshot snapshot() const;
+};
+
+#endif
@@ -2,8 +2,20 @@
 #define NETWORK_HPP
 
 #include "client/client.hpp"
+#include "client_pool/client_pool.hpp"
+#include "event_loop/event_loop.hpp"
+#include "frame_buffer/frame_buffer.hpp"
+#include "io_uring/io_uring.hpp"
+#include "latency_histogram/latency_histogram.hpp"
+#include "lz_codec/lz_codec.hpp"
 #include "message/message.hpp"
+#include "message_view/message_view.hpp"
+#include "net_stats/net_stats.hpp"
+#include "output_queue/output_queue.hpp"
+#include "reactor_server/reactor_server.hpp"
 #include "ring_buffer/ring_buffer.hpp"
 #include "server/server.hpp"
+#include "timer_wheel/timer_wheel.hpp"
+#include "token_bucket/token_bucket.hpp"
 
 #endif
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include "output_queue.hpp"
+
+/**
+ * @brief Wrap serialized bytes in an immutable buffer that several queues can reference.
+ */
+OutputQueue::SharedBytes OutputQueue::share(std::vector<unsigned char>&& data)
+{
+    return std::make_shared<const std::vector<unsigned char>>(std::move(data));
+}
+
+/**
+ * @brief Serialize a message once for connections of any wire format.
+ */
+OutputQueue::SharedFrame OutputQueue::share(const Message& message, uint64_t correlationId)
+{
+    using Format = Message::WireFormat;
+
+    // Compresse une seule fois pour toutes les connexions (voir Message::setCompression())
+    SharedFrame                frame;
+    std::vector<unsigned char> packed;
+    frame.header                 = {};
+    frame.header.correlationId   = correlationId;
+    const unsigned char* payload = message.packPayload(frame.header, packed);
+
+    unsigned char legacy[MESSAGE_HEADER_MAX_SIZE];
+    unsigned char compact[MESSAGE_HEADER_MAX_SIZE];
+    size_t        legacySize  = Message::encodeHeader(frame.header, Format::LEGACY, legacy);
+    size_t        compactSize = Message::encodeHeader(frame.header, Format::COMPACT, compact);
+
+    frame.legacyHeader  = share(std::vector<unsigned char>(legacy, legacy + legacySize));
+    frame.compactHeader = share(std::vector<unsigned char>(compact, compact + compactSize));
+    if (frame.header.originalSize != 0)
+        frame.payload = share(std::move(packed));
+    else
+        frame.payload = share(std::vector<unsigned char>(payload, payload + frame.header.size));
+    return frame;
+}
+
+void OutputQueue::push(const SharedFrame& frame, Message::WireFormat format, uint64_t channel)
+{
+    if (channel == 0)
+        push(format == Message::WireFormat::COMPACT ? frame.compactHeader : frame.legacyHeader);
+    else
+    {
+        Message::Header header = frame.header;
+        unsigned char   bytes[MESSAGE_HEADER_MAX_SIZE];
+        header.channel = channel;
+        push(bytes, Message::encodeHeader(header, format, bytes));
+    }
+    push(frame.payload);
+}
+
+/**
+ * @brief Queue data from offset without copying it (e.g. a chunk of DataBuffer::takeChunks()).
+ */
+void OutputQueue::push(const SharedBytes& data, size_t offset)
+{
+    if (!data || data->size() <= offset)
+        return;
+
+    _size += data->size() - offset;
+    _segments.push_back({data, offset});
+    _updateCongestion();
+}
+
+void OutputQueue::push(std::vector<unsigned char>&& data)
+{
+    if (data.empty())
+        return;
+
+    push(share(std::move(data)));
+}
+
+void OutputQueue::push(const unsigned char* data, size_t len)
+{
+    if (len == 0 || data == nullptr)
+        return;
+
+    push(std::vector<unsigned char>(data, data + len));
+}
+
+/**
+ * @brief Queue scattered buffers as a single segment (one copy, one allocation).
+ */
+void OutputQueue::push(const iovec* iov, size_t count)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+        total += iov[i].iov_len;
+    if (total == 0)
+        return;
+
+    std::vector<unsigned char> data(total);
+    size_t                     pos = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (iov[i].iov_len == 0)
+            continue;
+        memcpy(data.data() + pos, iov[i].iov_base, iov[i].iov_len);
+        pos += iov[i].iov_len;
+    }
+    push(std::move(data));
+}
+
+/**
+ * @brief Send scattered buffers, queueing whatever the socket does not accept right away.
+ * When nothing is pending they are sent directly with sendmsg(): only the unsent tail is copied.
+ * Otherwise they are queued behind the pending data to keep the stream in order.
+ * @return false on a fatal socket error (the connection should be closed), true otherwise.
+ */
+bool OutputQueue::write(int fd, const iovec* iov, size_t count)
+{
+    if (!_segments.empty())
+    {
+        push(iov, count);
+        return true;
+    }
+
+    ssize_t sent = _sendmsg(fd, iov, count);
+    if (sent < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            return false;
+        sent = 0;
+    }
+
+    // On ne garde que la partie que le noyau n'a pas prise
+    std::vector<iovec> rest;
+    size_t             skip = sent;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (skip >= iov[i].iov_len)
+        {
+            skip -= iov[i].iov_len;
+            continue;
+        }
+        rest.push_back({static_cast<char*>(iov[i].iov_base) + skip, iov[i].iov_len - skip});
+        skip = 0;
+    }
+    push(rest.data(), rest.size());
+    return true;
+}
+
+/**
+ * @brief Send as much pending data as the socket accepts without blocking.
+ * @return false on a fatal socket error (the connection should be closed), true otherwise,
+ * even if some data is still pending.
+ */
+bool OutputQueue::flush(int fd)
+{
+    iovec iov[OUTPUT_MAX_IOVECS];
+
+    while (!_segments.empty())
+    {
+        size_t count = 0;
+        for (auto it = _segments.begin(); it != _segments.end() && count < OUTPUT_MAX_IOVECS;
+             ++it, ++count)
+        {
+            iov[count].iov_base = const_cast<unsigned char*>(it->data->data()) + it->offset;
+            iov[count].iov_len  = it->data->size() - it->offset;
+        }
+
+        ssize_t sent = _sendmsg(fd, iov, count);
+        if (sent < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            return false;
+        }
+        _consume(sent);
+    }
+
+    _updateCongestion();
+    return true;
+}
+
+ssize_t OutputQueue::_sendmsg(int fd, const iovec* iov, size_t count)
+{
+    msghdr msg     = {};
+    msg.msg_iov    = const_cast<iovec*>(iov);
+    msg.msg_iovlen = count;
+
+    ssize_t sent;
+    do
+    {
+        sent = ::sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    } while (sent < 0 && errno == EINTR);
+    return sent;
+}
+
+// Retire les octets envoyes: un sendmsg() peut finir au milieu de n'importe quel segment
+void OutputQueue::_consume(size_t sent)
+{
+    _size -= sent;
+    while (sent > 0)
+    {
+        Segment& segment   = _segments.front();
+        size_t   remaining = segment.data->size() - segment.offset;
+        if (sent < remaining)
+        {
+            segment.offset += sent;
+            return;
+        }
+        sent -= remaining;
+        _segments.pop_front();
+    }
+}
+
+void OutputQueue::clear()
+{
+    _segments.clear();
+    _size      = 0;
+    _congested = false;
+}
+
+void OutputQueue::_updateCongestion()
+{
+    if (!_congested && _size >= _highWaterMark)
+        _congested = true;
+    else if (_congested && _size <= _lowWaterMark)
+        _congested = false;
+}
+
+/**
+ * @brief Configure when the queue is reported as congested.
+ * @param highWaterMark Pending size at which the queue becomes congested.
+ * @param lowWaterMark Pending size at which a congested queue is relieved (<= highWaterMark).
+ */
+void OutputQueue::setWaterMarks(size_t highWaterMark, size_t lowWaterMark)
+{
+    if (lowWaterMark > highWaterMark)
+        throw std::invalid_argument("Low water mark must not exceed the high water mark");
+
+    _highWaterMark = highWaterMark;
+    _lowWaterMark  = lowWaterMark;
+    _updateCongestion();
+}
+
+bool OutputQueue::congested() const
+{
+    return _congested;
+}
+
+bool OutputQueue::empty() const
+{
+    return _segments.empty();
+}
+
+size_t OutputQueue::size() const
+{
+    return _size;
+}
@@ -0,0 +1,118 @@
+#ifndef OUTPUT_QUEUE_HPP
+#define OUTPUT_QUEUE_HPP
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "../message/message.hpp"
+
+#define OUTPUT_HIGH_WATER_MARK 1048576 // 1 MB en attente: le client est considere comme lent
+#define OUTPUT_LOW_WATER_MARK  262144  // 256 KB: le client a rattrape son retard
+#define OUTPUT_MAX_IOVECS      64      // Segments regroupes dans un seul sendmsg()
+
+/**
+ * @brief Outbound byte queue of a non-blocking connection.
+ *
+ * Data that the socket cannot take right away is kept here, as a list of segments, and sent
+ * later by flush() when the socket becomes writable again: the caller never blocks on a slow
+ * reader, and partial writes are resumed where they stopped.
+ *
+ * The queue tracks two water marks with hysteresis: it becomes congested when the pending
+ * size reaches the high water mark and stops being congested once drained down to the low
+ * water mark. Owners use congested() to apply backpressure on their producers.
+ *
+ * @code
+ * OutputQueue outbox;
+ * outbox.setWaterMarks(64 * 1024, 16 * 1024);
+ *
+ * outbox.push(message.getSerializedData());
+ * if (!outbox.flush(fd))
+ *     closeConnection(fd);          // fatal socket error
+ * else if (!outbox.empty())
+ *     waitUntilWritable(fd);        // EPOLLOUT / select() write set
+ * @endcode
+ *
+ * Segments are immutable and reference counted: the same serialized message can be pushed into
+ * the queues of many connections (broadcast) without being copied.
+ *
+ * @code
+ * OutputQueue::SharedBytes bytes = OutputQueue::share(message.getSerializedData());
+ * for (auto& outbox : outboxes)
+ *     outbox.push(bytes); // one serialization, N references
+ *
+ * // Connections may not share the same wire format: the payload is shared, headers are not
+ * OutputQueue::SharedFrame frame = OutputQueue::share(message);
+ * outbox.push(frame, Message::WireFormat::COMPACT);
+ *
+ * // Frame for a logical channel of a ClientPool connection: only its header is rebuilt
+ * outbox.push(frame, Message::WireFormat::COMPACT, channel);
+ * @endcode
+ *
+ * write() sends scattered buffers (e.g. a message header and its payload) with a single
+ * sendmsg() when nothing is pending, and only copies what the socket did not accept.
+ * flush() gathers up to OUTPUT_MAX_IOVECS queued segments per sendmsg(), so many small queued
+ * messages leave in one system call.
+ *
+ * @note flush() uses MSG_NOSIGNAL: a closed peer is reported as an error, not as SIGPIPE
+ */
+class OutputQueue
+{
+public:
+    using SharedBytes = std::shared_ptr<const std::vector<unsigned char>>;
+
+    struct SharedFrame
+    {
+        Message::Header header; // Pour reconstruire le header d'un autre canal
+        SharedBytes     legacyHeader;
+        SharedBytes     compactHeader;
+        SharedBytes     payload;
+    };
+
+private:
+    struct Segment
+    {
+        SharedBytes data;
+        size_t      offset;
+    };
+
+    std::deque<Segment> _segments;
+    size_t              _size          = 0;
+    size_t              _highWaterMark = OUTPUT_HIGH_WATER_MARK;
+    size_t              _lowWaterMark  = OUTPUT_LOW_WATER_MARK;
+    bool                _congested     = false;
+
+    void    _updateCongestion();
+    void    _consume(size_t sent);
+    ssize_t _sendmsg(int fd, const iovec* iov, size_t count);
+
+public:
+    static SharedBytes share(std::vector<unsigned char>&& data);
+    static SharedFrame share(const Message& message, uint64_t correlationId = 0);
+
+    void push(const SharedBytes& data, size_t offset = 0);
+    void push(const SharedFrame& frame, Message::WireFormat format, uint64_t channel = 0);
+    void push(std::vector<unsigned char>&& data);
+    void push(const unsigned char* data, size_t len);
+    void push(const iovec* iov, size_t count);
+
+    bool write(int fd, const iovec* iov, size_t count);
+    bool flush(int fd);
+    void clear();
+
+    void setWaterMarks(size_t highWaterMark, size_t lowWaterMark);
+    bool congested() const;
+
+    bool   empty() const;
+    size_t size() const;
+};
+
+#endif
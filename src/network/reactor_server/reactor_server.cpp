@@ -0,0 +1,265 @@
+#include "reactor_server.hpp"
+
+// Reactor execute par le thread courant (nullptr hors des threads d'un ReactorServer)
+static thread_local const ReactorServer* tlsOwner = nullptr;
+static thread_local size_t               tlsIndex = 0;
+
+ReactorServer::ReactorServer(size_t nbReactors) : ReactorServer("", 0, nbReactors) {}
+
+ReactorServer::ReactorServer(const std::string& address, size_t port, size_t nbReactors)
+{
+    if (nbReactors == 0)
+        throw std::invalid_argument("ReactorServer needs at least one reactor");
+
+    _reactors.reserve(nbReactors);
+    for (size_t i = 0; i < nbReactors; i++)
+    {
+        _reactors.emplace_back(new Server(address, port, Server::Backend::EPOLL));
+        _reactors[i]->_reusePort = true;
+        _reactors[i]->_next_id   = static_cast<long long>(i);
+        _reactors[i]->_idStride  = static_cast<long long>(nbReactors);
+    }
+}
+
+ReactorServer::~ReactorServer()
+{
+    stop();
+}
+
+/**
+ * @brief Bind every reactor and start their threads.
+ * @param port Port shared by the reactors, 0 to keep the one given to the constructor
+ * @throw std::invalid_argument if both are 0: each reactor would bind its own ephemeral port
+ *        and SO_REUSEPORT would not spread anything
+ */
+void ReactorServer::start(const size_t& port)
+{
+    if (_running)
+        return;
+    if (port == 0 && _reactors[0]->_port == 0)
+        throw std::invalid_argument("ReactorServer needs a non zero port, shared by its reactors");
+
+    for (auto& reactor : _reactors)
+    {
+        try
+        {
+            reactor->start(port);
+        }
+        catch (...)
+        {
+            for (auto& started : _reactors)
+                started->stop();
+            throw;
+        }
+    }
+
+    _running = true;
+    for (size_t i = 0; i < _reactors.size(); i++)
+        _threads.emplace_back(&ReactorServer::_loop, this, i);
+}
+
+void ReactorServer::_loop(size_t index)
+{
+    tlsOwner = this;
+    tlsIndex = index;
+
+    while (_running)
+        _reactors[index]->update();
+}
+
+void ReactorServer::stop()
+{
+    if (!_running)
+        return;
+
+    _running = false;
+    for (auto& reactor : _reactors)
+    {
+        Server* server = reactor.get();
+        // update() ne rend la main que lorsqu'il n'y a plus rien a lire: on le force a sortir
+        server->post([server]() { server->_running = false; });
+    }
+
+    for (auto& thread : _threads)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+    _threads.clear();
+
+    for (auto& reactor : _reactors)
+        reactor->stop();
+}
+
+void ReactorServer::defineAction(
+    const Message::Type&                                                    messageType,
+    const std::function<void(long long& clientID, const MessageView& msg)>& action)
+{
+    for (auto& reactor : _reactors)
+        reactor->defineAction(messageType, action);
+}
+
+void ReactorServer::setOutputWaterMarks(size_t highWaterMark, size_t lowWaterMark)
+{
+    for (auto& reactor : _reactors)
+        reactor->setOutputWaterMarks(highWaterMark, lowWaterMark);
+}
+
+void ReactorServer::defineBackpressureAction(
+    const std::function<void(long long& clientID, bool congested)>& action)
+{
+    for (auto& reactor : _reactors)
+        reactor->defineBackpressureAction(action);
+}
+
+void ReactorServer::setMaxFrameSize(size_t maxFrameSize)
+{
+    for (auto& reactor : _reactors)
+        reactor->setMaxFrameSize(maxFrameSize);
+}
+
+void ReactorServer::setMaxChannels(size_t maxChannels)
+{
+    for (auto& reactor : _reactors)
+        reactor->setMaxChannels(maxChannels);
+}
+
+/**
+ * @brief Per connection limits (see Server::setRateLimit), before start().
+ */
+void ReactorServer::setRateLimit(double bytesPerSecond, double messagesPerSecond,
+                                 std::chrono::milliseconds burst)
+{
+    for (auto& reactor : _reactors)
+        reactor->setRateLimit(bytesPerSecond, messagesPerSecond, burst);
+}
+
+/**
+ * @brief Idle timeout and keepalive of every connection (see Server::setIdleTimeout), before
+ *        start().
+ */
+void ReactorServer::setIdleTimeout(std::chrono::milliseconds timeout,
+                                   std::chrono::milliseconds keepalive)
+{
+    for (auto& reactor : _reactors)
+        reactor->setIdleTimeout(timeout, keepalive);
+}
+
+/**
+ * @brief Run the handlers of every reactor on a shared WorkerPool (see Server::setWorkerPool).
+ */
+void ReactorServer::setWorkerPool(WorkerPool* pool)
+{
+    for (auto& reactor : _reactors)
+        reactor->setWorkerPool(pool);
+}
+
+bool ReactorServer::_isReactorThread(size_t index) const
+{
+    return tlsOwner == this && tlsIndex == index;
+}
+
+void ReactorServer::sendTo(const Message& message, long long clientID)
+{
+    _sendTo(message, clientID, 0);
+}
+
+/**
+ * @brief Answer a Client::call() from any thread (see Server::reply()).
+ */
+void ReactorServer::reply(long long clientID, const MessageView& request, const Message& response)
+{
+    _sendTo(response, clientID, request.correlationId());
+}
+
+void ReactorServer::reply(long long clientID, uint64_t correlationId, const Message& response)
+{
+    _sendTo(response, clientID, correlationId);
+}
+
+void ReactorServer::_sendTo(const Message& message, long long clientID, uint64_t correlationId)
+{
+    if (clientID < 0)
+        return;
+
+    size_t  index  = reactorOf(clientID);
+    Server* server = _reactors[index].get();
+
+    if (!_running || _isReactorThread(index))
+        return server->_sendTo(message, clientID, correlationId);
+
+    // Serialise dans le thread appelant: le reacteur n'a plus qu'a mettre en file
+    OutputQueue::SharedFrame frame = OutputQueue::share(message, correlationId);
+    server->post([server, frame, clientID]() { server->_sendSerialized(frame, clientID); });
+}
+
+/**
+ * @brief Serialize once, then hand the shared buffer to the reactor owning each client.
+ */
+void ReactorServer::sendToArray(const Message& message, const std::vector<long long>& clientIDs)
+{
+    if (clientIDs.empty())
+        return;
+
+    std::vector<std::vector<long long>> perReactor(_reactors.size());
+    for (auto& id : clientIDs)
+    {
+        if (id >= 0)
+            perReactor[reactorOf(id)].push_back(id);
+    }
+
+    OutputQueue::SharedFrame frame = OutputQueue::share(message);
+    for (size_t i = 0; i < _reactors.size(); i++)
+    {
+        if (perReactor[i].empty())
+            continue;
+
+        Server* server = _reactors[i].get();
+        if (!_running || _isReactorThread(i))
+        {
+            for (auto& id : perReactor[i])
+                server->_sendSerialized(frame, id);
+        }
+        else
+        {
+            server->post(
+                [server, frame, ids = std::move(perReactor[i])]()
+                {
+                    for (auto& id : ids)
+                        server->_sendSerialized(frame, id);
+                });
+        }
+    }
+}
+
+/**
+ * @brief Broadcast to every reactor: the message is serialized once for all of them.
+ */
+void ReactorServer::sendToAll(const Message& message)
+{
+    OutputQueue::SharedFrame frame = OutputQueue::share(message);
+    for (size_t i = 0; i < _reactors.size(); i++)
+    {
+        Server* server = _reactors[i].get();
+
+        if (!_running || _isReactorThread(i))
+            server->_sendSerializedToAll(frame);
+        else
+            server->post([server, frame]() { server->_sendSerializedToAll(frame); });
+    }
+}
+
+size_t ReactorServer::size() const
+{
+    return _reactors.size();
+}
+
+size_t ReactorServer::reactorOf(long long clientID) const
+{
+    return static_cast<size_t>(clientID >> CONNECTION_SLOT_BITS) % _reactors.size();
+}
+
+NetStats& ReactorServer::stats(size_t reactor)
+{
+    return _reactors.at(reactor)->stats();
+}
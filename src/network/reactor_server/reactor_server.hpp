@@ -0,0 +1,99 @@
+#ifndef REACTOR_SERVER_HPP
+#define REACTOR_SERVER_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../server/server.hpp"
+
+/**
+ * @brief Multi-threaded TCP server made of several independent Server reactors.
+ *
+ * Each reactor is a Server using the epoll backend, running update() in its own thread and
+ * owning its own listening socket bound with SO_REUSEPORT: the kernel spreads incoming
+ * connections between them, so accept, receive, parsing and dispatch all scale with cores.
+ * A connection stays on the reactor that accepted it for its whole lifetime.
+ *
+ * Client ID generations are striped between reactors (reactor i hands out i, i + N, i + 2N...),
+ * so the owner of an ID is found with a modulo and no shared table. sendTo() called from the owning
+ * reactor thread (typically from a handler) sends directly, from any other thread the message
+ * is posted to the owner's queue: there is no lock shared by all reactors.
+ *
+ * @note Actions (and water marks) must be defined before start(): handlers run concurrently on
+ *       every reactor thread and must be thread-safe with respect to the state they share
+ * @note Every reactor binds the same port, so it must be explicit: start() throws
+ *       std::invalid_argument when neither start() nor the constructor gives a non zero port
+ * @note stats(i) are the counters of reactor i (see Server::stats()), readable from any thread
+ *
+ * @code
+ * ReactorServer server("0.0.0.0", 8080, 4);
+ *
+ * server.defineAction(1001, [&server](long long& clientID, const MessageView& msg) {
+ *     Message response(1002);
+ *     response << std::string("pong");
+ *     server.sendTo(response, clientID); // called from the owning reactor: sent directly
+ * });
+ *
+ * server.start(8080); // returns immediately, reactors run in background threads
+ * ...
+ * server.stop();
+ * @endcode
+ *
+ * @throws std::runtime_error if a reactor cannot start (bind, listen, epoll failures)
+ * @see Server for the single-threaded implementation used by each reactor
+ */
+class ReactorServer
+{
+private:
+    std::vector<std::unique_ptr<Server>> _reactors;
+    std::vector<std::thread>             _threads;
+    std::atomic<bool>                    _running{false};
+
+    void _loop(size_t index);
+    bool _isReactorThread(size_t index) const;
+    void _sendTo(const Message& message, long long clientID, uint64_t correlationId);
+
+public:
+    ReactorServer(size_t nbReactors);
+    ReactorServer(const std::string& address, size_t port, size_t nbReactors);
+    ~ReactorServer();
+
+    ReactorServer(const ReactorServer&)            = delete;
+    ReactorServer& operator=(const ReactorServer&) = delete;
+
+    void start(const size_t& port);
+    void stop();
+
+    void defineAction(
+        const Message::Type&                                                    messageType,
+        const std::function<void(long long& clientID, const MessageView& msg)>& action);
+
+    void setOutputWaterMarks(size_t highWaterMark, size_t lowWaterMark);
+    void defineBackpressureAction(
+        const std::function<void(long long& clientID, bool congested)>& action);
+    void setMaxFrameSize(size_t maxFrameSize);
+    void setMaxChannels(size_t maxChannels);
+    void setRateLimit(double                    bytesPerSecond,
+                      double                    messagesPerSecond,
+                      std::chrono::milliseconds burst = std::chrono::seconds(1));
+    void setIdleTimeout(std::chrono::milliseconds timeout,
+                        std::chrono::milliseconds keepalive = std::chrono::milliseconds::zero());
+    void setWorkerPool(WorkerPool* pool);
+
+    void sendTo(const Message& message, long long clientID);
+    void reply(long long clientID, const MessageView& request, const Message& response);
+    void reply(long long clientID, uint64_t correlationId, const Message& response);
+    void sendToArray(const Message& message, const std::vector<long long>& clientIDs);
+    void sendToAll(const Message& message);
+
+    size_t size() const;
+    size_t reactorOf(long long clientID) const;
+
+    NetStats& stats(size_t reactor);
+};
+
+#endif
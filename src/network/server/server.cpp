@@ -1,13 +1,37 @@
 #include "server.hpp"
 
-Server::Server() : _address(""), _port(0) {}
+// user_data des requetes io_uring: l'evenement dans l'octet de poids fort, l'id client dessous.
+// Une completion arrivee apres la fermeture d'un client porte un id inconnu et est ignoree
+enum UringEvent : uint64_t
+{
+    URING_ACCEPT = 1,
+    URING_WAKE,
+    URING_RECV,
+    URING_POLLOUT,
+    URING_CANCEL
+};
+
+static const uint64_t URING_ID_MASK = (1ULL << 56) - 1;
+
+static uint64_t uringTag(UringEvent event, long long clientId)
+{
+    return (static_cast<uint64_t>(event) << 56) | (static_cast<uint64_t>(clientId) & URING_ID_MASK);
+}
+
+// Serveur dont le thread courant execute un handler (worker de setWorkerPool())
+static thread_local const Server* tlsWorkerOf = nullptr;
+
+Server::Server(Backend backend) : _address(""), _port(0), _backend(backend) {}
 
 Server::~Server()
 {
     stop();
 }
 
-Server::Server(const std::string& address, size_t port) : _address(address), _port(port) {}
+Server::Server(const std::string& address, size_t port, Backend backend)
+    : _address(address), _port(port), _backend(backend)
+{
+}
 
 void Server::start(const size_t& port)
 {
@@ -22,6 +46,13 @@ void Server::start(const size_t& port)
         perror("setsockopt SO_REUSEADDR failed");
     }
 
+    // Plusieurs sockets peuvent ecouter sur le meme port: le noyau repartit les connexions
+    if (_reusePort && setsockopt(_socket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+    {
+        stop();
+        throw std::runtime_error("Failed to set SO_REUSEPORT. errno: " + std::to_string(errno));
+    }
+
     sockaddr_in sockaddr;
     sockaddr.sin_family = AF_INET;
     if (!_address.empty())
@@ -47,218 +78,1501 @@ void Server::start(const size_t& port)
 
     _max_fd = _socket;
     FD_ZERO(&_active);
+    FD_ZERO(&_activeWrite);
     FD_SET(_socket, &_active);
 
-    if (listen(_socket, NB_CONNECTION) < 0)
+    if (listen(_socket, _backend == Backend::SELECT ? NB_CONNECTION : SOMAXCONN) < 0)
     {
         stop();
         throw std::runtime_error("Failed to listen on socket. errno: " + std::to_string(errno));
     }
+
+    _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wakeFd < 0)
+    {
+        stop();
+        throw std::runtime_error("Failed to create wake up eventfd. errno: " +
+                                 std::to_string(errno));
+    }
+
+    if (_backend == Backend::EPOLL)
+    {
+        // Edge-triggered: accept() doit pouvoir boucler jusqu'a EAGAIN sans bloquer
+        fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL, 0) | O_NONBLOCK);
+
+        _epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (_epollFd < 0)
+        {
+            stop();
+            throw std::runtime_error("Failed to create epoll instance. errno: " +
+                                     std::to_string(errno));
+        }
+
+        epoll_event ev;
+        ev.events  = EPOLLIN | EPOLLET;
+        ev.data.fd = _socket;
+        if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _socket, &ev) < 0)
+        {
+            stop();
+            throw std::runtime_error("Failed to register socket in epoll. errno: " +
+                                     std::to_string(errno));
+        }
+
+        ev.events  = EPOLLIN;
+        ev.data.fd = _wakeFd;
+        epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &ev);
+
+        _events.resize(EPOLL_MAX_EVENTS);
+        if (_loop)
+            _watchLoop();
+    }
+    else if (_backend == Backend::IO_URING)
+    {
+        try
+        {
+            _uring.reset(new IoUring(IO_URING_ENTRIES));
+            _uring->provideBuffers(IO_URING_BUFFER_COUNT, IO_URING_BUFFER_SIZE);
+        }
+        catch (const std::exception&)
+        {
+            stop();
+            throw;
+        }
+
+        // Armees une fois: chaque connexion et chaque reveil produit sa propre completion
+        _uring->acceptMultishot(_socket, uringTag(URING_ACCEPT, 0));
+        _uring->pollMultishot(_wakeFd, uringTag(URING_WAKE, 0));
+    }
+    else
+    {
+        FD_SET(_wakeFd, &_active);
+        if (_max_fd < _wakeFd)
+            _max_fd = _wakeFd;
+    }
 }
 
-void Server::_acceptNewConnection()
+bool Server::_acceptNewConnection()
 {
     int connfd = accept(_socket, 0, 0);
     if (connfd < 0)
-        return;
+        return false;
+
+    // Un client lent ne doit jamais bloquer la boucle: les envois passent par sa file d'envoi
+    fcntl(connfd, F_SETFL, fcntl(connfd, F_GETFL, 0) | O_NONBLOCK);
+
+    _registerConnection(connfd);
+    return true;
+}
 
-    if (_clients.size() >= NB_CONNECTION)
+void Server::_registerConnection(int connfd)
+{
+    long long id = (_next_id << CONNECTION_SLOT_BITS) | connfd;
+
+    // Le fd sert d'index dans _connections et dans les client IDs
+    if (connfd >= (1 << CONNECTION_SLOT_BITS))
     {
-        std::cout << "Max connections reached, closing new connection" << std::endl;
+        std::cout << "File descriptor too large, closing new connection" << std::endl;
         close(connfd);
         return;
     }
 
-    if (_max_fd < connfd)
-        _max_fd = connfd;
+    if (_backend == Backend::EPOLL)
+    {
+        if (_nbConnections >= NB_CONNECTION_EPOLL)
+        {
+            std::cout << "Max connections reached, closing new connection" << std::endl;
+            close(connfd);
+            return;
+        }
+
+        epoll_event ev;
+        ev.events  = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = connfd;
+        if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, connfd, &ev) < 0)
+        {
+            close(connfd);
+            return;
+        }
+    }
+    else if (_backend == Backend::IO_URING)
+    {
+        if (_nbConnections >= NB_CONNECTION_EPOLL)
+        {
+            std::cout << "Max connections reached, closing new connection" << std::endl;
+            close(connfd);
+            return;
+        }
+
+        _uring->recvMultishot(connfd, uringTag(URING_RECV, id));
+    }
+    else
+    {
+        // Un fd >= FD_SETSIZE ne peut pas etre place dans un fd_set
+        if (_nbConnections >= NB_CONNECTION || connfd >= FD_SETSIZE)
+        {
+            std::cout << "Max connections reached, closing new connection" << std::endl;
+            close(connfd);
+            return;
+        }
+
+        if (_max_fd < connfd)
+            _max_fd = connfd;
 
-    FD_SET(connfd, &_active);
-    FD_SET(connfd, &_readyRead);
+        FD_SET(connfd, &_active);
+        FD_SET(connfd, &_readyRead);
+    }
+
+    // std::deque n'a pas de move noexcept: resize() recopierait chaque connexion
+    if (static_cast<size_t>(connfd) >= _connections.size())
+    {
+        std::vector<Connection> grown(std::max<size_t>(connfd + 1, _connections.size() * 2));
+        std::move(_connections.begin(), _connections.end(), grown.begin());
+        _connections.swap(grown);
+    }
 
-    _clients[connfd]       = _next_id;
-    _clientsToFd[_next_id] = connfd;
-    _next_id++;
+    Connection& connection = _connections[connfd];
+    connection.id          = id;
+    connection.outbox.setWaterMarks(_highWaterMark, _lowWaterMark);
+    connection.inbox.setMaxFrameSize(_maxFrameSize);
+    connection.limiter = _makeLimiter();
+    connection.lastActivity = TimerWheel::Clock::now();
+    _armIdleTimer(connfd, connection);
+    _next_id += _idStride;
+    _nbConnections++;
+    _stats.connected();
 }
 
 bool Server::_receiveClientMsg(const int& fd)
 {
+    Connection&  connection = _connections[fd];
+    FrameBuffer& inbox      = connection.inbox;
+    RateLimiter& limiter    = connection.limiter;
+    ssize_t      bytes      = -1;
+    size_t       chunk      = 0;
 
-    if (!FD_ISSET(fd, &_readyRead))
+    // Les octets sont lus directement dans le buffer de la connexion, dans la limite du debit
+    while (!limiter.throttled && (chunk = limiter.bytes.allowance(READ_BUFFER_SIZE)) > 0 &&
+           (bytes = recv(fd, inbox.prepare(chunk), chunk, MSG_DONTWAIT)) > 0)
+    {
+        inbox.commit(bytes);
+        _stats.read(bytes);
+        limiter.bytes.consume(bytes);
+        _touch(fd, connection);
+    }
+
+    if (!_extractFrames(fd, inbox))
         return false;
 
-    char buffRead[READ_BUFFER_SIZE];
-    int  bytes = 0;
+    // Seau vide: le reste attend dans la socket, TCP ralentit le client
+    if (chunk == 0)
+    {
+        _throttle(fd, connection);
+        return true;
+    }
 
-    while ((bytes = recv(fd, buffRead, sizeof(buffRead), MSG_DONTWAIT)) > 0)
+    if (bytes == 0 || (bytes == -1 && errno != EAGAIN && errno != EWOULDBLOCK))
     {
-        _partialMsgs[fd].appendBytes(reinterpret_cast<unsigned char*>(buffRead), bytes);
-        while (_partialMsgs[fd].isComplet())
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Split the received bytes into frames and answer a wire format change.
+ * @return false if the client sent a malformed header and must be disconnected
+ */
+bool Server::_extractFrames(int fd, FrameBuffer& inbox)
+{
+    bool                wasIdle  = inbox.frames().empty();
+    Message::WireFormat previous = inbox.format();
+
+    try
+    {
+        size_t count = inbox.extract();
+        _stats.framesReceived(count, inbox.pending() > 0);
+
+        // Sessions ouvertes des la reception: un client ne peut pas en creer sans limite
+        auto frames = inbox.frames();
+        for (size_t i = frames.size() - count; i < frames.size(); i++)
         {
+            if (frames[i].channel == 0 || _sessionId(fd, frames[i].channel) >= 0)
+                continue;
+            std::cout << "Closing client " << _connections[fd].id << ": more than "
+                      << _maxChannels << " channels" << std::endl;
+            _metrics.droppedClients++;
+            _metrics.channelFloods++;
+            return false;
+        }
+
+        if (count > 0 && wasIdle)
+        {
+            _readyInboxes.push_back(fd);
+            if (_stats.timing())
+                _connections[fd].receivedAt = NetStats::Clock::now();
+        }
+    }
+    catch (const std::length_error& e)
+    {
+        std::cout << "Closing client " << _connections[fd].id << ": " << e.what() << std::endl;
+        _metrics.droppedClients++;
+        _metrics.oversizedFrames++;
+        return false;
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cout << "Closing client " << _connections[fd].id << ": " << e.what() << std::endl;
+        _metrics.droppedClients++;
+        return false;
+    }
 
-            Message::Type msgType;
-            _partialMsgs[fd] >> msgType;
+    if (inbox.format() != previous)
+        _acknowledgeWireFormat(fd, previous);
+    return true;
+}
 
-            Message newMsg(fd, msgType);
+// La confirmation part dans l'ancien format: le client la lit avant ce qui suit dans le nouveau
+void Server::_acknowledgeWireFormat(int fd, Message::WireFormat previous)
+{
+    Message ack(MESSAGE_TYPE_WIRE_FORMAT);
+    ack << static_cast<unsigned char>(_wireFormat(fd));
 
-            size_t dataSize;
-            _partialMsgs[fd] >> dataSize;
+    std::vector<unsigned char> bytes = ack.getSerializedData(previous);
+    iovec                      iov   = {bytes.data(), bytes.size()};
+    _queueOutput(fd, &iov, 1);
+}
 
-            newMsg.appendBytes(_partialMsgs[fd].getBuffer()->data().data(), dataSize);
+Message::WireFormat Server::_wireFormat(int fd) const
+{
+    return _connections[fd].inbox.format();
+}
 
-            _partialMsgs[fd].incr_cursor(dataSize);
+void Server::sendTo(const Message& message, long long clientID)
+{
+    _sendTo(message, clientID, 0);
+}
 
-            newMsg.setMessageFd(fd);
+/**
+ * @brief Answer a request: the response carries the correlation id of the request, so that
+ * Client::call() hands it to the matching callback whatever the order of the responses.
+ * @note Behaves like sendTo() when the request has no correlation id.
+ */
+void Server::reply(long long clientID, const MessageView& request, const Message& response)
+{
+    _sendTo(response, clientID, request.correlationId());
+}
 
-            _msgs.push_back(newMsg);
+/**
+ * @brief Answer later: keep request.correlationId() and reply once the response is ready.
+ */
+void Server::reply(long long clientID, uint64_t correlationId, const Message& response)
+{
+    _sendTo(response, clientID, correlationId);
+}
+
+void Server::_sendTo(const Message& message, long long clientID, uint64_t correlationId)
+{
+    if (_onWorker())
+    {
+        OutputQueue::SharedFrame frame = OutputQueue::share(message, correlationId);
+        return post([this, frame, clientID]() { _sendSerialized(frame, clientID); });
+    }
+
+    uint64_t channel;
+    int      fd = _clientFd(clientID, &channel);
+    if (fd < 0)
+        return;
+
+    // Header et payload partent tels quels dans un seul sendmsg(), sans buffer intermediaire
+    Message::Header            wire = {};
+    std::vector<unsigned char> packed;
+    wire.correlationId = correlationId;
+    wire.channel       = channel;
+
+    const unsigned char* payload = message.packPayload(wire, packed);
+    unsigned char        header[MESSAGE_HEADER_MAX_SIZE];
+    size_t               headerSize = Message::encodeHeader(wire, _wireFormat(fd), header);
+
+    iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len  = headerSize;
+    iov[1].iov_base = const_cast<unsigned char*>(payload);
+    iov[1].iov_len  = wire.size;
+
+    _queueOutput(fd, iov, 2);
+}
+
+// Connexion ouverte sur fd, nullptr si l'emplacement est libre
+Server::Connection* Server::_connection(int fd)
+{
+    if (fd < 0 || static_cast<size_t>(fd) >= _connections.size() || _connections[fd].id < 0)
+        return nullptr;
+    return &_connections[fd];
+}
+
+/**
+ * @brief fd of the connection of clientID (-1 if it is closed), and the channel of the session.
+ * @details The fd is read from the ID, the generation check rejects the ID of a closed client
+ *          whose fd was reused. Only the sessions of a ClientPool need a lookup.
+ */
+int Server::_clientFd(long long clientID, uint64_t* channel) const
+{
+    long long fd = clientID & ((1LL << CONNECTION_SLOT_BITS) - 1);
+    if (clientID < 0 || static_cast<size_t>(fd) >= _connections.size())
+        return -1;
+
+    const Connection& connection = _connections[fd];
+    uint64_t          session    = 0;
+    if (connection.id < 0)
+        return -1;
+    if (connection.id != clientID)
+    {
+        auto sessionIt = connection.sessions.find(clientID);
+        if (sessionIt == connection.sessions.end())
+            return -1;
+        session = sessionIt->second;
+    }
+
+    if (channel)
+        *channel = session;
+    return static_cast<int>(fd);
+}
+
+void Server::_sendSerialized(const OutputQueue::SharedFrame& frame, long long clientID)
+{
+    uint64_t channel;
+    int      fd = _clientFd(clientID, &channel);
+    if (fd < 0)
+        return;
+
+    _queueOutput(fd, frame, channel);
+}
+
+// Chaque session recoit le message, y compris celles des canaux d'une meme connexion
+void Server::_sendSerializedToAll(const OutputQueue::SharedFrame& frame)
+{
+    for (size_t fd = 0; fd < _connections.size(); fd++)
+    {
+        if (_connections[fd].id < 0)
+            continue;
+
+        _queueOutput(fd, frame);
+        for (auto& [channel, sessionId] : _connections[fd].channels)
+            _queueOutput(fd, frame, channel);
+    }
+}
+
+void Server::_queueOutput(int fd, const OutputQueue::SharedFrame& frame, uint64_t channel)
+{
+    Connection* connection = _connection(fd);
+    if (!connection)
+        return;
+
+    OutputQueue& outbox       = connection->outbox;
+    bool         wasEmpty     = outbox.empty();
+    bool         wasCongested = outbox.congested();
+
+    outbox.push(frame, _wireFormat(fd), channel);
+    _stats.frameSent();
+
+    // Si rien n'etait en attente la socket est probablement prete: on tente l'envoi tout de suite
+    if (wasEmpty && !_corked)
+        return _flushClient(fd, wasCongested);
+
+    if (wasEmpty)
+        _corkedFds.push_back(fd);
+    _notifyBackpressure(fd, wasCongested);
+}
+
+void Server::_queueOutput(int fd, const iovec* iov, size_t count)
+{
+    Connection* connection = _connection(fd);
+    if (!connection)
+        return;
+
+    OutputQueue& outbox       = connection->outbox;
+    bool         wasEmpty     = outbox.empty();
+    bool         wasCongested = outbox.congested();
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+        total += iov[i].iov_len;
+
+    // Pendant la distribution les petits messages s'accumulent: un seul sendmsg() par client a
+    // la fin (voir _dispatch). Les gros partent tout de suite, sans copie
+    _stats.frameSent();
+    bool cork = _corked && total <= CORK_MAX_SIZE;
+    if (wasEmpty && !cork)
+    {
+        bool sent = outbox.write(fd, iov, count);
+        if (sent)
+            _stats.wrote(total - outbox.size(), !outbox.empty());
+        return _afterSend(fd, sent, wasCongested);
+    }
+
+    outbox.push(iov, count);
+    if (wasEmpty)
+        _corkedFds.push_back(fd);
+    _notifyBackpressure(fd, wasCongested);
+}
+
+void Server::_flushClient(int fd, bool wasCongested)
+{
+    Connection* connection = _connection(fd);
+    if (!connection)
+        return;
+
+    OutputQueue& outbox = connection->outbox;
+    size_t       before = outbox.size();
+    bool         sent   = outbox.flush(fd);
+    if (sent)
+        _stats.wrote(before - outbox.size(), !outbox.empty());
+    _afterSend(fd, sent, wasCongested);
+}
+
+void Server::_afterSend(int fd, bool sent, bool wasCongested)
+{
+    Connection&  connection = _connections[fd];
+    OutputQueue& outbox     = connection.outbox;
+    if (!sent)
+    {
+        // La connexion est fermee plus tard: on peut etre en train de distribuer ses messages
+        std::cout << "Failed to send message to client " << connection.id << std::endl;
+        _closing.push_back(connection.id);
+        outbox.clear();
+    }
+
+    if (_backend == Backend::SELECT)
+    {
+        if (outbox.empty())
+            FD_CLR(fd, &_activeWrite);
+        else
+            FD_SET(fd, &_activeWrite);
+    }
+    else if (_backend == Backend::IO_URING && !outbox.empty() && !connection.pollOut)
+    {
+        // Reste du a envoyer: une requete POLLOUT ponctuelle previent quand la socket se libere
+        connection.pollOut = true;
+        _uring->pollOut(fd, uringTag(URING_POLLOUT, connection.id));
+    }
+
+    _notifyBackpressure(fd, wasCongested);
+}
+
+// Appele apres chaque changement d'une file d'envoi: la jauge des statistiques suit
+void Server::_notifyBackpressure(int fd, bool wasCongested)
+{
+    Connection* connection = _connection(fd);
+    if (!connection)
+        return;
+
+    _stats.queued(connection->statsQueued, connection->outbox.size());
+    connection->statsQueued = connection->outbox.size();
+    if (connection->outbox.congested() == wasCongested || !_backpressureAction)
+        return;
+
+    long long clientId = connection->id;
+    _backpressureAction(clientId, connection->outbox.congested());
+}
+
+void Server::_closeFailedClients()
+{
+    for (long long clientId : _closing)
+    {
+        int fd = _clientFd(clientId);
+        if (fd >= 0)
+            _clearClient(fd);
+    }
+    _closing.clear();
+}
+
+/**
+ * @brief Configure the output queue size at which clients are reported as congested.
+ * @param highWaterMark Pending bytes at which the backpressure action is called with true.
+ * @param lowWaterMark Pending bytes at which a congested client is reported as relieved.
+ */
+void Server::setOutputWaterMarks(size_t highWaterMark, size_t lowWaterMark)
+{
+    if (lowWaterMark > highWaterMark)
+        throw std::invalid_argument("Low water mark must not exceed the high water mark");
+
+    _highWaterMark = highWaterMark;
+    _lowWaterMark  = lowWaterMark;
+    for (Connection& connection : _connections)
+        connection.outbox.setWaterMarks(highWaterMark, lowWaterMark);
+}
+
+void Server::defineBackpressureAction(
+    const std::function<void(long long& clientID, bool congested)>& action)
+{
+    _backpressureAction = action;
+}
+
+/**
+ * @brief Number of bytes queued for a client and not yet accepted by its socket.
+ */
+size_t Server::pendingOutput(long long clientID) const
+{
+    int fd = _clientFd(clientID);
+    return fd < 0 ? 0 : _connections[fd].outbox.size();
+}
+
+/**
+ * @brief Disconnect clients that announce a payload larger than maxFrameSize bytes (0: no limit).
+ * @details The default, MAX_FRAME_SIZE, keeps a client from making the server buffer an
+ *          arbitrary amount of data for a single message.
+ */
+void Server::setMaxFrameSize(size_t maxFrameSize)
+{
+    _maxFrameSize = maxFrameSize;
+    for (Connection& connection : _connections)
+        connection.inbox.setMaxFrameSize(maxFrameSize);
+}
+
+/**
+ * @brief Largest number of channels (ClientPool sessions) a connection may open (0: no limit).
+ * @details The default, MAX_CHANNELS, keeps a client from making the server allocate a session
+ *          for every channel number it makes up. A client going over it is disconnected.
+ */
+void Server::setMaxChannels(size_t maxChannels)
+{
+    _maxChannels = maxChannels;
+}
+
+/**
+ * @brief Limit what each connection may send (0: no limit, the default).
+ * @param bytesPerSecond Sustained rate of bytes read from the connection.
+ * @param messagesPerSecond Sustained rate of messages dispatched for the connection.
+ * @param burst Credit a quiet connection accumulates: burst x rate bytes or messages may go
+ *              through at once before the sustained rate applies.
+ */
+void Server::setRateLimit(double bytesPerSecond, double messagesPerSecond,
+                          std::chrono::milliseconds burst)
+{
+    if (bytesPerSecond < 0 || messagesPerSecond < 0 || burst.count() <= 0)
+        throw std::invalid_argument("Rate limits must be positive (0: no limit)");
+
+    _bytesPerSecond    = bytesPerSecond;
+    _messagesPerSecond = messagesPerSecond;
+    _burst             = burst;
+    for (Connection& connection : _connections)
+    {
+        RateLimiter fresh           = _makeLimiter();
+        connection.limiter.bytes    = fresh.bytes;
+        connection.limiter.messages = fresh.messages;
+    }
+}
+
+/**
+ * @brief True while the connection of clientID is held back by its rate limit.
+ */
+bool Server::throttled(long long clientID) const
+{
+    int fd = _clientFd(clientID);
+    return fd >= 0 && _connections[fd].limiter.throttled;
+}
+
+/**
+ * @brief Traffic counters and latency histograms of the server, readable from any thread.
+ */
+NetStats& Server::stats()
+{
+    return _stats;
+}
+
+Server::Metrics Server::metrics() const
+{
+    Metrics metrics          = _metrics;
+    metrics.throttledClients = _throttled.size();
+    return metrics;
+}
+
+Server::RateLimiter Server::_makeLimiter() const
+{
+    double      seconds = std::chrono::duration<double>(_burst).count();
+    RateLimiter limiter;
+    limiter.bytes    = TokenBucket(_bytesPerSecond, _bytesPerSecond * seconds);
+    limiter.messages = TokenBucket(_messagesPerSecond, _messagesPerSecond * seconds);
+    return limiter;
+}
+
+// La socket n'est plus lue et les messages restants attendent (voir _resumeThrottled)
+void Server::_throttle(int fd, Connection& connection)
+{
+    if (connection.limiter.throttled)
+        return;
+
+    connection.limiter.throttled = true;
+    _throttled.push_back(fd);
+    _metrics.throttleEvents++;
+
+    // Un recv multishot continuerait de remplir les buffers fournis: on l'annule
+    if (_backend == Backend::IO_URING)
+        _uring->cancel(uringTag(URING_RECV, connection.id), uringTag(URING_CANCEL, 0));
+
+    _scheduleResume();
+}
+
+/**
+ * @brief Serve again the throttled connections whose buckets have refilled.
+ * @details A connection resumes once it can read a full READ_BUFFER_SIZE (or its whole burst)
+ *          and dispatch a message, so that it does not go back and forth for a few bytes.
+ */
+void Server::_resumeThrottled()
+{
+    for (size_t i = 0; i < _throttled.size();)
+    {
+        int          fd      = _throttled[i];
+        RateLimiter& limiter = _connections[fd].limiter;
+        if (limiter.bytes.delay(READ_BUFFER_SIZE) > TokenBucket::Clock::duration::zero() ||
+            limiter.messages.delay(1) > TokenBucket::Clock::duration::zero())
+        {
+            i++;
+            continue;
         }
-        _partialMsgs[fd].getBuffer()->clear();
+
+        _throttled[i] = _throttled.back();
+        _throttled.pop_back();
+        limiter.throttled = false;
+
+        if (!_connections[fd].inbox.frames().empty())
+            _readyInboxes.push_back(fd);
+
+        // Select relit la socket au prochain tour; epoll ne previendra plus (edge-triggered)
+        if (_backend == Backend::IO_URING)
+            _uring->recvMultishot(fd, uringTag(URING_RECV, _connections[fd].id));
+        else if (_backend == Backend::EPOLL && !_receiveClientMsg(fd))
+            _clearClient(fd);
     }
+    _scheduleResume();
+}
 
-    if (bytes == 0 || (bytes == -1 && errno != EAGAIN && errno != EWOULDBLOCK))
+// Avec une EventLoop, aucun evenement ne reveillerait une connexion ralentie: un timer s'en charge
+void Server::_scheduleResume()
+{
+    if (!_loop || _resumeTimer != 0 || _throttled.empty())
+        return;
+
+    TokenBucket::Clock::duration wait = TokenBucket::Clock::duration::max();
+    for (int fd : _throttled)
     {
-        return false;
+        RateLimiter& limiter = _connections[fd].limiter;
+        wait = std::min(wait, std::max(limiter.bytes.delay(READ_BUFFER_SIZE),
+                                       limiter.messages.delay(1)));
     }
 
-    return true;
+    auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(wait) +
+                 std::chrono::milliseconds(1);
+    _resumeTimer = _loop->addTimer(delay,
+                                   [this]()
+                                   {
+                                       _resumeTimer = 0;
+                                       _onLoopEvent();
+                                   });
 }
 
-void Server::sendTo(const Message& message, long long clientID)
+/**
+ * @brief Disconnect clients that send nothing for timeout (0: never, the default).
+ * @param keepalive If not 0, a client quiet for that long is sent a MESSAGE_TYPE_PING first: a
+ *                  Client answers it from update(), which keeps it connected. Must be shorter
+ *                  than timeout.
+ * @details Deadlines are rounded up to IDLE_TIMER_TICK_MS. A throttled connection (see
+ *          setRateLimit()) is not read, it is never considered idle.
+ */
+void Server::setIdleTimeout(std::chrono::milliseconds timeout, std::chrono::milliseconds keepalive)
 {
-    auto fdIt = _clientsToFd.find(clientID);
-    if (fdIt == _clientsToFd.end())
+    if (timeout.count() < 0 || keepalive.count() < 0 ||
+        (keepalive.count() > 0 && keepalive >= timeout))
+        throw std::invalid_argument("Idle timeout must be positive, keepalive shorter (0: none)");
+
+    _idleTimeout = timeout;
+    _keepalive   = keepalive;
+    _idleTimers.clear();
+    if (timeout.count() == 0)
+    {
+        if (_loop && _idleTick != 0)
+            _loop->cancelTimer(_idleTick);
+        _idleTick = 0;
         return;
+    }
+
+    // Les connexions deja ouvertes partent de maintenant
+    TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+    for (size_t fd = 0; fd < _connections.size(); fd++)
+    {
+        Connection& connection = _connections[fd];
+        if (connection.id < 0)
+            continue;
+        connection.lastActivity = now;
+        connection.pinged       = false;
+        _armIdleTimer(fd, connection);
+    }
+    _scheduleIdleTick();
+}
 
-    if (!FD_ISSET(fdIt->second, &_active))
+// Recevoir ne touche pas a la roue: le timer compare lastActivity quand il expire
+void Server::_touch(int fd, Connection& connection)
+{
+    if (_idleTimeout.count() == 0)
         return;
 
-    const auto& data = message.getSerializedData();
-    if (data.empty())
+    connection.lastActivity = TimerWheel::Clock::now();
+    if (connection.pinged)
+    {
+        connection.pinged = false;
+        _armIdleTimer(fd, connection);
+    }
+}
+
+// Prochaine verification: le ping, ou la deconnexion si le ping est parti
+void Server::_armIdleTimer(int fd, const Connection& connection)
+{
+    if (_idleTimeout.count() == 0)
         return;
 
-    ssize_t bytes_sent = send(fdIt->second, data.data(), data.size(), 0);
-    if (bytes_sent == -1)
+    bool ping = _keepalive.count() > 0 && !connection.pinged;
+    _idleTimers.schedule(fd, connection.lastActivity + (ping ? _keepalive : _idleTimeout));
+}
+
+void Server::_onIdleTimer(size_t fd)
+{
+    Connection* connection = _connection(static_cast<int>(fd));
+    if (!connection)
+        return;
+
+    TimerWheel::Clock::time_point now = TimerWheel::Clock::now();
+    if (connection->limiter.throttled)
+        connection->lastActivity = now;
+
+    TimerWheel::Clock::duration idle = now - connection->lastActivity;
+    if (idle >= _idleTimeout)
     {
-        _clearClient(fdIt->second);
-        std::cout << "Failed to send message to client " << clientID << std::endl;
+        int closing = static_cast<int>(fd);
+        _metrics.idleClients++;
+        return _clearClient(closing);
+    }
+
+    if (_keepalive.count() > 0 && !connection->pinged && idle >= _keepalive)
+    {
+        Message                    ping(MESSAGE_TYPE_PING);
+        std::vector<unsigned char> bytes = ping.getSerializedData(_wireFormat(fd));
+        iovec                      iov   = {bytes.data(), bytes.size()};
+
+        connection->pinged = true;
+        _metrics.pingsSent++;
+        _queueOutput(fd, &iov, 1);
     }
+    _armIdleTimer(fd, *connection);
+}
+
+void Server::_expireIdle()
+{
+    if (_idleTimers.size() == 0)
+        return;
+
+    _idleTimers.advance(TimerWheel::Clock::now(), [this](size_t fd) { _onIdleTimer(fd); });
+    _closeFailedClients();
+}
+
+// Avec une EventLoop, la roue avance sur un timer periodique de la boucle
+void Server::_scheduleIdleTick()
+{
+    if (!_loop || _idleTick != 0 || _idleTimeout.count() == 0)
+        return;
+
+    std::chrono::milliseconds tick(IDLE_TIMER_TICK_MS);
+    _idleTick = _loop->addTimer(tick, [this]() { _expireIdle(); }, tick);
 }
 
-void Server::sendToArray(const Message& message, std::vector<long long> clientIDs)
+/**
+ * @brief Send the same message to several clients.
+ * The message is serialized once: every outbox references the same immutable buffer.
+ */
+void Server::sendToArray(const Message& message, const std::vector<long long>& clientIDs)
 {
+    if (clientIDs.empty())
+        return;
+
+    OutputQueue::SharedFrame frame = OutputQueue::share(message);
+    if (_onWorker())
+    {
+        return post(
+            [this, frame, clientIDs]()
+            {
+                for (auto& id : clientIDs)
+                    _sendSerialized(frame, id);
+            });
+    }
+
     for (auto& id : clientIDs)
     {
-        sendTo(message, id);
+        _sendSerialized(frame, id);
     }
 }
 
+/**
+ * @brief Broadcast a message: one serialization, then one reference per connected client.
+ */
 void Server::sendToAll(const Message& message)
 {
-
-    for (auto& [fd, clientId] : _clients)
+    if (_onWorker())
     {
-        sendTo(message, clientId);
+        OutputQueue::SharedFrame frame = OutputQueue::share(message);
+        return post([this, frame]() { _sendSerializedToAll(frame); });
     }
+
+    if (_nbConnections == 0)
+        return;
+
+    _sendSerializedToAll(OutputQueue::share(message));
 }
 
 void Server::defineAction(
-    const Message::Type&                                                messageType,
-    const std::function<void(long long& clientID, const Message& msg)>& action)
+    const Message::Type&                                                    messageType,
+    const std::function<void(long long& clientID, const MessageView& msg)>& action)
 {
     _tasks[messageType] = action;
 }
 
-void Server::update()
+void Server::_pollSelect(int timeoutMs)
 {
-    _running = true;
-    while (_running)
+    _readyRead  = _active;
+    _readyWrite = _activeWrite;
+    // Socket d'une connexion ralentie pas lue: select() se reveillerait en boucle
+    for (int fd : _throttled)
+        FD_CLR(fd, &_readyRead);
+
+    timeval timeout       = {0, timeoutMs * 1000}; // Pour que le select soit non bloquant
+    int     select_result = select(_max_fd + 1, &_readyRead, &_readyWrite, NULL, &timeout);
+
+    if (select_result <= 0)
     {
-        _readyRead            = _active;
-        timeval timeout       = {0, 10000}; // Pour que le select soit non bloquant
-        int     select_result = select(_max_fd + 1, &_readyRead, NULL, NULL, &timeout);
+        if (errno == EBADF || errno == EINTR)
+            std::cout << "Select interrupted, stopping server..." << std::endl;
+        _running = false;
+        return;
+    }
 
-        if (select_result <= 0)
+    for (int fd = 0; fd <= _max_fd; fd++)
+    {
+        if (FD_ISSET(fd, &_readyWrite))
         {
-            if (errno == EBADF || errno == EINTR)
-            {
-                std::cout << "Select interrupted, stopping server..." << std::endl;
-                return;
-            }
-            _running = false;
+            Connection* connection = _connection(fd);
+            if (connection)
+                _flushClient(fd, connection->outbox.congested());
+        }
+
+        if (!FD_ISSET(fd, &_readyRead))
             continue;
+
+        if (fd == _socket)
+        {
+            _acceptNewConnection();
+            continue;
+        }
+        if (fd == _wakeFd)
+        {
+            _runPostedTasks();
+            continue;
+        }
+        if (_connection(fd) && !_receiveClientMsg(fd))
+            _clearClient(fd);
+    }
+}
+
+void Server::_pollEpoll(int timeoutMs)
+{
+    int nbEvents =
+        epoll_wait(_epollFd, _events.data(), static_cast<int>(_events.size()), timeoutMs);
+
+    if (nbEvents <= 0)
+    {
+        if (nbEvents < 0 && errno != EINTR)
+            std::cout << "Epoll interrupted, stopping server..." << std::endl;
+        _running = false;
+        return;
+    }
+
+    for (int i = 0; i < nbEvents; i++)
+    {
+        int fd = _events[i].data.fd;
+
+        if (fd == _socket)
+        {
+            // Edge-triggered: vider la file d'attente du listen
+            while (_acceptNewConnection())
+                ;
+            continue;
+        }
+        if (fd == _wakeFd)
+        {
+            _runPostedTasks();
+            continue;
+        }
+
+        // Evenement d'un fd ferme pendant ce tour
+        Connection* connection = _connection(fd);
+        if (!connection)
+            continue;
+
+        uint32_t events = _events[i].events;
+        if ((events & EPOLLOUT) && !connection->outbox.empty())
+            _flushClient(fd, connection->outbox.congested());
+
+        if (!(events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)))
+            continue;
+
+        // recv() est appele avant de traiter EPOLLRDHUP pour ne pas perdre les derniers octets
+        if (!_receiveClientMsg(fd) || (events & (EPOLLERR | EPOLLHUP)))
+            _clearClient(fd);
+    }
+}
+
+/**
+ * @brief Serve this server from a shared EventLoop (epoll backend only), before or after start().
+ * @details update() keeps working but is no longer needed: the loop handles accepts, receptions
+ * and dispatch as soon as the server's epoll instance reports events.
+ * @throws std::invalid_argument with the select or io_uring backend
+ */
+void Server::attach(EventLoop& loop)
+{
+    if (_backend != Backend::EPOLL)
+        throw std::invalid_argument("Server::attach() requires the epoll backend");
+
+    if (_loop && _epollFd >= 0)
+        _loop->remove(_epollFd);
+    _loop = &loop;
+    if (_epollFd >= 0)
+        _watchLoop();
+    _scheduleIdleTick();
+}
+
+// Une instance epoll est elle-meme lisible quand elle a des evenements en attente
+void Server::_watchLoop()
+{
+    _loop->add(_epollFd, EPOLLIN, [this](uint32_t) { _onLoopEvent(); });
+}
+
+void Server::_onLoopEvent()
+{
+    _closeFailedClients();
+    _resumeThrottled();
+    _pollEpoll(0);
+    _dispatch(0);
+    _stopIfRequested();
+}
+
+void Server::_pollUring(int timeoutMs)
+{
+    int result = _uring->wait(timeoutMs);
+
+    bool                handled = false;
+    IoUring::Completion completion;
+    while (_uring && _uring->next(completion))
+    {
+        handled = true;
+        _handleUringCompletion(completion);
+    }
+
+    if (!handled)
+    {
+        if (result < 0 && result != -ETIME && result != -EINTR)
+            std::cout << "io_uring interrupted, stopping server..." << std::endl;
+        _running = false;
+    }
+}
+
+void Server::_handleUringCompletion(const IoUring::Completion& completion)
+{
+    UringEvent event    = static_cast<UringEvent>(completion.userData >> 56);
+    long long  clientId = static_cast<long long>(completion.userData & URING_ID_MASK);
+
+    if (event == URING_ACCEPT)
+    {
+        if (completion.result >= 0)
+            _registerConnection(completion.result);
+        if (!completion.more() && _socket >= 0)
+            _uring->acceptMultishot(_socket, uringTag(URING_ACCEPT, 0));
+        return;
+    }
+    if (event == URING_CANCEL)
+        return;
+    if (event == URING_WAKE)
+    {
+        _runPostedTasks();
+        if (!completion.more() && _uring && _wakeFd >= 0)
+            _uring->pollMultishot(_wakeFd, uringTag(URING_WAKE, 0));
+        return;
+    }
+
+    // Connexion visee, si elle est toujours ouverte (et pas remplacee sur le meme fd)
+    int         fd         = static_cast<int>(clientId & ((1LL << CONNECTION_SLOT_BITS) - 1));
+    Connection* connection = _connection(fd);
+    if (connection && static_cast<long long>(connection->id & URING_ID_MASK) != clientId)
+        connection = nullptr;
+
+    if (event == URING_POLLOUT)
+    {
+        if (!connection)
+            return;
+        connection->pollOut = false;
+        _flushClient(fd, connection->outbox.congested());
+        return;
+    }
+
+    // URING_RECV: le buffer fourni est recopie dans le FrameBuffer puis rendu au noyau
+    bool malformed = false;
+    if (completion.hasBuffer())
+    {
+        if (connection && completion.result > 0)
+        {
+            connection->inbox.append(_uring->buffer(completion.bufferId()), completion.result);
+            _stats.read(completion.result);
+            _touch(fd, *connection);
+            malformed = !_extractFrames(fd, connection->inbox);
+
+            // Octets deja recus: comptes quitte a endetter la connexion, ralentie ensuite
+            connection->limiter.bytes.consume(completion.result);
+            if (!malformed && connection->limiter.bytes.allowance(1) == 0)
+                _throttle(fd, *connection);
         }
+        _uring->recycle(completion.bufferId());
+    }
+
+    // Annulee par _throttle(): _resumeThrottled() la rearmera
+    if (!connection || completion.result == -ECANCELED)
+        return;
+    if (malformed || completion.result == 0 ||
+        (completion.result < 0 && completion.result != -ENOBUFS))
+        return _clearClient(fd);
+
+    // Plus de buffer libre, ou requete terminee par le noyau: on la rearme
+    if (!completion.more() && !connection->limiter.throttled)
+        _uring->recvMultishot(fd, uringTag(URING_RECV, clientId));
+}
+
+void Server::_runPostedTasks()
+{
+    uint64_t count;
+    while (read(_wakeFd, &count, sizeof(count)) > 0)
+        ;
+
+    std::function<void()> task;
+    while (_posted.try_pop_front(task))
+        task();
+}
+
+/**
+ * @brief Queue a task to be run by the thread calling update().
+ * @details Thread-safe. Wakes up the server if it is currently waiting for network events,
+ * tasks posted while no update() is running are executed by the next one.
+ */
+void Server::post(const std::function<void()>& task)
+{
+    _posted.push_back(task);
+
+    uint64_t one = 1;
+    if (_wakeFd >= 0 && write(_wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        perror("Failed to wake up server");
+}
+
+/**
+ * @brief Receive and dispatch messages until the network is idle or the budget is spent.
+ * @param maxMessages Maximum number of messages dispatched (0: no limit)
+ * @param maxDuration Maximum time spent in update() (0: no limit), checked after each handler
+ * @return Number of messages dispatched
+ */
+size_t Server::update(size_t maxMessages, std::chrono::milliseconds maxDuration)
+{
+    if (_socket < 0)
+        return 0;
+
+    _closeFailedClients();
+    if (_stopIfRequested())
+        return 0;
+
+    using Clock                  = std::chrono::steady_clock;
+    Clock::time_point deadline   = maxDuration.count() > 0 ? Clock::now() + maxDuration
+                                                           : Clock::time_point::max();
+    size_t            dispatched = 0;
+
+    _running = true;
+    while (true)
+    {
+        // Les messages deja recus passent avant toute nouvelle lecture
+        _resumeThrottled();
+        _expireIdle();
+        dispatched += _dispatch(maxMessages > 0 ? maxMessages - dispatched : 0, deadline);
+        if (!_running || _stopRequested || (maxMessages > 0 && dispatched >= maxMessages))
+            break;
+
+        int timeoutMs = POLL_TIMEOUT_MS;
+        if (maxDuration.count() > 0)
+        {
+            auto remaining = deadline - Clock::now();
+            if (remaining <= Clock::duration::zero())
+                break;
+            // Arrondi au superieur: une attente de 0 ms ferait tourner la boucle a vide
+            auto remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                remaining + std::chrono::milliseconds(1) - Clock::duration(1));
+            if (remainingMs.count() < timeoutMs)
+                timeoutMs = static_cast<int>(remainingMs.count());
+        }
+
+        if (_backend == Backend::EPOLL)
+            _pollEpoll(timeoutMs);
+        else if (_backend == Backend::IO_URING)
+            _pollUring(timeoutMs);
+        else
+            _pollSelect(timeoutMs);
+    }
+    _stopIfRequested();
+    return dispatched;
+}
+
+/**
+ * @brief Call the handlers of the received messages, at most maxMessages of them (0: all).
+ * @details Connections are served in the order their messages arrived. When the budget runs out,
+ *          or a handler returns past the deadline, the remaining frames stay in their FrameBuffer
+ *          and their connections at the front of _readyInboxes for the next call.
+ */
+size_t Server::_dispatch(size_t maxMessages, std::chrono::steady_clock::time_point deadline)
+{
+    // Les handlers lisent directement dans les buffers de reception: les connexions dont l'envoi
+    // echoue ne sont fermees qu'apres la distribution (voir _afterSend)
+    _corked      = true;
+    _dispatching = true;
+    bool   bounded    = deadline != std::chrono::steady_clock::time_point::max();
+    bool   late       = false;
+    size_t dispatched = 0;
+    size_t next       = 0;
+    for (; next < _readyInboxes.size() && !late; next++)
+    {
+        if (maxMessages > 0 && dispatched >= maxMessages)
+            break;
 
-        for (int fd = 0; fd <= _max_fd; fd++)
+        int         fd         = _readyInboxes[next];
+        Connection* connection = _connection(fd);
+        if (!connection)
+            continue;
+
+        // Connexion ralentie: _resumeThrottled() la remettra dans _readyInboxes
+        RateLimiter& limiter = connection->limiter;
+        if (limiter.throttled)
+            continue;
+
+        FrameBuffer& inbox  = connection->inbox;
+        const auto&  frames = inbox.frames();
+        size_t       count  = frames.size();
+        if (maxMessages > 0 && count > maxMessages - dispatched)
+            count = maxMessages - dispatched;
+
+        // Debit de messages epuise: le reste attend que le seau se remplisse
+        size_t allowed = limiter.messages.allowance(count);
+        bool   timing  = _stats.timing();
+        size_t handled = 0;
+        for (; handled < allowed && !_stopRequested && !late; handled++)
         {
-            if (!FD_ISSET(fd, &_readyRead))
+            const FrameBuffer::Frame& frame = frames[handled];
+            _stats.dispatched(frame.type, frame.size);
+            auto it = _tasks.find(frame.type);
+            if (it == _tasks.end())
                 continue;
 
-            if (fd == _socket)
+            long long clientId = frame.channel == 0
+                                     ? connection->id
+                                     : _sessionId(fd, frame.channel);
+
+            NetStats::Clock::time_point start;
+            if (timing)
             {
-                _acceptNewConnection();
-                continue;
+                start = NetStats::Clock::now();
+                _stats.dispatchDelay(start - connection->receivedAt);
             }
-            if (!_receiveClientMsg(fd))
+            try
             {
-                auto clientIt = _clients.find(fd);
-                if (clientIt != _clients.end())
+                if (_pool)
+                    _dispatchToPool(clientId, it->second, inbox.view(frame, fd), timing);
+                else
                 {
-                    _clearClient(fd);
+                    it->second(clientId, inbox.view(frame, fd));
+                    if (timing)
+                        _stats.handlerTime(NetStats::Clock::now() - start);
                 }
-                _partialMsgs.erase(fd);
             }
+            catch (...)
+            {
+                // La frame fautive compte comme traitee: la rejouer leverait encore
+                dispatched += handled + 1;
+                limiter.messages.consume(handled + 1);
+                inbox.release(handled + 1);
+                _readyInboxes.erase(_readyInboxes.begin(), _readyInboxes.begin() + next);
+                _endDispatch();
+                throw;
+            }
+            late = bounded && std::chrono::steady_clock::now() >= deadline;
+        }
+        dispatched += handled;
+        limiter.messages.consume(handled);
+        inbox.release(handled);
+
+        // stop() appele par un handler: update() arrete le serveur apres la distribution
+        if (_stopRequested)
+            break;
+        // Hors delai au milieu de cette connexion: elle reprendra en premier
+        if (handled < allowed)
+            break;
+        if (allowed < count)
+        {
+            _throttle(fd, *connection);
+            continue;
         }
+
+        // Budget epuise au milieu de cette connexion: elle reprendra en premier
+        if (!inbox.frames().empty())
+            break;
     }
+    _readyInboxes.erase(_readyInboxes.begin(), _readyInboxes.begin() + next);
+
+    _endDispatch();
+    return dispatched;
+}
 
-    for (size_t i = 0; i < _msgs.size(); i++)
+// Fin de _dispatch(), aussi quand un handler leve une exception: sinon stop() resterait differe
+void Server::_endDispatch()
+{
+    // Les reponses accumulees partent en un sendmsg() par client
+    _corked      = false;
+    _dispatching = false;
+    for (int fd : _corkedFds)
     {
-        auto it = _tasks.find(_msgs[i].type());
+        Connection* connection = _connection(fd);
+        if (connection)
+            _flushClient(fd, connection->outbox.congested());
+    }
+    _corkedFds.clear();
 
-        if (it == _tasks.end())
-            continue;
+    _closeFailedClients();
+}
 
-        auto it2 = _clients.find(_msgs[i].getFd());
-        if (it2 == _clients.end())
-            continue;
+/**
+ * @brief Client ID of a logical channel of the connection, created on its first frame.
+ * @details Channel IDs carry the fd of their connection and a generation from the same sequence
+ *          as connection IDs (which keeps the stride of a ReactorServer), so they are never
+ *          reused while the server runs.
+ * @return -1 if the connection already has setMaxChannels() channels
+ */
+long long Server::_sessionId(int fd, uint64_t channel)
+{
+    Connection& connection = _connections[fd];
+    auto        channelIt  = connection.channels.find(channel);
+    if (channelIt != connection.channels.end())
+        return channelIt->second;
+    if (_maxChannels > 0 && connection.channels.size() >= _maxChannels)
+        return -1;
 
-        long long clientId = it2->second;
+    long long id = (_next_id << CONNECTION_SLOT_BITS) | fd;
+    _next_id += _idStride;
+    connection.channels[channel] = id;
+    connection.sessions[id]      = channel;
+    return id;
+}
 
-        it->second(clientId, _msgs[i]);
+/**
+ * @brief Run handlers on a WorkerPool instead of the thread calling update().
+ * @param pool Pool to use, or nullptr to go back to inline dispatch. Must outlive the server.
+ */
+void Server::setWorkerPool(WorkerPool* pool)
+{
+    _pool = pool;
+}
+
+bool Server::_onWorker() const
+{
+    return tlsWorkerOf == this;
+}
+
+// Compte les strands confiees au pool: decremente aussi si le pool detruit la tache sans la lancer.
+// Notifie sous le verrou: stop() ne peut pas rendre la main (et le serveur disparaitre) avant
+struct StrandGuard
+{
+    std::atomic<size_t>&     running;
+    std::mutex&              mutex;
+    std::condition_variable& done;
+    ~StrandGuard()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--running == 0)
+            done.notify_all();
     }
-    _msgs.clear();
+};
+
+void Server::_dispatchToPool(long long                                                  clientId,
+                             const std::function<void(long long&, const MessageView&)>& handler,
+                             const MessageView&                                         msg,
+                             bool                                                       timing)
+{
+    // La vue pointe dans le buffer de reception, libere apres la distribution: on copie
+    std::vector<unsigned char> payload(msg.data(), msg.data() + msg.size());
+    Message::Type              type          = msg.type();
+    int                        fd            = msg.getFd();
+    uint64_t                   correlationId = msg.correlationId();
+
+    std::shared_ptr<Strand>& strand = _strands[clientId];
+    if (!strand)
+        strand = std::make_shared<Strand>();
+
+    {
+        std::lock_guard<std::mutex> lock(strand->mutex);
+        strand->jobs.push_back(
+            [handler, clientId, type, fd, correlationId, payload = std::move(payload),
+             stats = timing ? &_stats : nullptr]()
+            {
+                long long   id = clientId;
+                MessageView msg(type, payload.data(), payload.size(), fd, correlationId);
+                if (!stats)
+                    return handler(id, msg);
+
+                NetStats::Clock::time_point start = NetStats::Clock::now();
+                handler(id, msg);
+                stats->handlerTime(NetStats::Clock::now() - start);
+            });
+        if (strand->scheduled)
+            return;
+        strand->scheduled = true;
+    }
+
+    _runningStrands++;
+    std::shared_ptr<StrandGuard> guard(
+        new StrandGuard{_runningStrands, _strandsMutex, _strandsDone});
+    _pool->addJob([this, strand, guard]() { _runStrand(*strand); });
+}
+
+void Server::_runStrand(Strand& strand)
+{
+    tlsWorkerOf = this;
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::lock_guard<std::mutex> lock(strand.mutex);
+            if (strand.jobs.empty())
+            {
+                strand.scheduled = false;
+                break;
+            }
+            job = std::move(strand.jobs.front());
+            strand.jobs.pop_front();
+        }
+
+        // Une exception ne doit ni tuer le worker ni bloquer les messages suivants du client
+        try
+        {
+            job();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Handler failed: " << e.what() << std::endl;
+        }
+    }
+    tlsWorkerOf = nullptr;
 }
 
 void Server::_clearAll()
 {
-    _clients.clear();
-    _clientsToFd.clear();
-    _partialMsgs.clear();
-    _msgs.clear();
+    for (const Connection& connection : _connections)
+    {
+        if (connection.id < 0)
+            continue;
+        _stats.queued(connection.statsQueued, 0);
+        _stats.disconnected();
+    }
+    _connections.clear();
+    _nbConnections = 0;
+    _readyInboxes.clear();
+    _closing.clear();
+    _corkedFds.clear();
+    _strands.clear();
+    _throttled.clear();
+    _idleTimers.clear();
     FD_ZERO(&_active);
+    FD_ZERO(&_activeWrite);
 }
 
 void Server::_clearClient(int& fd)
 {
-    auto clientIt = _clients.find(fd);
-    if (clientIt == _clients.end())
-    {
+    Connection* connection = _connection(fd);
+    if (!connection)
         return;
-    }
 
-    long long clientId = clientIt->second;
     if (fd > 2)
     {
+        if (_backend == Backend::EPOLL)
+            epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+        else if (_backend == Backend::IO_URING)
+        {
+            // La requete recv garde une reference sur la socket: shutdown() la termine
+            shutdown(fd, SHUT_RDWR);
+        }
+        else
+        {
+            FD_CLR(fd, &_active);
+            FD_CLR(fd, &_activeWrite);
+        }
         close(fd);
-        FD_CLR(fd, &_active);
     }
 
-    _clients.erase(fd);
-    _clientsToFd.erase(clientId);
-    _partialMsgs.erase(fd);
+    // Les sessions des canaux disparaissent avec leur connexion
+    for (auto& [sessionId, channel] : connection->sessions)
+        _strands.erase(sessionId);
+    _strands.erase(connection->id);
+
+    _stats.queued(connection->statsQueued, 0);
+    _stats.disconnected();
+
+    // L'emplacement est libere avec ses buffers: un client ID perime n'y trouve plus rien
+    *connection = Connection();
+    _nbConnections--;
+    _throttled.erase(std::remove(_throttled.begin(), _throttled.end(), fd), _throttled.end());
+    _idleTimers.cancel(fd);
+}
+
+// stop() appele depuis un handler du pool: execute par le thread d'update() ou de l'EventLoop
+bool Server::_stopIfRequested()
+{
+    if (!_stopRequested)
+        return false;
+    stop();
+    return true;
 }
 
 void Server::stop()
 {
-    _running = false;
+    // Depuis un worker, attendre les strands reviendrait a attendre ce handler lui-meme
+    if (_onWorker())
+    {
+        _stopRequested = true;
+        _running       = false;
+        return post([]() {});
+    }
+    // Depuis un handler inline, _dispatch() lit encore les buffers que _clearAll() libererait
+    if (_dispatching)
+    {
+        _stopRequested = true;
+        _running       = false;
+        return;
+    }
+    _stopRequested = false;
+    _running       = false;
+
+    // Les handlers en cours sur le pool peuvent encore appeler post()
+    {
+        std::unique_lock<std::mutex> lock(_strandsMutex);
+        _strandsDone.wait(lock, [this]() { return _runningStrands == 0; });
+    }
+
+    // Avant de fermer les sockets: les requetes en cours en gardent une reference
+    _uring.reset();
     if (_socket >= 0)
     {
         std::cout << "Closing server socket." << std::endl;
@@ -266,16 +1580,41 @@ void Server::stop()
         _socket = -1;
     }
 
-    for (auto& [fd, clientId] : _clients)
+    for (size_t fd = 3; fd < _connections.size(); fd++)
     {
-        if (fd <= 2)
-        {
+        if (_connections[fd].id < 0)
             continue;
-        }
 
         close(fd);
-        FD_CLR(fd, &_active);
+        if (_backend == Backend::SELECT)
+            FD_CLR(fd, &_active);
+    }
+
+    if (_loop && _resumeTimer != 0)
+        _loop->cancelTimer(_resumeTimer);
+    _resumeTimer = 0;
+    if (_loop && _idleTick != 0)
+        _loop->cancelTimer(_idleTick);
+    _idleTick = 0;
+
+    if (_epollFd >= 0)
+    {
+        if (_loop)
+            _loop->remove(_epollFd);
+        close(_epollFd);
+        _epollFd = -1;
+    }
+
+    if (_wakeFd >= 0)
+    {
+        close(_wakeFd);
+        _wakeFd = -1;
     }
 
     _clearAll();
+}
+
+Server::Backend Server::backend() const
+{
+    return _backend;
 }
\ No newline at end of file
@@ -2,40 +2,129 @@
 #define SERVER_HPP
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
+#include <vector>
 
-#define NB_CONNECTION    1000
-#define READ_BUFFER_SIZE 4096
+#define NB_CONNECTION       1000
+#define NB_CONNECTION_EPOLL 65536
+#define EPOLL_MAX_EVENTS    1024
+#define READ_BUFFER_SIZE    4096
+#define POLL_TIMEOUT_MS     10       // Attente maximale d'un tour de poll sans evenement
+#define CORK_MAX_SIZE       1024     // Au-dela, copier en file coute plus que l'appel systeme evite
+#define MAX_FRAME_SIZE      16777216 // 16 MB: payload max annonce par un client
+#define MAX_CHANNELS        1024     // Sessions ouvertes par une meme connexion
+#define IDLE_TIMER_TICK_MS  50       // Resolution des delais d'inactivite et des pings
 
+#define CONNECTION_SLOT_BITS 24 // Bits de poids faible d'un client ID: le fd de sa connexion
+
+#include "../../thread/lock_free_queue/lock_free_queue.hpp"
+#include "../../thread/worker_pool/worker_pool.hpp"
+#include "../event_loop/event_loop.hpp"
+#include "../frame_buffer/frame_buffer.hpp"
+#include "../io_uring/io_uring.hpp"
 #include "../message/message.hpp"
+#include "../message_view/message_view.hpp"
+#include "../net_stats/net_stats.hpp"
+#include "../output_queue/output_queue.hpp"
+#include "../timer_wheel/timer_wheel.hpp"
+#include "../token_bucket/token_bucket.hpp"
 
 /**
- * @brief Basic TCP server class using POSIX sockets and select() for multi-client communication.
+ * @brief Basic TCP server class using POSIX sockets and select(), epoll or io_uring for
+ * multi-client communication.
  *
  * This class provides a robust TCP server implementation that can handle multiple simultaneous
- * client connections using select() for non-blocking I/O operations. It supports message-based
- * communication with callback functions for different message types.
+ * client connections with non-blocking I/O, through the backend given to the constructor. It
+ * supports message-based communication with callback functions for different message types.
+ *
+ * The I/O backend is chosen at construction:
+ * - Backend::SELECT (default) scans every fd up to the highest one on each wakeup.
+ * - Backend::EPOLL uses an edge-triggered epoll instance and only touches ready sockets, so the
+ *   cost of update() does not grow with the number of idle connections.
+ * - Backend::IO_URING (Linux, see IoUring::available()) keeps a multishot accept and one
+ *   multishot recv per connection armed in an io_uring: data arrives in provided buffers and a
+ *   whole round of events costs a single io_uring_enter(), whatever the number of connections.
  *
  * @note Handles connections, disconnections, sending and receiving messages automatically
  * @note Uses Message class for structured message format and parsing
- * @note Limited by maximum simultaneous connections (NB_CONNECTION = 1000)
- * @note Limited by maximum bytes that can be read at once (READ_BUFFER_SIZE = 100000)
+ * @note Received messages are never copied: handlers get a MessageView into the receive buffer
+ *       of the connection (handlers taking a const Message& receive a copy instead)
+ * @note Sockets are non-blocking: what a client cannot receive right away is kept in its output
+ *       queue and sent when the socket becomes writable, a slow reader never stalls update().
+ *       sendTo() hands the message header and payload to sendmsg() without serializing them;
+ *       small replies (up to CORK_MAX_SIZE bytes) sent from handlers are queued and flushed once
+ *       per client after the dispatch, so a burst of them costs one system call.
+ *       The backpressure action is called when a client's queue crosses the high water mark
+ *       (congested = true) and when it drains back to the low water mark (congested = false)
+ * @note Limited by maximum simultaneous connections (NB_CONNECTION = 1000 with select,
+ *       NB_CONNECTION_EPOLL = 65536 with epoll, and by the process fd limit)
+ * @note Limited by maximum bytes that can be read at once (READ_BUFFER_SIZE = 4096)
+ * @note Each connection starts with the LEGACY wire format. When a client asks for another one
+ *       (Client::setWireFormat()), the server acknowledges it and uses it for everything it
+ *       sends to that client afterwards. Broadcasts share the payload between formats. A
+ *       malformed header closes the connection
+ * @note update() alternates network polling and dispatch until no event arrives for
+ *       POLL_TIMEOUT_MS, so it returns even under continuous load once its budget is spent:
+ *       maxMessages handlers called and/or maxDuration elapsed (0 means no limit). Messages left
+ *       over stay in their connection buffer and are dispatched first by the next update(),
+ *       before any new read: the data buffered per connection stays bounded and TCP pushes
+ *       back on clients that send faster than the budget allows.
+ * @note With Backend::EPOLL, attach() registers the server in a shared EventLoop: its epoll
+ *       instance is watched by the loop, and the events of a round are handled and dispatched
+ *       from the loop thread. One thread and one blocking wait then serve the server and any
+ *       attached Client or ClientPool. The loop must outlive the server
+ * @note A connection can carry several logical sessions (see ClientPool): frames tagged with a
+ *       channel are dispatched under their own client ID, created on the first frame of that
+ *       channel, with its own handler ordering. sendTo() and reply() route back to the channel,
+ *       and sendToAll() reaches every session. Sessions end with their connection. A client
+ *       opening more than setMaxChannels() channels (MAX_CHANNELS by default) is disconnected.
+ * @note Flood protection: a client announcing a payload larger than setMaxFrameSize()
+ *       (MAX_FRAME_SIZE by default) is disconnected as soon as the header is parsed, before
+ *       anything is buffered for it. setRateLimit() gives each connection a token bucket for
+ *       bytes and one for messages: a connection that runs out is throttled, its socket is no
+ *       longer read (TCP pushes back on the client) and its remaining messages wait, until the
+ *       buckets refill. Other connections are served as usual, so a flooding client cannot
+ *       inflate their latency. metrics() counts throttled and dropped clients. Limits apply
+ *       per connection, the sessions of a ClientPool share them.
+ * @note Connection state (receive buffer, output queue, rate limits, sessions) lives in a table
+ *       indexed by fd. A client ID carries the fd of its connection in its low
+ *       CONNECTION_SLOT_BITS bits and a generation above them, taken from a sequence that is never
+ *       reused: finding a client is one array index, and the ID of a closed client does not match
+ *       the connection that later gets the same fd. Client IDs are opaque, only compare them.
+ * @note setIdleTimeout() disconnects clients that send nothing for a while, and can ping them
+ *       first (a Client answers the ping from its update()). Deadlines live in a TimerWheel keyed
+ *       by fd: receiving data only stores a timestamp, and the timer of a connection compares it
+ *       when it fires, so neither reads nor ticks scan the connections.
+ * @note stats() counts bytes, reads, frames per type and queued output, updated by the network
+ *       thread without locks and readable from any thread (see NetStats). With
+ *       stats().setTiming(true) it also records how long messages waited before their handler
+ *       and how long handlers took, including handlers run on a WorkerPool.
  *
  * @code
- * // Create and start server
+ * // Create and start server (Server::Backend::EPOLL for many connections)
  * Server server("127.0.0.1", 8080);
  * server.start();
  *
  * // Define message handler for specific message type
- * server.defineAction(1001, [](long long& clientID, const Message& msg) {
+ * server.defineAction(1001, [](long long& clientID, const MessageView& msg) {
  *     std::string request;
  *     msg >> request;
  *     std::cout << "Client " << clientID << " says: " << request << std::endl;
@@ -46,59 +135,274 @@
  *     server.sendTo(response, clientID);
  * });
  *
+ * // Answer a Client::call(): the response carries the correlation id of the request
+ * server.defineAction(1003, [&server](long long& clientID, const MessageView& request) {
+ *     Message response(1004);
+ *     response << 42;
+ *     server.reply(clientID, request, response);
+ * });
+ *
+ * // Flood protection: 64 KB per message, 1 MB/s and 1000 messages/s per connection
+ * server.setMaxFrameSize(65536);
+ * server.setRateLimit(1024 * 1024, 1000);
+ *
+ * // Ping clients quiet for 10 s, disconnect them after 30 s of silence
+ * server.setIdleTimeout(std::chrono::seconds(30), std::chrono::seconds(10));
+ *
  * // Main server loop
  * while (running) {
  *     server.update(); // Process incoming connections and messages
  * }
  *
+ * // Game loop: at most 500 messages and 5 ms of network work per frame
+ * while (running) {
+ *     server.update(500, std::chrono::milliseconds(5));
+ *     simulate();
+ * }
+ *
  * server.stop();
  * @endcode
  *
+ * @note post() is the only thread-safe method: it queues a task that will run on the thread
+ *       calling update(), and wakes that thread up if it is waiting for network events.
+ * @note With setWorkerPool(), handlers run on the pool instead of inside update(): each message
+ *       is copied, and each client has its own serial queue, so messages of one client are still
+ *       handled one at a time and in order. sendTo(), sendToArray() and sendToAll() called from
+ *       such a handler are handed back to the update() thread through a lock-free queue.
+ *       stop() waits for the handlers already started: the pool must outlive the server.
+ *       Called from such a handler, stop() cannot wait for itself: it returns at once and the
+ *       thread running update() (or the EventLoop) stops the server at its next round.
+ * @note stop() called from a handler run inside update() is deferred until that handler returns:
+ *       no other handler is called, and update() then stops the server.
+ *
  * @throws std::runtime_error on network errors (bind, listen, accept failures)
+ * @throws Whatever an inline handler throws, out of update(): the messages handled so far,
+ *         the throwing one included, are not handled again and their replies are sent
  * @see Message for message format and usage
  * @see Client for corresponding client implementation
+ * @see ReactorServer to spread connections over several threads
  */
 class Server
 {
+    friend class ReactorServer;
+
+public:
+    enum class Backend
+    {
+        SELECT,
+        EPOLL,
+        IO_URING
+    };
+
+    // Compteurs de la protection contre les abus (voir metrics())
+    struct Metrics
+    {
+        size_t throttleEvents   = 0; // Passages d'une connexion en mode ralenti
+        size_t throttledClients = 0; // Connexions ralenties en ce moment
+        size_t droppedClients   = 0; // Deconnectees pour un en-tete invalide ou trop grand
+        size_t oversizedFrames  = 0; // Dont frames au-dela de setMaxFrameSize()
+        size_t channelFloods    = 0; // Dont canaux au-dela de setMaxChannels()
+        size_t idleClients      = 0; // Deconnectees par setIdleTimeout()
+        size_t pingsSent        = 0;
+    };
+
 private:
-    int         _socket  = -1;
-    int         _max_fd  = -1;
-    int         _next_id = 0;
-    bool        _running = true;
+    int         _socket    = -1;
+    int         _max_fd    = -1;
+    long long   _next_id   = 0; // Generation de la prochaine connexion ou session
+    long long   _idStride  = 1;
+    bool        _reusePort = false;
     std::string _address;
     size_t      _port;
+    Backend     _backend;
+
+    // Ecrits par stop() depuis un handler du pool, lus par le thread d'update()
+    std::atomic<bool> _running{true};
+    std::atomic<bool> _stopRequested{false};
 
     fd_set _active;
     fd_set _readyRead;
+    fd_set _activeWrite;
+    fd_set _readyWrite;
+
+    int                      _epollFd = -1;
+    std::vector<epoll_event> _events;
+    EventLoop*               _loop = nullptr; // Boucle partagee de attach()
+
+    std::unique_ptr<IoUring> _uring;
+
+    int                                  _wakeFd = -1;
+    LockFreeQueue<std::function<void()>> _posted;
+
+    // File serie d'un client: un seul worker a la fois la vide, dans l'ordre d'arrivee
+    struct Strand
+    {
+        std::mutex                        mutex;
+        std::deque<std::function<void()>> jobs;
+        bool                              scheduled = false;
+    };
+
+    WorkerPool*                                            _pool = nullptr;
+    std::unordered_map<long long, std::shared_ptr<Strand>> _strands;
+    std::atomic<size_t>                                    _runningStrands{0};
+    std::mutex                                             _strandsMutex;
+    std::condition_variable                                _strandsDone; // _runningStrands == 0
 
-    std::unordered_map<int, long long> _clients;
-    std::unordered_map<long long, int> _clientsToFd;
-    std::unordered_map<Message::Type, std::function<void(long long& clientID, const Message& msg)>>
+    std::unordered_map<Message::Type,
+                       std::function<void(long long& clientID, const MessageView& msg)>>
         _tasks;
 
-    std::vector<Message>             _msgs;
-    std::unordered_map<int, Message> _partialMsgs;
+    // Seaux de jetons d'une connexion: octets lus et messages distribues
+    struct RateLimiter
+    {
+        TokenBucket bytes;
+        TokenBucket messages;
+        bool        throttled = false;
+    };
 
-    void _acceptNewConnection();
+    // Etat d'une connexion, range a l'index de son fd dans _connections
+    struct Connection
+    {
+        long long   id = -1; // -1: emplacement libre
+        FrameBuffer inbox;
+        OutputQueue outbox;
+        RateLimiter limiter;
+        bool        pollOut = false; // Requete POLLOUT io_uring en cours
+
+        TimerWheel::Clock::time_point lastActivity; // Derniers octets recus (setIdleTimeout())
+        bool                          pinged = false;
+
+        size_t                      statsQueued = 0; // Part de outbox deja comptee dans _stats
+        NetStats::Clock::time_point receivedAt;      // Arrivee de la plus ancienne frame en attente
+
+        // Sessions ouvertes par les canaux de la connexion (ClientPool), dans les deux sens
+        std::unordered_map<uint64_t, long long> channels;
+        std::unordered_map<long long, uint64_t> sessions;
+    };
+
+    std::vector<Connection> _connections; // Index: fd
+    size_t                  _nbConnections = 0;
+    std::vector<int>        _readyInboxes;
+
+    std::vector<long long> _closing;
+    bool                   _corked      = false;
+    bool                   _dispatching = false; // Un handler inline peut appeler stop()
+    std::vector<int>       _corkedFds;
+    size_t                 _highWaterMark = OUTPUT_HIGH_WATER_MARK;
+    size_t                 _lowWaterMark  = OUTPUT_LOW_WATER_MARK;
+
+    std::function<void(long long& clientID, bool congested)> _backpressureAction;
+
+    size_t                    _maxFrameSize      = MAX_FRAME_SIZE;
+    size_t                    _maxChannels       = MAX_CHANNELS;
+    double                    _bytesPerSecond    = 0;
+    double                    _messagesPerSecond = 0;
+    std::chrono::milliseconds _burst{1000};
+    std::vector<int>          _throttled;
+    EventLoop::TimerId        _resumeTimer = 0;
+    Metrics                   _metrics;
+
+    std::chrono::milliseconds _idleTimeout{0};
+    std::chrono::milliseconds _keepalive{0};
+    TimerWheel                _idleTimers{std::chrono::milliseconds(IDLE_TIMER_TICK_MS)};
+    EventLoop::TimerId        _idleTick = 0;
+
+    NetStats _stats;
+
+    bool _acceptNewConnection();
+    void _registerConnection(int connfd);
     bool _receiveClientMsg(const int& fd);
+    bool _extractFrames(int fd, FrameBuffer& inbox);
+    void _acknowledgeWireFormat(int fd, Message::WireFormat previous);
+
+    void _pollSelect(int timeoutMs);
+    void _pollEpoll(int timeoutMs);
+    void _watchLoop();
+    void _onLoopEvent();
+    void _pollUring(int timeoutMs);
+    void _handleUringCompletion(const IoUring::Completion& completion);
+    void _runPostedTasks();
+    size_t    _dispatch(size_t                                maxMessages,
+                        std::chrono::steady_clock::time_point deadline =
+                            std::chrono::steady_clock::time_point::max());
+    void      _endDispatch();
+    long long _sessionId(int fd, uint64_t channel);
+    void _dispatchToPool(long long clientId,
+                         const std::function<void(long long&, const MessageView&)>& handler,
+                         const MessageView& msg,
+                         bool               timing);
+    void _runStrand(Strand& strand);
+    bool _onWorker() const;
+    bool _stopIfRequested();
+
+    void                _sendTo(const Message& message, long long clientID, uint64_t correlationId);
+    Connection*         _connection(int fd);
+    int                 _clientFd(long long clientID, uint64_t* channel = nullptr) const;
+    Message::WireFormat _wireFormat(int fd) const;
+    void _sendSerialized(const OutputQueue::SharedFrame& frame, long long clientID);
+    void _sendSerializedToAll(const OutputQueue::SharedFrame& frame);
+    void _queueOutput(int fd, const OutputQueue::SharedFrame& frame, uint64_t channel = 0);
+    void _queueOutput(int fd, const iovec* iov, size_t count);
+    void _flushClient(int fd, bool wasCongested);
+    void _afterSend(int fd, bool sent, bool wasCongested);
+    void _notifyBackpressure(int fd, bool wasCongested);
+    void _closeFailedClients();
+
+    RateLimiter _makeLimiter() const;
+    void        _throttle(int fd, Connection& connection);
+    void        _resumeThrottled();
+    void        _scheduleResume();
+
+    void _touch(int fd, Connection& connection);
+    void _armIdleTimer(int fd, const Connection& connection);
+    void _onIdleTimer(size_t fd);
+    void _expireIdle();
+    void _scheduleIdleTick();
 
     void _clearAll();
     void _clearClient(int& fd);
 
 public:
-    Server();
+    Server(Backend backend = Backend::SELECT);
     ~Server();
-    Server(const std::string& address, size_t port);
+    Server(const std::string& address, size_t port, Backend backend = Backend::SELECT);
     void start(const size_t& port = 0);
+    void attach(EventLoop& loop);
 
-    void defineAction(const Message::Type& messageType,
-                      const std::function<void(long long& clientID, const Message& msg)>& action);
+    void defineAction(
+        const Message::Type&                                                    messageType,
+        const std::function<void(long long& clientID, const MessageView& msg)>& action);
 
     void sendTo(const Message& message, long long clientID);
-    void sendToArray(const Message& message, std::vector<long long> clientIDs);
+    void reply(long long clientID, const MessageView& request, const Message& response);
+    void reply(long long clientID, uint64_t correlationId, const Message& response);
+    void sendToArray(const Message& message, const std::vector<long long>& clientIDs);
     void sendToAll(const Message& message);
 
-    void update();
+    void setOutputWaterMarks(size_t highWaterMark, size_t lowWaterMark);
+    void defineBackpressureAction(
+        const std::function<void(long long& clientID, bool congested)>& action);
+    size_t pendingOutput(long long clientID) const;
+
+    void    setMaxFrameSize(size_t maxFrameSize);
+    void    setMaxChannels(size_t maxChannels);
+    void    setRateLimit(double                    bytesPerSecond,
+                         double                    messagesPerSecond,
+                         std::chrono::milliseconds burst = std::chrono::seconds(1));
+    bool    throttled(long long clientID) const;
+    Metrics   metrics() const;
+    NetStats& stats();
+
+    void setIdleTimeout(std::chrono::milliseconds timeout,
+                        std::chrono::milliseconds keepalive = std::chrono::milliseconds::zero());
+
+    size_t update(size_t                    maxMessages = 0,
+                  std::chrono::milliseconds maxDuration = std::chrono::milliseconds::zero());
     void stop();
+
+    void post(const std::function<void()>& task);
+    void setWorkerPool(WorkerPool* pool);
+
+    Backend backend() const;
 };
 #endif
\ No newline at end of file
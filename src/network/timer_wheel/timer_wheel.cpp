@@ -0,0 +1,179 @@
+#include "timer_wheel.hpp"
+
+#define SLOTS_PER_LEVEL (static_cast<size_t>(1) << TIMER_WHEEL_SLOT_BITS)
+#define SLOT_MASK       (SLOTS_PER_LEVEL - 1)
+
+/**
+ * @param tick Resolution of the wheel: deadlines are rounded up to a whole tick.
+ * @param origin Time of tick 0 (advance() before it does nothing).
+ */
+TimerWheel::TimerWheel(std::chrono::milliseconds tick, Clock::time_point origin)
+    : _slots(TIMER_WHEEL_LEVELS * SLOTS_PER_LEVEL, NONE), _origin(origin), _tick(tick)
+{
+    if (tick.count() <= 0)
+        throw std::invalid_argument("TimerWheel: tick must be positive");
+}
+
+uint64_t TimerWheel::_ticksAt(Clock::time_point time) const
+{
+    if (time <= _origin)
+        return 0;
+    return static_cast<uint64_t>((time - _origin) / _tick);
+}
+
+// Roue la plus basse dont la portee couvre l'echeance, case du tick ou elle descendra
+void TimerWheel::_link(size_t key)
+{
+    Node&    node     = _nodes[key];
+    uint64_t delta    = node.deadline > _current ? node.deadline - _current : 0;
+    uint64_t position = node.deadline;
+    size_t   level    = 0;
+
+    while (level + 1 < TIMER_WHEEL_LEVELS &&
+           delta >= (static_cast<uint64_t>(1) << (TIMER_WHEEL_SLOT_BITS * (level + 1))))
+        level++;
+
+    // Au-dela de la derniere roue: garee au plus loin, replacee quand elle tourne
+    uint64_t horizon = static_cast<uint64_t>(1) << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS);
+    if (delta >= horizon)
+        position = _current + horizon - 1;
+
+    size_t slot = level * SLOTS_PER_LEVEL +
+                  ((position >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK);
+    node.slot = slot;
+    node.prev = NONE;
+    node.next = _slots[slot];
+    if (node.next != NONE)
+        _nodes[node.next].prev = key;
+    _slots[slot] = key;
+}
+
+void TimerWheel::_unlink(size_t key)
+{
+    Node& node = _nodes[key];
+    if (node.prev != NONE)
+        _nodes[node.prev].next = node.next;
+    else
+        _slots[node.slot] = node.next;
+    if (node.next != NONE)
+        _nodes[node.next].prev = node.prev;
+
+    node.slot = NONE;
+    node.prev = NONE;
+    node.next = NONE;
+}
+
+// La case de cette roue arrive a echeance: ses timers descendent vers les roues inferieures
+void TimerWheel::_cascade(size_t level)
+{
+    size_t slot =
+        level * SLOTS_PER_LEVEL + ((_current >> (TIMER_WHEEL_SLOT_BITS * level)) & SLOT_MASK);
+    size_t key  = _slots[slot];
+
+    _slots[slot] = NONE;
+    while (key != NONE)
+    {
+        size_t next = _nodes[key].next;
+        _link(key);
+        key = next;
+    }
+}
+
+/**
+ * @brief Arm the timer of key, or move it if it is already armed.
+ * @details A deadline already past fires on the next tick.
+ */
+void TimerWheel::schedule(size_t key, Clock::time_point deadline)
+{
+    if (key >= _nodes.size())
+        _nodes.resize(key + 1);
+
+    if (_nodes[key].slot != NONE)
+        _unlink(key);
+    else
+        _size++;
+
+    // Arrondi au tick superieur: jamais en avance
+    uint64_t ticks = 0;
+    if (deadline > _origin)
+        ticks = static_cast<uint64_t>((deadline - _origin + _tick - Clock::duration(1)) / _tick);
+
+    _nodes[key].deadline = ticks > _current ? ticks : _current + 1;
+    _link(key);
+}
+
+/**
+ * @return false if key had no timer armed
+ */
+bool TimerWheel::cancel(size_t key)
+{
+    if (!scheduled(key))
+        return false;
+
+    _unlink(key);
+    _size--;
+    return true;
+}
+
+bool TimerWheel::scheduled(size_t key) const
+{
+    return key < _nodes.size() && _nodes[key].slot != NONE;
+}
+
+/**
+ * @brief Process the ticks elapsed up to now and call expired(key) for each timer due.
+ * @return Number of timers fired
+ */
+size_t TimerWheel::advance(Clock::time_point now, const std::function<void(size_t key)>& expired)
+{
+    uint64_t target = _ticksAt(now);
+    size_t   fired  = 0;
+
+    while (_current < target)
+    {
+        // Rien d'arme: inutile de faire tourner les roues tick par tick
+        if (_size == 0)
+        {
+            _current = target;
+            break;
+        }
+
+        _current++;
+        for (size_t level = 1; level < TIMER_WHEEL_LEVELS; level++)
+        {
+            uint64_t turn = (static_cast<uint64_t>(1) << (TIMER_WHEEL_SLOT_BITS * level)) - 1;
+            if ((_current & turn) != 0)
+                break;
+            _cascade(level);
+        }
+
+        // Un par un depuis la tete: le callback peut rearmer ou annuler n'importe quelle cle
+        size_t slot = _current & SLOT_MASK;
+        while (_slots[slot] != NONE)
+        {
+            size_t key = _slots[slot];
+            _unlink(key);
+            _size--;
+            fired++;
+            expired(key);
+        }
+    }
+    return fired;
+}
+
+void TimerWheel::clear()
+{
+    _nodes.clear();
+    _slots.assign(_slots.size(), NONE);
+    _size = 0;
+}
+
+size_t TimerWheel::size() const
+{
+    return _size;
+}
+
+std::chrono::milliseconds TimerWheel::tick() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(_tick);
+}
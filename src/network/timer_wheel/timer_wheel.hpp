@@ -0,0 +1,84 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#define TIMER_WHEEL_LEVELS    4 // Roues empilees: 64^4 ticks couverts sans debordement
+#define TIMER_WHEEL_SLOT_BITS 6 // 64 cases par roue
+
+/**
+ * @brief Hierarchical timer wheel: one deadline per key, O(1) to arm, re-arm and cancel.
+ *
+ * Keys are small integers chosen by the caller (a file descriptor, a slot index): each one has
+ * at most one pending deadline, stored in a table indexed by the key and linked into a slot of
+ * one of TIMER_WHEEL_LEVELS wheels of 64 slots. The first wheel counts single ticks, each next
+ * one counts whole turns of the previous. advance() walks the ticks elapsed since its last call:
+ * a tick only touches its own slot, and every 64 ticks the due slot of the next wheel is
+ * cascaded down. The cost is per tick and per expired timer, never per pending timer, so a
+ * hundred thousand idle timeouts cost nothing until they fire.
+ *
+ * A timer never fires early, and at most one tick late. Deadlines further away than 64^4 ticks
+ * are parked in the last wheel and placed again when it turns.
+ *
+ * @code
+ * TimerWheel timeouts(std::chrono::milliseconds(50));
+ *
+ * timeouts.schedule(fd, TimerWheel::Clock::now() + std::chrono::seconds(30));
+ * timeouts.schedule(fd, TimerWheel::Clock::now() + std::chrono::seconds(30)); // re-arm
+ *
+ * // From the event loop, at least once per tick
+ * timeouts.advance(TimerWheel::Clock::now(), [](size_t fd) { closeIdle(fd); });
+ * @endcode
+ *
+ * @note The expired callback may schedule or cancel any key, including its own
+ * @throws std::invalid_argument if the tick is not positive
+ */
+class TimerWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    struct Node
+    {
+        uint64_t deadline = 0;    // En ticks depuis _origin
+        size_t   slot     = NONE; // NONE: pas de timer arme
+        size_t   prev     = NONE;
+        size_t   next     = NONE;
+    };
+
+    std::vector<Node>   _nodes; // Index: cle
+    std::vector<size_t> _slots; // Tete de liste de chaque case, roue par roue
+    Clock::time_point   _origin;
+    Clock::duration     _tick;
+    uint64_t            _current = 0; // Dernier tick traite
+    size_t              _size    = 0;
+
+    uint64_t _ticksAt(Clock::time_point time) const;
+    void     _link(size_t key);
+    void     _unlink(size_t key);
+    void     _cascade(size_t level);
+
+public:
+    explicit TimerWheel(std::chrono::milliseconds tick   = std::chrono::milliseconds(10),
+                        Clock::time_point         origin = Clock::now());
+
+    void   schedule(size_t key, Clock::time_point deadline);
+    bool   cancel(size_t key);
+    bool   scheduled(size_t key) const;
+    size_t advance(Clock::time_point now, const std::function<void(size_t key)>& expired);
+    void   clear();
+
+    size_t                    size() const;
+    std::chrono::milliseconds tick() const;
+};
+
+#endif
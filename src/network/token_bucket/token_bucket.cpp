@@ -0,0 +1,82 @@
+#include "token_bucket.hpp"
+
+/**
+ * @param rate Tokens added per second (0: no limit)
+ * @param capacity Maximum burst, at least one token. The bucket starts full.
+ */
+TokenBucket::TokenBucket(double rate, double capacity)
+    : _rate(rate), _capacity(capacity < 1 ? 1 : capacity), _tokens(_capacity),
+      _last(Clock::now())
+{
+    if (rate < 0 || capacity < 0)
+        throw std::invalid_argument("TokenBucket: rate and capacity must not be negative");
+}
+
+void TokenBucket::_refill(Clock::time_point now)
+{
+    if (now <= _last)
+        return;
+
+    std::chrono::duration<double> elapsed = now - _last;
+    _last                                 = now;
+    _tokens += elapsed.count() * _rate;
+    if (_tokens > _capacity)
+        _tokens = _capacity;
+}
+
+/**
+ * @brief Number of units out of wanted that may go through now (whole tokens only).
+ */
+size_t TokenBucket::allowance(size_t wanted, Clock::time_point now)
+{
+    if (_rate == 0)
+        return wanted;
+
+    _refill(now);
+    if (_tokens < 1)
+        return 0;
+    return _tokens < static_cast<double>(wanted) ? static_cast<size_t>(_tokens) : wanted;
+}
+
+/**
+ * @brief Spend amount tokens, going into debt if there are not enough of them.
+ */
+void TokenBucket::consume(double amount)
+{
+    if (_rate != 0)
+        _tokens -= amount;
+}
+
+/**
+ * @brief Time until amount tokens are available (capped at the capacity), zero if they are.
+ */
+TokenBucket::Clock::duration TokenBucket::delay(double amount, Clock::time_point now)
+{
+    if (_rate == 0)
+        return Clock::duration::zero();
+
+    _refill(now);
+    if (amount > _capacity)
+        amount = _capacity;
+    if (_tokens >= amount)
+        return Clock::duration::zero();
+
+    // Arrondi au superieur: attendre ce delai suffit toujours
+    std::chrono::duration<double> missing((amount - _tokens) / _rate);
+    return std::chrono::duration_cast<Clock::duration>(missing) + Clock::duration(1);
+}
+
+bool TokenBucket::unlimited() const
+{
+    return _rate == 0;
+}
+
+double TokenBucket::rate() const
+{
+    return _rate;
+}
+
+double TokenBucket::capacity() const
+{
+    return _capacity;
+}
@@ -0,0 +1,60 @@
+#ifndef TOKEN_BUCKET_HPP
+#define TOKEN_BUCKET_HPP
+
+#include <stddef.h>
+
+#include <chrono>
+#include <stdexcept>
+
+/**
+ * @brief Token bucket rate limiter: a sustained rate with a bounded burst.
+ *
+ * The bucket holds up to capacity tokens and refills at rate tokens per second. allowance()
+ * tells how many units may go through right now, consume() spends them. Refilling is computed
+ * lazily from the elapsed time: there is no timer and no thread.
+ *
+ * consume() may take more tokens than available: the bucket goes into debt, repaid by the
+ * refill before anything else goes through. This is how bytes that were already received (a
+ * recv() returns what it returns) are still accounted for.
+ *
+ * A bucket with a rate of 0 (default constructed) never runs out: it is the "no limit" value.
+ *
+ * @code
+ * TokenBucket bytes(1024 * 1024, 64 * 1024); // 1 MB/s, bursts of 64 KB
+ *
+ * size_t chunk = bytes.allowance(4096);
+ * if (chunk == 0)
+ *     wait(bytes.delay(4096));
+ * ssize_t received = recv(fd, buffer, chunk, 0);
+ * bytes.consume(received);
+ * @endcode
+ *
+ * @throws std::invalid_argument if the rate or the capacity is negative
+ */
+class TokenBucket
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    double            _rate     = 0; // Jetons par seconde, 0: illimite
+    double            _capacity = 0;
+    double            _tokens   = 0; // Negatif: dette a rembourser
+    Clock::time_point _last;
+
+    void _refill(Clock::time_point now);
+
+public:
+    TokenBucket() = default;
+    TokenBucket(double rate, double capacity);
+
+    size_t          allowance(size_t wanted, Clock::time_point now = Clock::now());
+    void            consume(double amount);
+    Clock::duration delay(double amount, Clock::time_point now = Clock::now());
+
+    bool   unlimited() const;
+    double rate() const;
+    double capacity() const;
+};
+
+#endif
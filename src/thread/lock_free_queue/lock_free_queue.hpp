@@ -0,0 +1,105 @@
+#ifndef LOCK_FREE_QUEUE_HPP
+#define LOCK_FREE_QUEUE_HPP
+
+#include <atomic>
+#include <utility>
+/**
+ * @brief Lock-Free Multi-Producer Single-Consumer Queue
+ *
+ * Any number of threads can push elements concurrently without ever taking a lock: a push is
+ * one allocation and one atomic exchange. A single consumer thread pops them in FIFO order
+ * (per producer). This is the queue to use when many threads hand work to one event loop.
+ *
+ * @note push_back() is safe from any thread; try_pop_front() and empty() must only be called by
+ *       the consumer thread
+ * @note An element pushed concurrently with try_pop_front() may only become visible at the next
+ *       call: consumers should be woken up after the push (eventfd, condition variable...)
+ * @note TType must be default constructible
+ *
+ * @code
+ * LockFreeQueue<std::function<void()>> tasks;
+ *
+ * // Any thread
+ * tasks.push_back([]() { std::cout << "Hello from the loop" << std::endl; });
+ *
+ * // Event loop thread
+ * std::function<void()> task;
+ * while (tasks.try_pop_front(task))
+ *     task();
+ * @endcode
+ */
+template <typename TType>
+class LockFreeQueue
+{
+private:
+    struct Node
+    {
+        std::atomic<Node*> next{nullptr};
+        TType              value;
+    };
+
+    // Les producteurs s'enchainent sur _head, le consommateur avance seul sur _tail
+    std::atomic<Node*> _head;
+    Node*              _tail;
+
+    void _link(Node* node)
+    {
+        Node* previous = _head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+public:
+    LockFreeQueue()
+    {
+        Node* stub = new Node();
+        _head.store(stub, std::memory_order_relaxed);
+        _tail = stub;
+    }
+
+    ~LockFreeQueue()
+    {
+        while (_tail)
+        {
+            Node* next = _tail->next.load(std::memory_order_relaxed);
+            delete _tail;
+            _tail = next;
+        }
+    }
+
+    LockFreeQueue(const LockFreeQueue&)            = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    void push_back(const TType& newElement)
+    {
+        Node* node  = new Node();
+        node->value = newElement;
+        _link(node);
+    }
+
+    void push_back(TType&& newElement)
+    {
+        Node* node  = new Node();
+        node->value = std::move(newElement);
+        _link(node);
+    }
+
+    bool try_pop_front(TType& value)
+    {
+        Node* next = _tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+
+        // Le noeud suivant devient la nouvelle sentinelle
+        value = std::move(next->value);
+        delete _tail;
+        _tail = next;
+        return true;
+    }
+
+    bool empty() const
+    {
+        return _tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <mutex>
 #include <queue>
+#include <stdexcept>
 /**
  * @brief Thread-Safe Queue
  *
@@ -17,6 +18,11 @@
  * ThreadSafeQueue<int> queue;
  * queue.push_back(1);
  * int value = queue.pop_front();
+ *
+ * // Non-throwing variant for consumers polling the queue
+ * int next;
+ * while (queue.try_pop_front(next))
+ *     process(next);
  * @endcode
  */
 template <typename TType>
@@ -62,5 +68,17 @@ public:
         _queue.pop_front();
         return value;
     }
+
+    bool try_pop_front(TType& value)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_queue.empty())
+            return false;
+
+        value = std::move(_queue.front());
+        _queue.pop_front();
+        return true;
+    }
 };
 #endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef THREADING_HPP
 #define THREADING_HPP
 
+#include "lock_free_queue/lock_free_queue.hpp"
 #include "persistent_worker/persistent_worker.hpp"
 #include "thread/thread.hpp"
 #include "thread_safe_iostream/thread_safe_iostream.hpp"
@@ -0,0 +1,129 @@
+#include <signal.h>
+#include <time.h>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Compare une diffusion faite client par client (une serialisation par sendTo) et
+// sendToAll (une seule serialisation partagee par toutes les files de sortie).
+// Seul le temps CPU du thread serveur est mesure; les clients sont vides hors mesure.
+
+static const size_t BENCH_PORT   = 18550;
+static const size_t PAYLOAD_SIZE = 1024;
+static const int    ROUNDS       = 20;
+
+static double threadCpuMicroseconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int openConnection(size_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void drain(const std::vector<int>& fds)
+{
+    unsigned char buffer[65536];
+    for (int fd : fds)
+        while (recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) > 0)
+            ;
+}
+
+struct Result
+{
+    double perClientUs;
+    double sharedUs;
+    size_t clients;
+};
+
+static Result benchFanOut(size_t nbClients, size_t port)
+{
+    Server server("127.0.0.1", port, Server::Backend::EPOLL);
+
+    // Chaque connexion s'annonce: le handler releve son identifiant
+    std::vector<long long> ids;
+    server.defineAction(1, [&ids](long long& clientID, const MessageView&)
+                        { ids.push_back(clientID); });
+    server.start();
+
+    std::vector<unsigned char> hello = Message(1).getSerializedData();
+    std::vector<int>           fds;
+    for (size_t i = 0; i < nbClients; i++)
+    {
+        int fd = openConnection(port);
+        if (fd < 0)
+            break;
+        fds.push_back(fd);
+        if (send(fd, hello.data(), hello.size(), 0) < 0)
+            break;
+        if (i % 64 == 63)
+            server.update();
+    }
+    server.update();
+
+    Message msg(1);
+    msg.appendBytes(std::vector<unsigned char>(PAYLOAD_SIZE, 'x').data(), PAYLOAD_SIZE);
+
+    double perClient = 0;
+    double shared    = 0;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        double start = threadCpuMicroseconds();
+        for (long long id : ids)
+            server.sendTo(msg, id);
+        perClient += threadCpuMicroseconds() - start;
+        drain(fds);
+
+        start = threadCpuMicroseconds();
+        server.sendToAll(msg);
+        shared += threadCpuMicroseconds() - start;
+        drain(fds);
+    }
+
+    for (int fd : fds)
+        close(fd);
+    server.stop();
+    return {perClient / ROUNDS, shared / ROUNDS, fds.size()};
+}
+
+int main()
+{
+    signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Broadcast of a " << PAYLOAD_SIZE << " bytes message, CPU us per broadcast"
+              << std::endl;
+    std::cout << std::setw(10) << "clients" << std::setw(16) << "sendTo loop" << std::setw(16)
+              << "sendToAll" << std::setw(22) << "bytes serialized" << std::endl;
+
+    size_t port = BENCH_PORT;
+    for (size_t nbClients : {10, 100, 1000, 4000})
+    {
+        Result result = benchFanOut(nbClients, port++);
+        size_t frame  = PAYLOAD_SIZE + sizeof(Message::Type) + sizeof(size_t);
+
+        std::cout << std::setw(10) << result.clients << std::fixed << std::setprecision(1)
+                  << std::setw(16) << result.perClientUs << std::setw(16) << result.sharedUs
+                  << std::setw(12) << frame * result.clients << " -> " << frame << std::endl;
+    }
+    return 0;
+}
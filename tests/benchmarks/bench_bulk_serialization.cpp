@@ -0,0 +1,160 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Un std::vector<float> dans un DataBuffer: un operator<< par element contre l'ecriture en bloc
+// (un seul append), puis la meme chose en big endian: ByteSwap::value() par element contre
+// appendBigEndian() (SSSE3 si le CPU l'a). En dernier, le noyau seul: boucle scalaire contre
+// ByteSwap::copy().
+
+static const size_t ELEMENTS = 1 << 20;
+static const int    ROUNDS   = 20;
+
+// Le noyau sur un tableau qui tient dans le cache L1: sinon la memoire borne les deux versions
+static const size_t KERNEL_ELEMENTS = 2048;
+static const int    KERNEL_ROUNDS   = 50000;
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+    double writeNs; // Par element
+    double readNs;
+};
+
+template <typename Write, typename Read>
+static Result bench(Write write, Read read)
+{
+    DataBuffer buffer;
+    write(buffer);
+    read(buffer);
+
+    double writeTime = 0;
+    double readTime  = 0;
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        buffer.clear();
+        Clock::time_point start = Clock::now();
+        write(buffer);
+        Clock::time_point middle = Clock::now();
+        read(buffer);
+        std::chrono::duration<double, std::nano> written = middle - start;
+        std::chrono::duration<double, std::nano> readBack = Clock::now() - middle;
+        writeTime += written.count();
+        readTime += readBack.count();
+    }
+    return {writeTime / (double(ROUNDS) * ELEMENTS), readTime / (double(ROUNDS) * ELEMENTS)};
+}
+
+static void print(const std::string& name, const Result& result)
+{
+    std::cout << std::setw(26) << name << std::fixed << std::setprecision(3) << std::setw(12)
+              << result.writeNs << std::setw(12) << result.readNs << std::endl;
+}
+
+struct KernelResult
+{
+    double   ns; // Par element
+    uint64_t checksum;
+};
+
+template <typename T>
+static KernelResult kernel(bool vectorized)
+{
+    std::vector<T> src(KERNEL_ELEMENTS);
+    std::vector<T> dst(KERNEL_ELEMENTS);
+    uint64_t       checksum = 0;
+    for (size_t e = 0; e < src.size(); e++)
+        src[e] = static_cast<T>(e * 0x0101 + 1);
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < KERNEL_ROUNDS; i++)
+    {
+        if (vectorized)
+            ByteSwap::copy(dst.data(), src.data(), src.size());
+        else
+            for (size_t e = 0; e < src.size(); e++)
+                dst[e] = ByteSwap::value(src[e]);
+        checksum += dst[i % KERNEL_ELEMENTS];
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return {elapsed.count() / (double(KERNEL_ROUNDS) * KERNEL_ELEMENTS), checksum};
+}
+
+template <typename T>
+static void printKernel(const std::string& name)
+{
+    KernelResult scalar = kernel<T>(false);
+    KernelResult copy   = kernel<T>(true);
+    if (scalar.checksum != copy.checksum)
+        std::cout << "checksum mismatch" << std::endl;
+    std::cout << std::setw(26) << name << std::setw(12) << scalar.ns << std::setw(12) << copy.ns
+              << std::endl;
+}
+
+int main()
+{
+    std::vector<float> values(ELEMENTS);
+    for (size_t i = 0; i < ELEMENTS; i++)
+        values[i] = i * 0.25f;
+    std::vector<float> decoded(ELEMENTS);
+
+    Result perElement = bench(
+        [&](DataBuffer& out)
+        {
+            out << values.size();
+            for (float value : values)
+                out << value;
+        },
+        [&](DataBuffer& in)
+        {
+            size_t count;
+            in >> count;
+            decoded.resize(count);
+            for (float& value : decoded)
+                in >> value;
+        });
+    Result bulk =
+        bench([&](DataBuffer& out) { out << values; }, [&](DataBuffer& in) { in >> decoded; });
+
+    Result swappedPerElement = bench(
+        [&](DataBuffer& out)
+        {
+            for (float value : values)
+                out << ByteSwap::value(value);
+        },
+        [&](DataBuffer& in)
+        {
+            for (float& value : decoded)
+            {
+                in >> value;
+                value = ByteSwap::value(value);
+            }
+        });
+    Result swappedBulk =
+        bench([&](DataBuffer& out) { out.appendBigEndian(values.data(), values.size()); },
+              [&](DataBuffer& in) { in.readBigEndian(decoded.data(), decoded.size()); });
+
+    std::cout << "std::vector<float> of " << ELEMENTS << " elements through a DataBuffer, "
+              << ROUNDS << " rounds" << std::endl;
+    std::cout << std::setw(26) << "" << std::setw(12) << "write ns" << std::setw(12)
+              << "read ns" << std::endl;
+    print("host order, per element", perElement);
+    print("host order, bulk", bulk);
+    print("big endian, per element", swappedPerElement);
+    print("big endian, bulk", swappedBulk);
+
+    std::cout << std::endl
+              << "Byte swap kernel on " << KERNEL_ELEMENTS << " elements, ns per element (SSSE3 "
+              << (ByteSwap::vectorized() ? "available" : "not available") << ")" << std::endl;
+    std::cout << std::setw(26) << "" << std::setw(12) << "scalar" << std::setw(12) << "copy()"
+              << std::endl;
+    printKernel<uint16_t>("uint16_t");
+    printKernel<uint32_t>("uint32_t");
+    printKernel<uint64_t>("uint64_t");
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <signal.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Allers-retours de N sessions vers un serveur echo (dans son propre thread): une session par
+// Client (une socket et une boucle chacune) contre des canaux ClientPool sur 4 connexions.
+// A chaque tour, chaque session envoie un message puis attend sa reponse.
+// Un Client seul compte deux fds: sa socket et l'instance epoll de sa boucle.
+
+static const size_t BENCH_PORT  = 18950;
+static const int    ROUNDS      = 200;
+static const size_t CONNECTIONS = 4;
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+    size_t fds;
+    double roundsPerSec;
+};
+
+static void startEcho(Server& server, std::atomic<bool>& running, std::thread& loop)
+{
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView& msg)
+                        {
+                            Message reply(2);
+                            reply.appendBytes(msg.data(), msg.size());
+                            server.sendTo(reply, clientID);
+                        });
+    server.start();
+    loop = std::thread(
+        [&server, &running]()
+        {
+            while (running)
+                server.update();
+        });
+}
+
+static Result benchClients(size_t sessions, size_t port)
+{
+    Server            server("127.0.0.1", port, Server::Backend::EPOLL);
+    std::atomic<bool> running{true};
+    std::thread       loop;
+    startEcho(server, running, loop);
+
+    std::vector<std::unique_ptr<Client>> clients;
+    size_t                               received = 0;
+    for (size_t i = 0; i < sessions; i++)
+    {
+        clients.emplace_back(new Client("127.0.0.1", port));
+        clients[i]->defineAction(2, [&received](const MessageView&) { received++; });
+    }
+
+    Message msg(1);
+    msg << 42;
+
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (auto& client : clients)
+            client->send(msg);
+        // Une reponse par client: update(1) rend la main des qu'elle est arrivee
+        for (auto& client : clients)
+            client->update(1);
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    running = false;
+    loop.join();
+    server.stop();
+    return {2 * sessions, received == sessions * ROUNDS ? ROUNDS / elapsed.count() : -1};
+}
+
+static Result benchPool(size_t sessions, size_t port)
+{
+    Server            server("127.0.0.1", port, Server::Backend::EPOLL);
+    std::atomic<bool> running{true};
+    std::thread       loop;
+    startEcho(server, running, loop);
+
+    ClientPool                       pool("127.0.0.1", port, CONNECTIONS);
+    std::vector<ClientPool::Channel> channels;
+    size_t                           received = 0;
+    for (size_t i = 0; i < sessions; i++)
+    {
+        channels.push_back(pool.open());
+        channels[i].defineAction(2, [&received](const MessageView&) { received++; });
+    }
+
+    Message msg(1);
+    msg << 42;
+
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (auto& channel : channels)
+            channel.send(msg);
+        size_t expected = (round + 1) * sessions;
+        while (received < expected)
+            pool.update(expected - received);
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    running = false;
+    loop.join();
+    server.stop();
+    return {CONNECTIONS + 1, ROUNDS / elapsed.count()};
+}
+
+int main()
+{
+    signal(SIGPIPE, SIG_IGN);
+
+    std::vector<size_t> sizes = {16, 64, 256};
+    std::vector<Result> clients;
+    std::vector<Result> pools;
+    size_t              port = BENCH_PORT;
+    for (size_t sessions : sizes)
+    {
+        clients.push_back(benchClients(sessions, port++));
+        pools.push_back(benchPool(sessions, port++));
+    }
+
+    // Server::stop() ecrit sur la sortie: le tableau est affiche une fois les mesures faites
+    std::cout << ROUNDS << " rounds, one echo per session per round" << std::endl;
+    std::cout << std::setw(10) << "sessions" << std::setw(14) << "Client fds" << std::setw(16)
+              << "Client rnd/s" << std::setw(12) << "pool fds" << std::setw(14) << "pool rnd/s"
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        std::cout << std::setw(10) << sizes[i] << std::setw(14) << clients[i].fds
+                  << std::setw(16) << clients[i].roundsPerSec << std::setw(12) << pools[i].fds
+                  << std::setw(14) << pools[i].roundsPerSec << std::endl;
+    }
+    return 0;
+}
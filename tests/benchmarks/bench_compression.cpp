@@ -0,0 +1,123 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Cout CPU de LzCodec contre octets economises, sur des payloads de 64 KB:
+// un etat serialise (DataBuffer), du texte de log et du bruit (incompressible).
+// Le temps de transfert d'un payload est ensuite estime pour plusieurs debits de lien:
+// brut = taille / debit, compresse = compression + taille compressee / debit + decompression.
+
+static const size_t PAYLOAD_SIZE = 65536;
+static const int    ROUNDS       = 2000;
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+    std::string name;
+    double      ratio;
+    double      compressMBs;
+    double      decompressMBs;
+    double      compressUs;
+    double      decompressUs;
+    size_t      packedSize;
+};
+
+static std::vector<unsigned char> stateDump()
+{
+    DataBuffer state;
+    for (int i = 0; state.size() < PAYLOAD_SIZE; i++)
+        state << i << std::string("player") << static_cast<float>(i % 100) * 0.5f << (i % 3 == 0)
+              << std::string(i % 7 == 0 ? "idle" : "running");
+    return std::vector<unsigned char>(state.rawData(), state.rawData() + PAYLOAD_SIZE);
+}
+
+static std::vector<unsigned char> logText()
+{
+    std::string text;
+    for (int i = 0; text.size() < PAYLOAD_SIZE; i++)
+        text += "[" + std::to_string(1000 + i) + "] client " + std::to_string(i % 50) +
+                (i % 4 == 0 ? " disconnected\n" : " sent message of type 7\n");
+    return std::vector<unsigned char>(text.begin(), text.begin() + PAYLOAD_SIZE);
+}
+
+static std::vector<unsigned char> noise()
+{
+    std::vector<unsigned char> data(PAYLOAD_SIZE);
+    uint32_t                   x = 42;
+    for (auto& byte : data)
+    {
+        x    = x * 1103515245 + 12345;
+        byte = static_cast<unsigned char>(x >> 16);
+    }
+    return data;
+}
+
+static Result bench(const std::string& name, const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> block(LzCodec::bound(data.size()));
+    std::vector<unsigned char> restored(data.size());
+    size_t                     packedSize = 0;
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < ROUNDS; i++)
+        packedSize = LzCodec::compress(data.data(), data.size(), block.data(), block.size());
+    std::chrono::duration<double> compress = Clock::now() - start;
+
+    start = Clock::now();
+    for (int i = 0; i < ROUNDS; i++)
+        LzCodec::decompress(block.data(), packedSize, restored.data(), restored.size());
+    std::chrono::duration<double> decompress = Clock::now() - start;
+
+    if (restored != data)
+        std::cerr << name << ": round trip mismatch" << std::endl;
+
+    double megabytes = double(data.size()) * ROUNDS / 1e6;
+    return {name,
+            double(data.size()) / packedSize,
+            megabytes / compress.count(),
+            megabytes / decompress.count(),
+            compress.count() * 1e6 / ROUNDS,
+            decompress.count() * 1e6 / ROUNDS,
+            packedSize};
+}
+
+int main()
+{
+    std::vector<Result> results = {bench("state dump", stateDump()), bench("log text", logText()),
+                                   bench("noise", noise())};
+
+    std::cout << ROUNDS << " rounds on " << PAYLOAD_SIZE << " byte payloads" << std::endl;
+    std::cout << std::setw(12) << "payload" << std::setw(10) << "ratio" << std::setw(16)
+              << "compress MB/s" << std::setw(18) << "decompress MB/s" << std::endl;
+    for (const auto& result : results)
+    {
+        std::cout << std::setw(12) << result.name << std::fixed << std::setprecision(2)
+                  << std::setw(10) << result.ratio << std::setprecision(0) << std::setw(16)
+                  << result.compressMBs << std::setw(18) << result.decompressMBs << std::endl;
+    }
+
+    // Temps d'un payload de bout en bout (us): brut / compresse, selon le debit du lien
+    const double links[] = {100e6, 1e9, 10e9}; // bits/s
+    std::cout << std::endl << "transfer time per payload (us), raw / compressed" << std::endl;
+    std::cout << std::setw(12) << "payload" << std::setw(18) << "100 Mbit/s" << std::setw(18)
+              << "1 Gbit/s" << std::setw(18) << "10 Gbit/s" << std::endl;
+    for (const auto& result : results)
+    {
+        std::cout << std::setw(12) << result.name;
+        for (double bitsPerSec : links)
+        {
+            double raw    = PAYLOAD_SIZE * 8 / bitsPerSec * 1e6;
+            double packed = result.compressUs + result.packedSize * 8 / bitsPerSec * 1e6 +
+                            result.decompressUs;
+            std::cout << std::setw(9) << std::setprecision(0) << raw << " /" << std::setw(7)
+                      << packed;
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Construction d'un gros DataBuffer par ajouts de 4 KB: stockage contigu (le vector est realloue
+// et recopie en entier a chaque croissance) contre chunks de CHUNK_POOL_CHUNK_SIZE pris dans un
+// ChunkPool (chaque octet n'est ecrit qu'une fois). Le pool est chaud: le buffer precedent y a
+// rendu ses chunks, comme pour une connexion qui envoie en continu.
+
+static const size_t PIECE  = 4096;
+static const int    ROUNDS = 5;
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+    double msPerBuild;
+    size_t bytesMoved; // Recopies dues aux reallocations, par construction
+};
+
+static Result bench(size_t total, const std::shared_ptr<ChunkPool>& pool)
+{
+    std::vector<unsigned char> piece(PIECE, 'x');
+    size_t                     moved = 0;
+
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        DataBuffer buffer = pool ? DataBuffer(pool) : DataBuffer();
+        size_t     capacity = buffer.capacity();
+        for (size_t size = 0; size < total; size += PIECE)
+        {
+            buffer.append(piece.data(), piece.size());
+            if (!pool && buffer.capacity() != capacity)
+            {
+                moved += size;
+                capacity = buffer.capacity();
+            }
+        }
+        if (buffer.size() != total)
+            std::cout << "size mismatch" << std::endl;
+    }
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    return {elapsed.count() / ROUNDS, moved / ROUNDS};
+}
+
+int main()
+{
+    std::shared_ptr<ChunkPool> pool = std::make_shared<ChunkPool>(CHUNK_POOL_CHUNK_SIZE, 8192);
+
+    std::cout << "DataBuffer built from " << PIECE << " byte appends, " << ROUNDS << " rounds"
+              << std::endl;
+    std::cout << std::setw(10) << "MB" << std::setw(16) << "contiguous ms" << std::setw(14)
+              << "MB moved" << std::setw(14) << "chunked ms" << std::setw(14) << "MB moved"
+              << std::endl;
+
+    for (size_t mb : {1, 16, 64})
+    {
+        size_t total = mb * 1024 * 1024;
+        bench(total, pool); // Remplit le pool
+        Result contiguous = bench(total, nullptr);
+        Result chunked    = bench(total, pool);
+
+        std::cout << std::setw(10) << mb << std::fixed << std::setprecision(2) << std::setw(16)
+                  << contiguous.msPerBuild << std::setprecision(1) << std::setw(14)
+                  << contiguous.bytesMoved / 1048576.0 << std::setprecision(2) << std::setw(14)
+                  << chunked.msPerBuild << std::setprecision(1) << std::setw(14)
+                  << chunked.bytesMoved / 1048576.0 << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Acces aux octets non lus d'un DataBuffer, message par message: data() recopie tout ce qui
+// suit le curseur dans un nouveau vector (un cout qui croit avec le reste du flux), view() ne
+// renvoie qu'un pointeur et une longueur.
+// Les allocations sont comptees en remplacant operator new pour tout le programme.
+
+static const size_t MESSAGES = 1000;
+static const int    ROUNDS   = 5;
+
+using Clock = std::chrono::steady_clock;
+
+static size_t allocations = 0;
+
+void* operator new(size_t size)
+{
+    allocations++;
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+struct Result
+{
+    double nsPerRead;
+    double allocationsPerRead;
+    size_t checksum;
+};
+
+// Un flux de messages [taille][payload] lu un par un, comme un decodeur de protocole
+template <typename Read>
+static Result bench(const DataBuffer& buffer, Read read)
+{
+    size_t checksum = 0;
+    size_t before   = allocations;
+
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        buffer.reset();
+        for (size_t i = 0; i < MESSAGES; i++)
+        {
+            size_t len;
+            buffer >> len;
+            checksum += read(buffer, len);
+            buffer.increaseCursor(len);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+
+    double reads = static_cast<double>(MESSAGES) * ROUNDS;
+    return {elapsed.count() / reads, (allocations - before) / reads, checksum};
+}
+
+int main()
+{
+    std::cout << MESSAGES << " messages read from one DataBuffer, " << ROUNDS << " rounds"
+              << std::endl;
+    std::cout << std::setw(10) << "payload" << std::setw(16) << "data() ns" << std::setw(14)
+              << "allocs/read" << std::setw(16) << "view() ns" << std::setw(14) << "allocs/read"
+              << std::endl;
+
+    for (size_t payload : {16, 256, 4096})
+    {
+        DataBuffer                 buffer;
+        std::vector<unsigned char> bytes(payload, 'x');
+        for (size_t i = 0; i < MESSAGES; i++)
+        {
+            buffer << payload;
+            buffer.append(bytes.data(), bytes.size());
+        }
+
+        // Ancien acces: la copie de tout le reste du buffer, pour n'en lire que le debut
+        Result copy = bench(buffer,
+                            [](const DataBuffer& buf, size_t len)
+                            {
+                                std::vector<unsigned char> rest = buf.data();
+                                return static_cast<size_t>(rest[0] + rest[len - 1]);
+                            });
+        Result view = bench(buffer,
+                            [](const DataBuffer& buf, size_t len)
+                            {
+                                DataBuffer::View msg = buf.view(len);
+                                return static_cast<size_t>(msg[0] + msg[len - 1]);
+                            });
+        if (copy.checksum != view.checksum)
+            std::cout << "checksum mismatch" << std::endl;
+
+        std::cout << std::setw(10) << payload << std::fixed << std::setprecision(1)
+                  << std::setw(16) << copy.nsPerRead << std::setprecision(2) << std::setw(14)
+                  << copy.allocationsPerRead << std::setprecision(1) << std::setw(16)
+                  << view.nsPerRead << std::setprecision(2) << std::setw(14)
+                  << view.allocationsPerRead << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Compare l'ancien decoupage des frames (Message + DataBuffer::data()) et FrameBuffer.
+// Les octets copies sont comptes a chaque copie effectuee par chaque chemin, la reception
+// dans le buffer de la connexion comprise.
+
+static const size_t RECV_CHUNK = READ_BUFFER_SIZE;
+static const int    ROUNDS     = 200;
+
+struct Result
+{
+    double bytesCopiedPerMsg;
+    double nsPerMsg;
+    size_t checksum;
+};
+
+static std::vector<unsigned char> buildStream(size_t payloadSize, size_t nbMessages)
+{
+    std::vector<unsigned char> stream;
+    for (size_t i = 0; i < nbMessages; i++)
+    {
+        Message msg(1);
+        msg.appendBytes(std::vector<unsigned char>(payloadSize, (unsigned char)i).data(),
+                        payloadSize);
+        auto bytes = msg.getSerializedData();
+        stream.insert(stream.end(), bytes.begin(), bytes.end());
+    }
+    return stream;
+}
+
+// Reproduction fidele de l'ancien Server::_receiveClientMsg
+static Result legacyPath(const std::vector<unsigned char>& stream, size_t nbMessages)
+{
+    size_t      copied   = 0;
+    size_t      checksum = 0;
+    Chronometre chrono;
+
+    chrono.start();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        Message              partial;
+        std::vector<Message> msgs;
+        unsigned char        buffRead[RECV_CHUNK];
+
+        for (size_t pos = 0; pos < stream.size(); pos += RECV_CHUNK)
+        {
+            size_t bytes = std::min(RECV_CHUNK, stream.size() - pos);
+            memcpy(buffRead, stream.data() + pos, bytes); // recv() dans le buffer de pile
+            partial.appendBytes(buffRead, bytes);
+            copied += bytes * 2;
+
+            while (partial.isComplet())
+            {
+                Message::Type type;
+                partial >> type;
+                Message newMsg(type);
+                size_t  dataSize;
+                partial >> dataSize;
+
+                copied += partial.getBuffer()->size(); // data() copie tout le reste
+                newMsg.appendBytes(partial.getBuffer()->data().data(), dataSize);
+                copied += dataSize;
+                partial.incr_cursor(dataSize);
+
+                msgs.push_back(newMsg);
+                copied += dataSize; // copie du Message dans _msgs
+            }
+        }
+        for (auto& msg : msgs)
+            checksum += msg.type();
+    }
+    chrono.end();
+
+    double total = double(nbMessages) * ROUNDS;
+    return {copied / total, chrono.getTimeNanoseconds() / total, checksum};
+}
+
+static Result frameBufferPath(const std::vector<unsigned char>& stream, size_t nbMessages)
+{
+    size_t      copied   = 0;
+    size_t      checksum = 0;
+    Chronometre chrono;
+
+    chrono.start();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        FrameBuffer inbox;
+
+        for (size_t pos = 0; pos < stream.size(); pos += RECV_CHUNK)
+        {
+            size_t bytes = std::min(RECV_CHUNK, stream.size() - pos);
+            memcpy(inbox.prepare(RECV_CHUNK), stream.data() + pos, bytes); // recv() en place
+            inbox.commit(bytes);
+            copied += bytes;
+            inbox.extract();
+        }
+        for (const auto& frame : inbox.frames())
+            checksum += inbox.view(frame).type();
+        inbox.release();
+    }
+    chrono.end();
+
+    double total = double(nbMessages) * ROUNDS;
+    return {copied / total, chrono.getTimeNanoseconds() / total, checksum};
+}
+
+int main()
+{
+    const size_t                nbMessages = 256;
+    const std::vector<size_t>   sizes      = {8, 64, 256, 1024};
+
+    std::cout << "Frame extraction: " << nbMessages << " messages per burst, recv chunks of "
+              << RECV_CHUNK << " bytes" << std::endl;
+    std::cout << std::left << std::setw(10) << "payload" << std::setw(14) << "path"
+              << std::setw(18) << "bytes copied/msg" << "ns/msg" << std::endl;
+
+    for (size_t size : sizes)
+    {
+        auto stream = buildStream(size, nbMessages);
+
+        Result before = legacyPath(stream, nbMessages);
+        Result after  = frameBufferPath(stream, nbMessages);
+
+        if (before.checksum != after.checksum)
+        {
+            std::cerr << "Paths disagree on the decoded messages" << std::endl;
+            return 1;
+        }
+
+        std::cout << std::left << std::fixed << std::setprecision(1) << std::setw(10) << size
+                  << std::setw(14) << "Message" << std::setw(18) << before.bytesCopiedPerMsg
+                  << before.nsPerMsg << std::endl;
+        std::cout << std::left << std::setw(10) << size << std::setw(14) << "FrameBuffer"
+                  << std::setw(18) << after.bytesCopiedPerMsg << after.nsPerMsg << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <signal.h>
+#include <time.h>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Cout CPU du thread serveur par message echo, en loopback, selon le backend.
+// Chaque connexion envoie une rafale de petits messages par tour; le serveur repond a chacun.
+// Le temps passe a attendre des evenements n'est pas compte, seul le travail du thread l'est.
+
+static const size_t BENCH_PORT = 18650;
+static const int    ROUNDS     = 20;
+static const int    BURST      = 16;
+
+static double threadCpuMicroseconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int openConnection(size_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static size_t drain(const std::vector<int>& fds)
+{
+    unsigned char buffer[65536];
+    size_t        total = 0;
+    for (int fd : fds)
+    {
+        ssize_t bytes;
+        while ((bytes = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0)
+            total += bytes;
+    }
+    return total;
+}
+
+// Retourne le temps CPU serveur moyen par message, en microsecondes
+static double benchBackend(Server::Backend backend, size_t nbConnections, size_t port)
+{
+    Server server("127.0.0.1", port, backend);
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView& msg)
+                        {
+                            Message reply(2);
+                            reply.appendBytes(msg.data(), msg.size());
+                            server.sendTo(reply, clientID);
+                        });
+    server.start();
+
+    std::vector<int> fds;
+    for (size_t i = 0; i < nbConnections; i++)
+    {
+        int fd = openConnection(port);
+        if (fd < 0)
+            break;
+        fds.push_back(fd);
+        if (i % 64 == 63)
+            server.update();
+    }
+    server.update();
+
+    Message msg(1);
+    msg << 42 << 3.14;
+    std::vector<unsigned char> burst;
+    for (int i = 0; i < BURST; i++)
+    {
+        auto bytes = msg.getSerializedData();
+        burst.insert(burst.end(), bytes.begin(), bytes.end());
+    }
+
+    double elapsed  = 0;
+    size_t expected = burst.size() * fds.size();
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int fd : fds)
+            if (send(fd, burst.data(), burst.size(), MSG_NOSIGNAL) < 0)
+                return -1;
+
+        size_t received = 0;
+        for (int tries = 0; tries < 200 && received < expected; tries++)
+        {
+            double start = threadCpuMicroseconds();
+            server.update();
+            elapsed += threadCpuMicroseconds() - start;
+            received += drain(fds);
+        }
+        if (received < expected)
+            return -1;
+    }
+
+    for (int fd : fds)
+        close(fd);
+    server.stop();
+    return elapsed / (double(ROUNDS) * BURST * fds.size());
+}
+
+int main()
+{
+    signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Echo of " << BURST << " messages per connection per round, server CPU us per "
+              << "message" << std::endl;
+    std::cout << std::setw(12) << "connections" << std::setw(12) << "select" << std::setw(12)
+              << "epoll" << std::setw(12) << "io_uring" << std::endl;
+
+    size_t port = BENCH_PORT;
+    for (size_t nbConnections : {10, 100, 400})
+    {
+        // Server::stop() ecrit sur la sortie: la ligne est affichee une fois les mesures faites
+        std::vector<double> results;
+        for (Server::Backend backend :
+             {Server::Backend::SELECT, Server::Backend::EPOLL, Server::Backend::IO_URING})
+        {
+            if (backend == Server::Backend::IO_URING && !IoUring::available())
+                results.push_back(-1);
+            else
+                results.push_back(benchBackend(backend, nbConnections, port++));
+        }
+
+        std::cout << std::setw(12) << nbConnections << std::fixed << std::setprecision(3);
+        for (double result : results)
+        {
+            if (result < 0)
+                std::cout << std::setw(12) << "n/a";
+            else
+                std::cout << std::setw(12) << result;
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
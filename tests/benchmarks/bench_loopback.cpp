@@ -0,0 +1,178 @@
+#include <signal.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Debit et latence de bout en bout en loopback: un serveur d'echo epoll dans son propre thread,
+// N clients partageant une EventLoop dans le thread principal. Chaque client garde DEPTH
+// messages en vol et en renvoie un a chaque echo (boucle fermee). Le payload commence par
+// l'heure d'envoi: la latence est mesuree a la reception de l'echo, dans un LatencyHistogram.
+// Le CPU est celui du thread serveur, puis celui du processus entier (serveur + clients), par
+// message aller-retour.
+
+static const size_t BENCH_PORT     = 18000;
+static const size_t DEPTH          = 4;
+static const size_t MAX_MESSAGES   = 100000;
+static const size_t MAX_BENCH_SIZE = 256 * 1024 * 1024; // Octets echanges au plus par mesure
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+    size_t                     messages;
+    double                     messagesPerSec;
+    double                     serverCpuUs; // Par message
+    double                     processCpuUs;
+    LatencyHistogram::Snapshot latency;
+};
+
+static double threadCpuMicroseconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double processCpuMicroseconds()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e6 + usage.ru_utime.tv_usec +
+           usage.ru_stime.tv_usec;
+}
+
+static uint64_t nowNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+        .count();
+}
+
+static Result bench(size_t connections, size_t size, size_t port)
+{
+    Server server("127.0.0.1", port, Server::Backend::EPOLL);
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView& msg)
+                        {
+                            Message echo(2);
+                            echo.appendBytes(msg.data(), msg.size());
+                            server.sendTo(echo, clientID);
+                        });
+    server.start();
+
+    // Sous charge continue un update() dure toute la mesure: on compte tout le thread, accepts
+    // compris (l'attente dans epoll_wait() ne coute rien)
+    std::atomic<bool> running{true};
+    double            serverCpu = 0;
+    std::thread       loop(
+        [&]()
+        {
+            while (running)
+                server.update();
+            serverCpu = threadCpuMicroseconds();
+        });
+
+    size_t total = std::min(MAX_MESSAGES, std::max<size_t>(MAX_BENCH_SIZE / size, 1000));
+    total -= total % connections;
+    size_t perClient = total / connections;
+
+    LatencyHistogram                     latency;
+    std::vector<unsigned char>           payload(size, 'x');
+    std::vector<size_t>                  sent(connections, 0);
+    size_t                               received = 0;
+    EventLoop                            clientLoop;
+    std::vector<std::unique_ptr<Client>> clients;
+
+    // L'heure d'envoi dans les 8 premiers octets du payload, renvoyes tels quels par l'echo
+    auto sendOne = [&](size_t index)
+    {
+        uint64_t now = nowNanoseconds();
+        memcpy(payload.data(), &now, sizeof(now));
+        Message msg(1);
+        msg.appendBytes(payload.data(), payload.size());
+        clients[index]->send(msg);
+        sent[index]++;
+    };
+
+    for (size_t i = 0; i < connections; i++)
+    {
+        clients.emplace_back(new Client("127.0.0.1", port));
+        clients[i]->defineAction(2,
+                                 [&, i](const MessageView& echo)
+                                 {
+                                     uint64_t sentAt;
+                                     memcpy(&sentAt, echo.data(), sizeof(sentAt));
+                                     latency.record(nowNanoseconds() - sentAt);
+                                     received++;
+                                     if (sent[i] < perClient)
+                                         sendOne(i);
+                                 });
+        clients[i]->attach(clientLoop);
+    }
+
+    double            cpuStart  = processCpuMicroseconds();
+    Clock::time_point timeStart = Clock::now();
+    for (size_t i = 0; i < connections; i++)
+        for (size_t d = 0; d < DEPTH && sent[i] < perClient; d++)
+            sendOne(i);
+    while (received < total)
+        clientLoop.runOnce(100);
+    std::chrono::duration<double> elapsed = Clock::now() - timeStart;
+    double                        cpu     = processCpuMicroseconds() - cpuStart;
+
+    running = false;
+    loop.join();
+    for (auto& client : clients)
+        client->disconnect();
+    server.stop();
+
+    return {total, total / elapsed.count(), serverCpu / total, cpu / total, latency.snapshot()};
+}
+
+int main()
+{
+    signal(SIGPIPE, SIG_IGN);
+
+    std::vector<size_t> connectionSteps = {1, 16, 128};
+    std::vector<size_t> sizeSteps       = {16, 256, 4096, 65536};
+
+    std::vector<Result> results;
+    size_t              port = BENCH_PORT;
+    for (size_t connections : connectionSteps)
+        for (size_t size : sizeSteps)
+            results.push_back(bench(connections, size, port++));
+
+    // Server::stop() ecrit sur la sortie: le tableau est affiche une fois les mesures faites
+    std::cout << "Echo round trips over loopback, epoll server thread, " << DEPTH
+              << " messages in flight per connection" << std::endl;
+    std::cout << std::setw(6) << "conns" << std::setw(8) << "bytes" << std::setw(10) << "msgs"
+              << std::setw(12) << "msgs/s" << std::setw(10) << "p50 us" << std::setw(10)
+              << "p99 us" << std::setw(10) << "p999 us" << std::setw(14) << "srv cpu us"
+              << std::setw(14) << "all cpu us" << std::endl;
+
+    size_t row = 0;
+    for (size_t connections : connectionSteps)
+        for (size_t size : sizeSteps)
+        {
+            const Result& result = results[row++];
+            std::cout << std::setw(6) << connections << std::setw(8) << size << std::setw(10)
+                      << result.messages << std::fixed << std::setprecision(0) << std::setw(12)
+                      << result.messagesPerSec << std::setprecision(1) << std::setw(10)
+                      << result.latency.percentile(50) / 1e3 << std::setw(10)
+                      << result.latency.percentile(99) / 1e3 << std::setw(10)
+                      << result.latency.percentile(99.9) / 1e3 << std::setprecision(2)
+                      << std::setw(14) << result.serverCpuUs << std::setw(14)
+                      << result.processCpuUs << std::endl;
+        }
+    return 0;
+}
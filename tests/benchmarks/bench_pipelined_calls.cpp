@@ -0,0 +1,106 @@
+#include <signal.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Requetes / reponses Client::call() -> Server::reply() en loopback, selon le nombre de
+// requetes en vol. Le serveur tourne dans son propre thread; le client garde `depth` appels en
+// attente et en relance un a chaque reponse. Profondeur 1 = allers-retours serialises.
+
+static const size_t BENCH_PORT = 18850;
+static const size_t CALLS      = 20000;
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+    double callsPerSec;
+    double latencyUs;
+};
+
+static Result bench(size_t depth, size_t port)
+{
+    Server server("127.0.0.1", port, Server::Backend::EPOLL);
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView& request)
+                        {
+                            Message response(2);
+                            response.appendBytes(request.data(), request.size());
+                            server.reply(clientID, request, response);
+                        });
+    server.start();
+
+    std::atomic<bool> running{true};
+    std::thread       loop(
+        [&server, &running]()
+        {
+            while (running)
+                server.update();
+        });
+
+    Client client("127.0.0.1", port);
+
+    size_t sent    = 0;
+    size_t done    = 0;
+    double latency = 0;
+
+    Clock::time_point start = Clock::now();
+    while (done < CALLS)
+    {
+        while (sent < CALLS && sent - done < depth)
+        {
+            Message request(1);
+            request << sent;
+
+            Clock::time_point callTime = Clock::now();
+            client.call(request,
+                        [&done, &latency, callTime](const MessageView&)
+                        {
+                            std::chrono::duration<double, std::micro> elapsed =
+                                Clock::now() - callTime;
+                            latency += elapsed.count();
+                            done++;
+                        });
+            sent++;
+        }
+        // Une reponse suffit pour relancer une requete: update() rend la main aussitot
+        client.update(1);
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    running = false;
+    loop.join();
+    server.stop();
+    return {CALLS / elapsed.count(), latency / CALLS};
+}
+
+int main()
+{
+    signal(SIGPIPE, SIG_IGN);
+
+    std::vector<Result> results;
+    size_t              port = BENCH_PORT;
+    for (size_t depth : {1, 8, 64, 256})
+        results.push_back(bench(depth, port++));
+
+    // Server::stop() ecrit sur la sortie: le tableau est affiche une fois les mesures faites
+    std::cout << CALLS << " calls, echo server in its own thread" << std::endl;
+    std::cout << std::setw(8) << "depth" << std::setw(14) << "calls/s" << std::setw(18)
+              << "mean latency us" << std::endl;
+
+    size_t row = 0;
+    for (size_t depth : {1, 8, 64, 256})
+    {
+        std::cout << std::setw(8) << depth << std::fixed << std::setprecision(0) << std::setw(14)
+                  << results[row].callsPerSec << std::setprecision(1) << std::setw(18)
+                  << results[row].latencyUs << std::endl;
+        row++;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Cout de DataBuffer::Encoding::PORTABLE face a HOST. Sur un hote little endian les nombres ont
+// deja l'ordre portable: les branches de conversion disparaissent a la compilation, seules les
+// tailles (strings, vectors) passent de size_t a un varint.
+// - Particle: 8 floats sans padding, un std::vector part en un seul memcpy dans les deux cas
+// - Entity: int, string, float, vector<int>: deux tailles par element
+// - scalaires: un int32_t et un double par element, operator<< un par un
+
+static const size_t ITEMS  = 10000;
+static const int    ROUNDS = 200;
+
+using Clock = std::chrono::steady_clock;
+
+struct Particle
+{
+    float x, y, z;
+    float vx, vy, vz;
+    float life;
+    float size;
+
+    static constexpr auto schema()
+    {
+        return std::make_tuple(&Particle::x, &Particle::y, &Particle::z, &Particle::vx,
+                               &Particle::vy, &Particle::vz, &Particle::life, &Particle::size);
+    }
+};
+
+struct Entity
+{
+    int32_t              id;
+    std::string          name;
+    float                health;
+    std::vector<int32_t> inventory;
+
+    static constexpr auto schema()
+    {
+        return std::make_tuple(&Entity::id, &Entity::name, &Entity::health, &Entity::inventory);
+    }
+};
+
+struct Result
+{
+    double encodeNs; // Par element
+    double decodeNs;
+    size_t bytes;
+};
+
+template <typename Encode, typename Decode>
+static Result bench(DataBuffer::Encoding encoding, Encode encode, Decode decode)
+{
+    DataBuffer buffer;
+    buffer.setEncoding(encoding);
+    encode(buffer);
+    size_t bytes = buffer.size();
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        buffer.clear();
+        encode(buffer);
+    }
+    std::chrono::duration<double> encodeTime = Clock::now() - start;
+
+    start = Clock::now();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        buffer.reset();
+        decode(buffer);
+    }
+    std::chrono::duration<double> decodeTime = Clock::now() - start;
+
+    double perItem = 1e9 / (double(ROUNDS) * ITEMS);
+    return {encodeTime.count() * perItem, decodeTime.count() * perItem, bytes};
+}
+
+template <typename Encode, typename Decode>
+static void compare(const std::string& name, Encode encode, Decode decode)
+{
+    Result host     = bench(DataBuffer::Encoding::HOST, encode, decode);
+    Result portable = bench(DataBuffer::Encoding::PORTABLE, encode, decode);
+
+    std::cout << std::setw(12) << name << std::fixed << std::setprecision(2) << std::setw(12)
+              << host.encodeNs << std::setw(12) << portable.encodeNs << std::setw(12)
+              << host.decodeNs << std::setw(12) << portable.decodeNs << std::setw(12)
+              << host.bytes << std::setw(12) << portable.bytes << std::endl;
+}
+
+int main()
+{
+    std::vector<Particle> particles(ITEMS);
+    for (size_t i = 0; i < ITEMS; i++)
+        particles[i] = {float(i), 1, 2, 0.5f, 0.5f, 0.5f, 10, 1};
+    std::vector<Particle> decodedParticles;
+
+    std::vector<Entity> entities(ITEMS);
+    for (size_t i = 0; i < ITEMS; i++)
+        entities[i] = {int32_t(i), "entity_" + std::to_string(i), 100, {1, 2, 3, 4}};
+    std::vector<Entity> decodedEntities;
+
+    std::vector<int32_t> ids(ITEMS);
+    std::vector<double>  scores(ITEMS);
+    for (size_t i = 0; i < ITEMS; i++)
+    {
+        ids[i]    = int32_t(i);
+        scores[i] = i * 0.5;
+    }
+
+    std::cout << "DataBuffer encodings, " << ITEMS << " items, " << ROUNDS << " rounds ("
+              << (BYTE_SWAP_HOST_IS_LITTLE ? "little" : "big") << " endian host)" << std::endl;
+    std::cout << std::setw(12) << "" << std::setw(12) << "enc host" << std::setw(12)
+              << "enc port" << std::setw(12) << "dec host" << std::setw(12) << "dec port"
+              << std::setw(12) << "bytes host" << std::setw(12) << "bytes port" << std::endl;
+
+    compare(
+        "particles", [&](DataBuffer& out) { out << particles; },
+        [&](DataBuffer& in) { in >> decodedParticles; });
+    compare(
+        "entities", [&](DataBuffer& out) { out << entities; },
+        [&](DataBuffer& in) { in >> decodedEntities; });
+    compare(
+        "scalars",
+        [&](DataBuffer& out)
+        {
+            for (size_t i = 0; i < ITEMS; i++)
+                out << ids[i] << scores[i];
+        },
+        [&](DataBuffer& in)
+        {
+            for (size_t i = 0; i < ITEMS; i++)
+                in >> ids[i] >> scores[i];
+        });
+    return 0;
+}
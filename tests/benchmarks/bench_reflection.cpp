@@ -0,0 +1,161 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Encodage / decodage dans un DataBuffer: operateurs ecrits a la main, champ par champ,
+// contre le schema declare une fois (Reflection).
+// - Particle: 8 floats sans padding, un std::vector part en un seul memcpy
+// - Entity: string et vector, le schema deroule les memes operateurs que le code a la main
+
+static const size_t PARTICLES = 10000;
+static const int    ROUNDS    = 200;
+
+using Clock = std::chrono::steady_clock;
+
+struct Particle
+{
+    float x, y, z;
+    float vx, vy, vz;
+    float life;
+    float size;
+
+    static constexpr auto schema()
+    {
+        return std::make_tuple(&Particle::x, &Particle::y, &Particle::z, &Particle::vx,
+                               &Particle::vy, &Particle::vz, &Particle::life, &Particle::size);
+    }
+};
+
+struct Entity
+{
+    int              id;
+    std::string      name;
+    float            health;
+    std::vector<int> inventory;
+
+    static constexpr auto schema()
+    {
+        return std::make_tuple(&Entity::id, &Entity::name, &Entity::health, &Entity::inventory);
+    }
+};
+
+struct Result
+{
+    double encodeNs;
+    double decodeNs;
+};
+
+template <typename Encode, typename Decode>
+static Result bench(size_t items, Encode encode, Decode decode)
+{
+    DataBuffer buffer;
+    encode(buffer);
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        buffer.clear();
+        encode(buffer);
+    }
+    std::chrono::duration<double> encodeTime = Clock::now() - start;
+
+    start = Clock::now();
+    for (int i = 0; i < ROUNDS; i++)
+    {
+        buffer.reset();
+        decode(buffer);
+    }
+    std::chrono::duration<double> decodeTime = Clock::now() - start;
+
+    double perItem = 1e9 / (double(ROUNDS) * items);
+    return {encodeTime.count() * perItem, decodeTime.count() * perItem};
+}
+
+static void print(const std::string& name, const Result& result)
+{
+    std::cout << std::setw(22) << name << std::setw(14) << result.encodeNs << std::setw(14)
+              << result.decodeNs << std::endl;
+}
+
+int main()
+{
+    std::vector<Particle> particles(PARTICLES);
+    for (size_t i = 0; i < PARTICLES; i++)
+        particles[i] = {float(i), 1, 2, 0.5f, 0.5f, 0.5f, 10, 1};
+    std::vector<Particle> decoded;
+
+    Result manualParticles = bench(
+        PARTICLES,
+        [&](DataBuffer& out)
+        {
+            out << particles.size();
+            for (const Particle& p : particles)
+                out << p.x << p.y << p.z << p.vx << p.vy << p.vz << p.life << p.size;
+        },
+        [&](DataBuffer& in)
+        {
+            size_t count;
+            in >> count;
+            decoded.resize(count);
+            for (Particle& p : decoded)
+                in >> p.x >> p.y >> p.z >> p.vx >> p.vy >> p.vz >> p.life >> p.size;
+        });
+    Result schemaParticles = bench(
+        PARTICLES, [&](DataBuffer& out) { out << particles; },
+        [&](DataBuffer& in) { in >> decoded; });
+
+    std::vector<Entity> entities(PARTICLES / 10);
+    for (size_t i = 0; i < entities.size(); i++)
+        entities[i] = {int(i), "entity_" + std::to_string(i), 100, {1, 2, 3, 4}};
+    std::vector<Entity> decodedEntities(entities.size());
+
+    Result manualEntities = bench(
+        entities.size(),
+        [&](DataBuffer& out)
+        {
+            for (const Entity& e : entities)
+            {
+                out << e.id << e.name << e.health << e.inventory.size();
+                for (int item : e.inventory)
+                    out << item;
+            }
+        },
+        [&](DataBuffer& in)
+        {
+            for (Entity& e : decodedEntities)
+            {
+                size_t count;
+                in >> e.id >> e.name >> e.health >> count;
+                e.inventory.resize(count);
+                for (int& item : e.inventory)
+                    in >> item;
+            }
+        });
+    Result schemaEntities = bench(
+        entities.size(),
+        [&](DataBuffer& out)
+        {
+            for (const Entity& e : entities)
+                out << e;
+        },
+        [&](DataBuffer& in)
+        {
+            for (Entity& e : decodedEntities)
+                in >> e;
+        });
+
+    std::cout << ROUNDS << " rounds, ns per item (" << PARTICLES << " particles, "
+              << entities.size() << " entities)" << std::endl;
+    std::cout << std::setw(22) << "" << std::setw(14) << "encode" << std::setw(14) << "decode"
+              << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    print("particles, by hand", manualParticles);
+    print("particles, schema", schemaParticles);
+    print("entities, by hand", manualEntities);
+    print("entities, schema", schemaEntities);
+    return 0;
+}
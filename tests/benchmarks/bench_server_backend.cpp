@@ -0,0 +1,127 @@
+#include <signal.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Mesure le cout CPU d'un Server::update() selon le nombre de connexions inactives.
+// Le temps passe a attendre dans select()/epoll_wait() n'est pas compte: seul le travail
+// effectue par le thread (copie du fd_set, scan des fds, appels systeme) l'est.
+
+static const size_t BENCH_PORT    = 18450;
+static const int    BENCH_UPDATES = 50;
+
+static double threadCpuMicroseconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int openIdleConnection(size_t port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static double benchBackend(Server::Backend backend, size_t nbIdle, size_t port)
+{
+    Server server("127.0.0.1", port, backend);
+    server.defineAction(1, [](long long&, const Message&) {});
+    server.start();
+
+    std::vector<int> idle;
+    idle.reserve(nbIdle);
+    for (size_t i = 0; i < nbIdle; i++)
+    {
+        int fd = openIdleConnection(port);
+        if (fd < 0)
+            break;
+        idle.push_back(fd);
+        // Accepter au fil de l'eau pour ne pas deborder la file du listen
+        if (i % 64 == 63)
+            server.update();
+    }
+    server.update();
+
+    Client active("127.0.0.1", port);
+    server.update();
+
+    Message msg(1);
+    msg << 42;
+
+    double total = 0;
+    for (int i = 0; i < BENCH_UPDATES; i++)
+    {
+        active.send(msg);
+        double start = threadCpuMicroseconds();
+        server.update();
+        total += threadCpuMicroseconds() - start;
+    }
+
+    active.disconnect();
+    for (int fd : idle)
+        close(fd);
+    server.stop();
+
+    if (idle.size() != nbIdle)
+        std::cout << "  (only " << idle.size() << " idle connections could be opened)"
+                  << std::endl;
+    return total / BENCH_UPDATES;
+}
+
+int main()
+{
+    // Chaque connexion inactive consomme deux fds (client + serveur) dans ce processus
+    rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    signal(SIGPIPE, SIG_IGN);
+
+    // Le client et le serveur partagent ce processus: select() plafonne a FD_SETSIZE / 2
+    std::vector<size_t> selectSteps = {0, 100, 250, 450};
+    std::vector<size_t> epollSteps  = {0, 100, 250, 500, 900, 2000, 4000, 8000};
+
+    size_t port = BENCH_PORT;
+
+    std::cout << "CPU time per Server::update() with one active client" << std::endl;
+    std::cout << std::left << std::setw(10) << "backend" << std::setw(10) << "idle"
+              << "us/update" << std::endl;
+
+    for (size_t nbIdle : selectSteps)
+    {
+        double us = benchBackend(Server::Backend::SELECT, nbIdle, port++);
+        std::cout << std::left << std::setw(10) << "select" << std::setw(10) << nbIdle
+                  << std::fixed << std::setprecision(2) << us << std::endl;
+    }
+
+    for (size_t nbIdle : epollSteps)
+    {
+        if (nbIdle * 2 + 64 > limit.rlim_cur)
+            break;
+        double us = benchBackend(Server::Backend::EPOLL, nbIdle, port++);
+        std::cout << std::left << std::setw(10) << "epoll" << std::setw(10) << nbIdle
+                  << std::fixed << std::setprecision(2) << us << std::endl;
+    }
+
+    return 0;
+}
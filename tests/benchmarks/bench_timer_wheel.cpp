@@ -0,0 +1,139 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Delais d'inactivite de N connexions, 30 s de timeout, une verification toutes les 50 ms:
+// - scan: chaque tick parcourt toutes les connexions et compare leur derniere activite
+// - map: une echeance par connexion dans une std::map, deplacee a chaque reception
+// - wheel: TimerWheel, la reception ne touche qu'un horodatage (voir Server::_touch)
+// Un dixieme des connexions recoit quelque chose a chaque tick.
+
+static const int TICKS       = 200;
+static const int TIMEOUT_MS  = 30000;
+static const int TICK_MS     = IDLE_TIMER_TICK_MS;
+static const int ACTIVE_RATE = 10; // Une connexion sur 10 active par tick
+
+using Clock = TimerWheel::Clock;
+
+struct Result
+{
+    double nsPerTick;
+    size_t expired;
+};
+
+template <typename Tick>
+static Result run(Tick tick)
+{
+    Clock::time_point start   = Clock::now();
+    size_t            expired = 0;
+    for (int i = 1; i <= TICKS; i++)
+        expired += tick(i);
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    return {elapsed.count() * 1e9 / TICKS, expired};
+}
+
+static Result scan(size_t connections, Clock::time_point origin)
+{
+    std::vector<Clock::time_point> lastActivity(connections, origin);
+    return run(
+        [&](int i)
+        {
+            Clock::time_point now = origin + std::chrono::milliseconds(i * TICK_MS);
+            for (size_t fd = i % ACTIVE_RATE; fd < connections; fd += ACTIVE_RATE)
+                lastActivity[fd] = now;
+
+            size_t expired = 0;
+            for (size_t fd = 0; fd < connections; fd++)
+                if (now - lastActivity[fd] >= std::chrono::milliseconds(TIMEOUT_MS))
+                    expired++;
+            return expired;
+        });
+}
+
+static Result sortedMap(size_t connections, Clock::time_point origin)
+{
+    std::map<std::pair<Clock::time_point, size_t>, size_t> deadlines;
+    std::vector<Clock::time_point>                         deadlineOf(connections);
+    for (size_t fd = 0; fd < connections; fd++)
+    {
+        deadlineOf[fd] = origin + std::chrono::milliseconds(TIMEOUT_MS);
+        deadlines.emplace(std::make_pair(deadlineOf[fd], fd), fd);
+    }
+
+    return run(
+        [&](int i)
+        {
+            Clock::time_point now = origin + std::chrono::milliseconds(i * TICK_MS);
+            for (size_t fd = i % ACTIVE_RATE; fd < connections; fd += ACTIVE_RATE)
+            {
+                deadlines.erase(std::make_pair(deadlineOf[fd], fd));
+                deadlineOf[fd] = now + std::chrono::milliseconds(TIMEOUT_MS);
+                deadlines.emplace(std::make_pair(deadlineOf[fd], fd), fd);
+            }
+
+            size_t expired = 0;
+            while (!deadlines.empty() && deadlines.begin()->first.first <= now)
+            {
+                deadlines.erase(deadlines.begin());
+                expired++;
+            }
+            return expired;
+        });
+}
+
+static Result wheel(size_t connections, Clock::time_point origin)
+{
+    TimerWheel                     timers(std::chrono::milliseconds(TICK_MS), origin);
+    std::vector<Clock::time_point> lastActivity(connections, origin);
+    for (size_t fd = 0; fd < connections; fd++)
+        timers.schedule(fd, origin + std::chrono::milliseconds(TIMEOUT_MS));
+
+    return run(
+        [&](int i)
+        {
+            Clock::time_point now = origin + std::chrono::milliseconds(i * TICK_MS);
+            for (size_t fd = i % ACTIVE_RATE; fd < connections; fd += ACTIVE_RATE)
+                lastActivity[fd] = now;
+
+            // Un timer expire reverifie l'horodatage et se rearme s'il y a eu de l'activite
+            size_t expired = 0;
+            timers.advance(now,
+                           [&](size_t fd)
+                           {
+                               if (now - lastActivity[fd] >= std::chrono::milliseconds(TIMEOUT_MS))
+                                   expired++;
+                               else
+                                   timers.schedule(fd, lastActivity[fd] +
+                                                           std::chrono::milliseconds(TIMEOUT_MS));
+                           });
+            return expired;
+        });
+}
+
+int main()
+{
+    std::cout << "Idle timeouts, CPU ns per " << TICK_MS << " ms tick (" << TICKS
+              << " ticks, 1 connection in " << ACTIVE_RATE << " active per tick)" << std::endl;
+    std::cout << std::setw(12) << "connections" << std::setw(14) << "scan" << std::setw(14)
+              << "std::map" << std::setw(14) << "wheel" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+
+    for (size_t connections : {1000, 10000, 100000})
+    {
+        Clock::time_point origin = Clock::now();
+        Result            a      = scan(connections, origin);
+        Result            b      = sortedMap(connections, origin);
+        Result            c      = wheel(connections, origin);
+        if (a.expired != b.expired || b.expired != c.expired)
+            std::cout << "mismatch: " << a.expired << " " << b.expired << " " << c.expired
+                      << std::endl;
+
+        std::cout << std::setw(12) << connections << std::setw(14) << a.nsPerTick << std::setw(14)
+                  << b.nsPerTick << std::setw(14) << c.nsPerTick << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <signal.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../../libftpp.hpp"
+
+// Compare trois facons d'envoyer des rafales de messages sur une connexion:
+// - legacy: getSerializedData() puis un send() par message (copie + appel systeme)
+// - sendmsg: header et payload en iovecs, un sendmsg() par message, sans copie
+// - coalesced: les messages sont mis en file puis partent en un sendmsg() par rafale
+// Seul le temps CPU passe a envoyer est mesure, la lecture cote pair ne l'est pas.
+
+static const int    BURST  = 64;
+static const int    BURSTS = 2000;
+static const size_t SMALL  = 32;
+static const size_t LARGE  = 4096;
+
+static double threadCpuNanoseconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void drain(int fd)
+{
+    static unsigned char buffer[1 << 20];
+    while (recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) > 0)
+        ;
+}
+
+enum class Mode
+{
+    LEGACY,
+    SENDMSG,
+    COALESCED
+};
+
+struct Result
+{
+    double nsPerMsg;
+    double syscallsPerMsg;
+};
+
+static Result bench(Mode mode, size_t payloadSize)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+        return {0, 0};
+    int big = 4 << 20;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &big, sizeof(big));
+    setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &big, sizeof(big));
+
+    Message msg(1);
+    msg.appendBytes(std::vector<unsigned char>(payloadSize, 'x').data(), payloadSize);
+
+    OutputQueue outbox;
+    double      elapsed  = 0;
+    size_t      syscalls = 0;
+
+    for (int burst = 0; burst < BURSTS; burst++)
+    {
+        double start = threadCpuNanoseconds();
+        for (int i = 0; i < BURST; i++)
+        {
+            unsigned char header[MESSAGE_HEADER_SIZE];
+            iovec         iov[2];
+            if (mode != Mode::LEGACY)
+            {
+                msg.serializeHeader(header);
+                iov[0] = {header, MESSAGE_HEADER_SIZE};
+                iov[1] = {const_cast<unsigned char*>(msg.payload()), msg.payloadSize()};
+            }
+
+            if (mode == Mode::LEGACY)
+            {
+                auto bytes = msg.getSerializedData();
+                send(fds[0], bytes.data(), bytes.size(), MSG_NOSIGNAL);
+                syscalls++;
+            }
+            else if (mode == Mode::SENDMSG)
+            {
+                outbox.write(fds[0], iov, 2);
+                syscalls++;
+            }
+            else
+                outbox.push(iov, 2);
+        }
+        if (mode == Mode::COALESCED)
+        {
+            outbox.flush(fds[0]);
+            syscalls++;
+        }
+        elapsed += threadCpuNanoseconds() - start;
+        drain(fds[1]);
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+    double total = double(BURST) * BURSTS;
+    return {elapsed / total, syscalls / total};
+}
+
+int main()
+{
+    signal(SIGPIPE, SIG_IGN);
+
+    std::cout << "Bursts of " << BURST << " messages, CPU ns per message (syscalls per message)"
+              << std::endl;
+    std::cout << std::setw(10) << "payload" << std::setw(20) << "legacy send" << std::setw(20)
+              << "sendmsg" << std::setw(20) << "coalesced" << std::endl;
+
+    for (size_t payloadSize : {SMALL, LARGE})
+    {
+        std::cout << std::setw(10) << payloadSize;
+        for (Mode mode : {Mode::LEGACY, Mode::SENDMSG, Mode::COALESCED})
+        {
+            Result result = bench(mode, payloadSize);
+            std::cout << std::fixed << std::setprecision(0) << std::setw(12) << result.nsPerMsg
+                      << " (" << std::setprecision(3) << result.syscallsPerMsg << ")";
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
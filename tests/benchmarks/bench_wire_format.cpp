@@ -0,0 +1,73 @@
+#include <signal.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include "../../libftpp.hpp"
+
+// Debit client -> serveur de petits messages en loopback, selon le format du header.
+// Le client envoie des rafales, le serveur les distribue; les deux tournent dans ce thread.
+// Les octets sur le fil sont comptes header compris.
+
+static const size_t BENCH_PORT = 18750;
+static const int    MESSAGES   = 500000;
+static const int    BURST      = 1000;
+
+struct Result
+{
+    double bytesPerMsg;
+    double msgsPerSec;
+};
+
+static Result bench(Message::WireFormat format, size_t port)
+{
+    Server server("127.0.0.1", port, Server::Backend::EPOLL);
+    int    received = 0;
+    server.defineAction(1, [&received](long long&, const MessageView&) { received++; });
+    server.start();
+
+    Client client("127.0.0.1", port);
+    client.setWireFormat(format);
+    server.update();
+    client.update();
+
+    Message msg(1);
+    msg << 42 << static_cast<short>(7);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int sent = 0; sent < MESSAGES; sent += BURST)
+    {
+        for (int i = 0; i < BURST; i++)
+            client.send(msg);
+        // Le budget fait revenir update() des que la rafale est distribuee, sans attendre 10 ms
+        while (received < sent + BURST)
+        {
+            if (client.pendingOutput() > 0)
+                client.update();
+            server.update(sent + BURST - received);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    server.stop();
+    return {double(msg.getSerializedData(format).size()), MESSAGES / elapsed.count()};
+}
+
+int main()
+{
+    signal(SIGPIPE, SIG_IGN);
+
+    Result legacy  = bench(Message::WireFormat::LEGACY, BENCH_PORT);
+    Result compact = bench(Message::WireFormat::COMPACT, BENCH_PORT + 1);
+
+    std::cout << MESSAGES << " messages of 6 bytes of payload, client to server" << std::endl;
+    std::cout << std::setw(10) << "format" << std::setw(16) << "bytes/message" << std::setw(16)
+              << "messages/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << std::setw(10) << "legacy" << std::setw(16) << legacy.bytesPerMsg << std::setw(16)
+              << legacy.msgsPerSec << std::endl;
+    std::cout << std::setw(10) << "compact" << std::setw(16) << compact.bytesPerMsg
+              << std::setw(16) << compact.msgsPerSec << std::endl;
+    return 0;
+}
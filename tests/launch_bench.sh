@@ -0,0 +1,56 @@
+#!/bin/bash
+
+# Build and launch all benchmark programs
+
+# Benchmarks are compiled with optimizations, directly against the sources,
+# so the numbers do not depend on how libftpp.a was built.
+LIB_SRCS=$(find src -name "*.cpp")
+
+TOTAL_BENCHS=0
+FAILED_BENCHS=0
+
+echo "================================================"
+echo "Running all benchmarks..."
+echo "================================================"
+
+for bench_file in tests/benchmarks/bench_*.cpp; do
+    if [ -f "$bench_file" ]; then
+
+        bench_name=$(basename "$bench_file" .cpp)
+
+        if [ -n "$1" ] && [ "$1" != "$bench_name" ]; then
+            continue
+        fi
+
+        echo ""
+        echo ">>> Benchmark: $bench_name"
+        echo "----------------------------------------"
+
+        g++ -std=c++17 -O2 -DNDEBUG -Wall -Wextra -Werror \
+            -I./src \
+            "$bench_file" \
+            $LIB_SRCS \
+            -pthread \
+            -o tests/"$bench_name"
+
+        if [ $? -ne 0 ]; then
+            echo "❌ COMPILATION FAILED: $bench_name"
+            FAILED_BENCHS=$((FAILED_BENCHS + 1))
+        else
+            ./tests/"$bench_name"
+            if [ $? -ne 0 ]; then
+                echo "❌ BENCHMARK FAILED: $bench_name"
+                FAILED_BENCHS=$((FAILED_BENCHS + 1))
+            fi
+        fi
+
+        TOTAL_BENCHS=$((TOTAL_BENCHS + 1))
+    fi
+done
+
+echo ""
+echo "================================================"
+echo "Benchmarks: $TOTAL_BENCHS, failed: $FAILED_BENCHS"
+echo "================================================"
+
+[ $FAILED_BENCHS -eq 0 ]
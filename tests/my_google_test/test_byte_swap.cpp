@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "libftpp.hpp"
+
+TEST(ByteSwapTest, ValueReversesBytes)
+{
+    EXPECT_EQ(ByteSwap::value(uint16_t(0x1122)), 0x2211);
+    EXPECT_EQ(ByteSwap::value(uint32_t(0x11223344)), 0x44332211u);
+    EXPECT_EQ(ByteSwap::value(uint64_t(0x1122334455667788ULL)), 0x8877665544332211ULL);
+    EXPECT_EQ(ByteSwap::value(char(7)), 7);
+    EXPECT_EQ(ByteSwap::value(ByteSwap::value(-2.5)), -2.5);
+}
+
+TEST(ByteSwapTest, CopyMatchesByteReversalForEveryWidthAndLength)
+{
+    for (size_t width : {1, 2, 4, 8})
+        for (size_t count = 0; count < 40; count++)
+        {
+            // Decale d'un octet: les blocs SSSE3 ne sont pas alignes
+            std::vector<unsigned char> src(count * width + 1);
+            for (size_t i = 0; i < src.size(); i++)
+                src[i] = static_cast<unsigned char>(i * 7 + 1);
+
+            std::vector<unsigned char> expected(count * width);
+            for (size_t i = 0; i < count; i++)
+                for (size_t b = 0; b < width; b++)
+                    expected[i * width + b] = src[1 + i * width + width - 1 - b];
+
+            std::vector<unsigned char> dst(count * width + 1);
+            ByteSwap::copy(dst.data() + 1, src.data() + 1, count, width);
+            EXPECT_EQ(std::vector<unsigned char>(dst.begin() + 1, dst.end()), expected);
+
+            ByteSwap::copy(src.data() + 1, src.data() + 1, count, width);
+            EXPECT_EQ(std::vector<unsigned char>(src.begin() + 1, src.end()), expected);
+        }
+
+    unsigned char byte = 0;
+    EXPECT_THROW(ByteSwap::copy(&byte, &byte, 1, 3), std::invalid_argument);
+}
@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "libftpp.hpp"
+
+TEST(ChunkPoolTest, ReleasedChunksAreReused)
+{
+    std::shared_ptr<ChunkPool> pool = std::make_shared<ChunkPool>(64, 2);
+
+    ChunkPool::Chunk first = pool->acquire();
+    EXPECT_TRUE(first->empty());
+    EXPECT_GE(first->capacity(), 64u);
+    first->assign(64, 'x');
+
+    const unsigned char* storage = first->data();
+    first.reset();
+    EXPECT_EQ(pool->available(), 1u);
+
+    // Meme memoire, rendue vide
+    ChunkPool::Chunk again = pool->acquire();
+    EXPECT_EQ(again->data(), storage);
+    EXPECT_TRUE(again->empty());
+    EXPECT_EQ(pool->available(), 0u);
+
+    // Au-dela de maxFree les chunks sont liberes
+    std::vector<ChunkPool::Chunk> chunks;
+    for (int i = 0; i < 4; i++)
+        chunks.push_back(pool->acquire());
+    chunks.clear();
+    EXPECT_EQ(pool->available(), 2u);
+    EXPECT_THROW(ChunkPool(0), std::invalid_argument);
+}
+
+TEST(ChunkPoolTest, ChunksOutliveThePoolHandleAndComeBackFromOtherThreads)
+{
+    ChunkPool::Chunk chunk;
+    std::weak_ptr<ChunkPool> weak;
+    {
+        std::shared_ptr<ChunkPool> pool = std::make_shared<ChunkPool>(16);
+        weak                            = pool;
+        chunk                           = pool->acquire();
+    }
+    EXPECT_FALSE(weak.expired());
+
+    std::thread([&chunk]() { chunk.reset(); }).join();
+    EXPECT_TRUE(weak.expired());
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <set>
+#include <vector>
+
+#include "libftpp.hpp"
+
+using namespace std::chrono_literals;
+
+// Serveur et pool tournent dans le meme thread: on alterne les update()
+static bool pump(Server& server, ClientPool& pool, const std::function<bool()>& done)
+{
+    const auto deadline = std::chrono::steady_clock::now() + 3s;
+    while (!done() && std::chrono::steady_clock::now() < deadline)
+    {
+        server.update(0, 1ms);
+        pool.update(0, 1ms);
+    }
+    return done();
+}
+
+TEST(ClientPoolTest, ChannelsAreDistinctServerClients)
+{
+    const size_t port = 19300;
+    Server       server("127.0.0.1", port, Server::Backend::EPOLL);
+
+    std::set<long long> ids;
+    server.defineAction(1,
+                        [&](long long& clientID, const MessageView& msg)
+                        {
+                            ids.insert(clientID);
+                            int value;
+                            msg >> value;
+                            Message reply(2);
+                            reply << value;
+                            server.sendTo(reply, clientID);
+                        });
+    server.start();
+
+    ClientPool pool("127.0.0.1", port, 2);
+    EXPECT_EQ(pool.connections(), 2u);
+
+    std::vector<ClientPool::Channel> channels;
+    std::vector<std::vector<int>>    replies(6);
+    for (size_t i = 0; i < replies.size(); i++)
+    {
+        channels.push_back(pool.open());
+        channels[i].defineAction(2,
+                                 [&replies, i](const MessageView& msg)
+                                 {
+                                     int value;
+                                     msg >> value;
+                                     replies[i].push_back(value);
+                                 });
+    }
+    EXPECT_EQ(pool.channels(), 6u);
+
+    for (auto& channel : channels)
+    {
+        Message msg(1);
+        msg << static_cast<int>(channel.id());
+        channel.send(msg);
+    }
+
+    ASSERT_TRUE(pump(server, pool, [&]() { return ids.size() == 6; }));
+    ASSERT_TRUE(pump(server, pool,
+                     [&]()
+                     {
+                         for (auto& received : replies)
+                             if (received.empty())
+                                 return false;
+                         return true;
+                     }));
+
+    // Chaque canal ne recoit que sa propre reponse
+    for (size_t i = 0; i < replies.size(); i++)
+        EXPECT_EQ(replies[i], std::vector<int>{static_cast<int>(i)});
+    server.stop();
+}
+
+TEST(ClientPoolTest, CallsAreMatchedPerChannel)
+{
+    const size_t port = 19301;
+    Server       server("127.0.0.1", port);
+
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView& request)
+                        {
+                            int value;
+                            request >> value;
+                            Message response(2);
+                            response << value * 10;
+                            server.reply(clientID, request, response);
+                        });
+    server.start();
+
+    ClientPool pool("127.0.0.1", port, 3);
+    pool.setWireFormat(Message::WireFormat::COMPACT);
+
+    std::vector<std::future<Message>> answers;
+    for (int i = 0; i < 9; i++)
+    {
+        ClientPool::Channel channel = pool.open();
+        Message             request(1);
+        request << i;
+        answers.push_back(channel.call(request));
+    }
+    EXPECT_EQ(pool.pendingCalls(), 9u);
+
+    ASSERT_TRUE(pump(server, pool, [&]() { return pool.pendingCalls() == 0; }));
+    for (int i = 0; i < 9; i++)
+    {
+        int value;
+        answers[i].get() >> value;
+        EXPECT_EQ(value, i * 10);
+    }
+    server.stop();
+}
+
+TEST(ClientPoolTest, SendToAllReachesEveryChannel)
+{
+    const size_t port = 19302;
+    Server       server("127.0.0.1", port);
+
+    std::set<long long> ids;
+    server.defineAction(1,
+                        [&ids](long long& clientID, const MessageView&) { ids.insert(clientID); });
+    server.start();
+
+    ClientPool       pool("127.0.0.1", port, 2);
+    std::vector<int> received(5, 0);
+    for (size_t i = 0; i < received.size(); i++)
+    {
+        ClientPool::Channel channel = pool.open();
+        channel.defineAction(3, [&received, i](const MessageView&) { received[i]++; });
+        channel.send(Message(1));
+    }
+    ASSERT_TRUE(pump(server, pool, [&]() { return ids.size() == 5; }));
+
+    server.sendToAll(Message(3));
+    ASSERT_TRUE(pump(server, pool,
+                     [&]()
+                     {
+                         for (int count : received)
+                             if (count == 0)
+                                 return false;
+                         return true;
+                     }));
+    EXPECT_EQ(received, std::vector<int>(5, 1));
+    server.stop();
+}
+
+TEST(ClientPoolTest, TooManyChannelsDropsTheConnection)
+{
+    const size_t port = 19303;
+    Server       server("127.0.0.1", port);
+    server.setMaxChannels(4);
+
+    std::set<long long> ids;
+    server.defineAction(1,
+                        [&ids](long long& clientID, const MessageView&) { ids.insert(clientID); });
+    server.start();
+
+    // Une seule connexion: le canal 0 est la connexion elle-meme, les suivants des sessions
+    ClientPool                       pool("127.0.0.1", port, 1);
+    std::vector<ClientPool::Channel> channels;
+    for (int i = 0; i < 6; i++)
+        channels.push_back(pool.open());
+
+    Message msg(1);
+    for (int i = 0; i < 5; i++)
+        channels[i].send(msg);
+    ASSERT_TRUE(pump(server, pool, [&]() { return ids.size() == 5; }));
+    EXPECT_EQ(server.metrics().droppedClients, 0u);
+
+    // Un canal de plus que la limite: la connexion est fermee
+    channels[5].send(msg);
+    ASSERT_TRUE(pump(server, pool, [&]() { return server.metrics().droppedClients == 1; }));
+    EXPECT_EQ(server.metrics().channelFloods, 1u);
+    EXPECT_EQ(ids.size(), 5u);
+    server.stop();
+}
@@ -78,3 +78,257 @@ TEST(DataBufferTest, EmptyBuffer)
 
     EXPECT_THROW(buf >> y, std::out_of_range);
 }
+
+TEST(DataBufferTest, ViewExposesUnreadBytesWithoutCopy)
+{
+    DataBuffer buf;
+    int        x = 7;
+    buf << x << std::string("abc");
+
+    DataBuffer::View all = buf.view();
+    EXPECT_EQ(all.size(), buf.size());
+    EXPECT_EQ(all.data(), buf.rawData());
+
+    buf.increaseCursor(sizeof(int) + sizeof(size_t));
+    DataBuffer::View text = buf.view(3);
+    EXPECT_EQ(std::string(text.begin(), text.end()), "abc");
+    EXPECT_EQ(text[1], 'b');
+    EXPECT_TRUE(buf.view(0).empty());
+    EXPECT_THROW(buf.view(4), std::out_of_range);
+
+    buf.increaseCursor(3);
+    EXPECT_TRUE(buf.view().empty());
+}
+
+TEST(DataBufferTest, CompactKeepsUnreadBytes)
+{
+    DataBuffer buf;
+    int        a = 1, b = 2, read = 0;
+    buf << a << b;
+    buf >> read;
+
+    buf.compact();
+    EXPECT_EQ(buf.size(), sizeof(int));
+    buf.reset();
+    buf >> read;
+    EXPECT_EQ(read, b);
+    EXPECT_THROW(buf.decreaseCursor(sizeof(int) + 1), std::out_of_range);
+}
+
+TEST(DataBufferTest, AutoCompactKeepsStreamingFootprintFlat)
+{
+    DataBuffer buf;
+    buf.setAutoCompact(true);
+
+    // Producteur en avance de 100 valeurs sur le consommateur
+    size_t next = 0, expected = 0, value = 0;
+    for (; next < 100; next++)
+        buf << next;
+
+    size_t capacity = 0;
+    for (int i = 0; i < 100000; i++)
+    {
+        buf << next++;
+        buf >> value;
+        ASSERT_EQ(value, expected++);
+        if (i == 10000)
+            capacity = buf.capacity();
+    }
+    EXPECT_EQ(buf.size(), 100 * sizeof(size_t));
+    EXPECT_LE(buf.capacity(), capacity);
+    EXPECT_LE(buf.capacity(), 4 * DATA_BUFFER_COMPACT_MIN);
+}
+
+TEST(DataBufferTest, ChunkedStorageReadsAcrossChunks)
+{
+    std::shared_ptr<ChunkPool> pool = std::make_shared<ChunkPool>(16);
+    DataBuffer                 buf(pool);
+    EXPECT_TRUE(buf.chunked());
+
+    std::string text(40, 'a');
+    text[39] = 'z';
+    int    x = 42, y = 0;
+    double d = 1.5, e = 0;
+    buf << x << text << d;
+    EXPECT_EQ(buf.size(), sizeof(int) + sizeof(size_t) + 40 + sizeof(double));
+    EXPECT_EQ(buf.capacity(), 4 * 16u);
+    EXPECT_EQ(buf.views().size(), 4u);
+    EXPECT_EQ(buf.data().size(), buf.size());
+    EXPECT_THROW(buf.rawData(), std::logic_error);
+    EXPECT_THROW(buf.view(), std::logic_error);
+
+    // Les copies ne partagent pas leurs chunks
+    DataBuffer copy = buf;
+    copy << 7;
+
+    std::string read;
+    buf >> y >> read >> e;
+    EXPECT_EQ(y, x);
+    EXPECT_EQ(read, text);
+    EXPECT_DOUBLE_EQ(e, d);
+    EXPECT_THROW(buf >> y, std::out_of_range);
+
+    EXPECT_EQ(copy.size(), 64u);
+    copy >> y;
+    EXPECT_EQ(y, x);
+}
+
+TEST(DataBufferTest, MovesKeepTheirStorage)
+{
+    static_assert(std::is_nothrow_move_constructible<DataBuffer>::value, "");
+    static_assert(std::is_nothrow_move_constructible<Message>::value, "");
+
+    DataBuffer buf;
+    buf << 42 << std::string("moved");
+    const unsigned char* storage = buf.rawData();
+
+    // Un deplacement reprend le buffer au lieu de le recopier
+    DataBuffer moved(std::move(buf));
+    EXPECT_EQ(moved.rawData(), storage);
+
+    DataBuffer assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.rawData(), storage);
+
+    int         value;
+    std::string text;
+    assigned >> value >> text;
+    EXPECT_EQ(value, 42);
+    EXPECT_EQ(text, "moved");
+
+    // Le buffer deplace repart vide et se relit normalement
+    EXPECT_EQ(buf.size(), 0u);
+    buf << 7;
+    buf >> value;
+    EXPECT_EQ(value, 7);
+    EXPECT_EQ(moved.size(), 0u);
+}
+
+TEST(DataBufferTest, ChunkedStorageRecyclesReadChunks)
+{
+    std::shared_ptr<ChunkPool> pool = std::make_shared<ChunkPool>(64);
+    DataBuffer                 buf(pool);
+
+    size_t next = 0, expected = 0, value = 0;
+    for (; next < 20; next++)
+        buf << next;
+    for (int i = 0; i < 10000; i++)
+    {
+        buf << next++;
+        buf >> value;
+        ASSERT_EQ(value, expected++);
+    }
+    EXPECT_LE(buf.capacity(), 4 * 64u);
+
+    // Tout lu: les chunks pleins reviennent au pool a la prochaine ecriture
+    buf.increaseCursor(buf.size());
+    buf << next;
+    EXPECT_EQ(buf.capacity(), 64u);
+    EXPECT_GE(pool->available(), 1u);
+}
+
+TEST(DataBufferTest, TakeChunksHandsUnreadBytesOver)
+{
+    std::shared_ptr<ChunkPool> pool = std::make_shared<ChunkPool>(8);
+    DataBuffer                 buf(pool);
+    std::vector<unsigned char> bytes(20);
+    for (size_t i = 0; i < bytes.size(); i++)
+        bytes[i] = static_cast<unsigned char>(i);
+    buf.append(bytes.data(), bytes.size());
+    buf.increaseCursor(3);
+
+    std::vector<DataBuffer::Chunk> chunks = buf.takeChunks();
+    EXPECT_EQ(buf.size(), 0u);
+    ASSERT_EQ(chunks.size(), 3u);
+
+    std::vector<unsigned char> joined;
+    for (const DataBuffer::Chunk& chunk : chunks)
+        joined.insert(joined.end(), chunk.data->begin() + chunk.offset, chunk.data->end());
+    EXPECT_EQ(joined, std::vector<unsigned char>(bytes.begin() + 3, bytes.end()));
+
+    // Buffer contigu: son vector est remis tel quel
+    DataBuffer contiguous;
+    contiguous.append(bytes.data(), bytes.size());
+    contiguous.increaseCursor(5);
+    std::vector<DataBuffer::Chunk> whole = contiguous.takeChunks();
+    ASSERT_EQ(whole.size(), 1u);
+    EXPECT_EQ(whole[0].offset, 5u);
+    EXPECT_EQ(whole[0].data->size(), bytes.size());
+}
+
+TEST(DataBufferTest, BigEndianArraysAreInNetworkOrder)
+{
+    uint32_t   words[3] = {0x01020304, 0x05060708, 0x090A0B0C};
+    DataBuffer buf;
+    buf.appendBigEndian(words, 3);
+
+    ASSERT_EQ(buf.size(), sizeof(words));
+    for (size_t i = 0; i < sizeof(words); i++)
+        EXPECT_EQ(buf.view()[i], i + 1);
+
+    uint32_t read[3];
+    buf.readBigEndian(read, 3);
+    EXPECT_EQ(read[2], words[2]);
+    EXPECT_THROW(buf.readBigEndian(read, 1), std::out_of_range);
+
+    // En mode chunks, sur plusieurs chunks et plusieurs blocs de conversion
+    std::shared_ptr<ChunkPool> pool = std::make_shared<ChunkPool>(64);
+    DataBuffer                 chunked(pool);
+    std::vector<double>        values(1000);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = i * 0.5;
+    chunked.appendBigEndian(values.data(), values.size());
+
+    std::vector<double> back(values.size());
+    chunked.readBigEndian(back.data(), back.size());
+    EXPECT_EQ(back, values);
+}
+
+TEST(DataBufferTest, PortableEncodingHasAFixedByteLayout)
+{
+    DataBuffer buf;
+    buf.setEncoding(DataBuffer::Encoding::PORTABLE);
+    buf << int32_t(42) << std::string("alice") << std::vector<float>{1.5f, 2.5f};
+
+    // Little endian, longueurs en varints: les memes octets sur toutes les machines
+    std::vector<unsigned char> expected = {0x2a, 0x00, 0x00, 0x00, 0x05, 'a',  'l',  'i',  'c',
+                                           'e',  0x02, 0x00, 0x00, 0xc0, 0x3f, 0x00, 0x00, 0x20,
+                                           0x40};
+    EXPECT_EQ(buf.data(), expected);
+
+    DataBuffer copy = buf;
+    EXPECT_TRUE(copy.portable());
+
+    int32_t            number;
+    std::string        name;
+    std::vector<float> values;
+    copy >> number >> name >> values;
+    EXPECT_EQ(number, 42);
+    EXPECT_EQ(name, "alice");
+    EXPECT_EQ(values, (std::vector<float>{1.5f, 2.5f}));
+
+    // Meme contenu en encodage hote: les longueurs sont des size_t
+    DataBuffer host;
+    host << int32_t(42) << std::string("alice") << std::vector<float>{1.5f, 2.5f};
+    EXPECT_EQ(host.size(), expected.size() + 2 * (sizeof(size_t) - 1));
+}
+
+TEST(DataBufferTest, VarintsRoundTripAndRejectBadInput)
+{
+    DataBuffer buf;
+    for (uint64_t value : {0ull, 127ull, 128ull, 300ull, ~0ull})
+        buf.appendVarint(value);
+    EXPECT_EQ(buf.size(), 1u + 1u + 2u + 2u + 10u);
+    for (uint64_t value : {0ull, 127ull, 128ull, 300ull, ~0ull})
+        EXPECT_EQ(buf.readVarint(), value);
+
+    // Varint coupe: le curseur ne bouge pas
+    unsigned char truncated[2] = {0x80, 0x80};
+    buf.append(truncated, 2);
+    EXPECT_THROW(buf.readVarint(), std::out_of_range);
+    EXPECT_EQ(buf.size(), 2u);
+
+    std::vector<unsigned char> tooLong(11, 0x80);
+    buf.append(tooLong.data(), tooLong.size());
+    EXPECT_THROW(buf.readVarint(), std::runtime_error);
+}
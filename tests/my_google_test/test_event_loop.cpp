@@ -0,0 +1,385 @@
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "libftpp.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(EventLoopTest, HandlerSeesReadableFd)
+{
+    EventLoop loop;
+    int       fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    int calls = 0;
+    loop.add(fds[0], EPOLLIN,
+             [&](uint32_t events)
+             {
+                 EXPECT_TRUE(events & EPOLLIN);
+                 char c;
+                 EXPECT_EQ(read(fds[0], &c, 1), 1);
+                 calls++;
+             });
+    EXPECT_TRUE(loop.watches(fds[0]));
+    EXPECT_EQ(loop.runOnce(0), 0u);
+
+    ASSERT_EQ(write(fds[1], "x", 1), 1);
+    EXPECT_EQ(loop.runOnce(100), 1u);
+    EXPECT_EQ(calls, 1);
+
+    loop.remove(fds[0]);
+    EXPECT_FALSE(loop.watches(fds[0]));
+    ASSERT_EQ(write(fds[1], "x", 1), 1);
+    EXPECT_EQ(loop.runOnce(0), 0u);
+    EXPECT_THROW(loop.modify(fds[0], EPOLLIN), std::invalid_argument);
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(EventLoopTest, HandlerCanRemoveOtherRegistrations)
+{
+    EventLoop loop;
+    int       first[2];
+    int       second[2];
+    ASSERT_EQ(pipe(first), 0);
+    ASSERT_EQ(pipe(second), 0);
+
+    // Le premier appele retire l'autre: l'evenement deja recu pour lui est ignore
+    int calls = 0;
+    loop.add(first[0], EPOLLIN,
+             [&](uint32_t)
+             {
+                 calls++;
+                 loop.remove(first[0]);
+                 loop.remove(second[0]);
+             });
+    loop.add(second[0], EPOLLIN,
+             [&](uint32_t)
+             {
+                 calls++;
+                 loop.remove(first[0]);
+                 loop.remove(second[0]);
+             });
+
+    ASSERT_EQ(write(first[1], "x", 1), 1);
+    ASSERT_EQ(write(second[1], "x", 1), 1);
+    EXPECT_EQ(loop.runOnce(100), 1u);
+    EXPECT_EQ(calls, 1);
+
+    for (int fd : {first[0], first[1], second[0], second[1]})
+        close(fd);
+}
+
+TEST(EventLoopTest, TimersFireInOrderAndCanBeCancelled)
+{
+    EventLoop        loop;
+    std::vector<int> fired;
+
+    loop.addTimer(20ms, [&]() { fired.push_back(2); });
+    loop.addTimer(5ms, [&]() { fired.push_back(1); });
+    EventLoop::TimerId cancelled = loop.addTimer(10ms, [&]() { fired.push_back(3); });
+    EXPECT_TRUE(loop.cancelTimer(cancelled));
+    EXPECT_FALSE(loop.cancelTimer(cancelled));
+    EXPECT_EQ(loop.timers(), 2u);
+
+    // L'attente est raccourcie jusqu'a l'echeance: pas besoin d'evenement reseau
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (fired.size() < 2 && std::chrono::steady_clock::now() < deadline)
+        loop.runOnce(-1);
+
+    EXPECT_EQ(fired, (std::vector<int>{1, 2}));
+    EXPECT_EQ(loop.timers(), 0u);
+}
+
+TEST(EventLoopTest, PeriodicTimerCancelsItself)
+{
+    EventLoop          loop;
+    int                ticks = 0;
+    EventLoop::TimerId id    = 0;
+
+    id = loop.addTimer(
+        1ms,
+        [&]()
+        {
+            if (++ticks == 3)
+                loop.cancelTimer(id);
+        },
+        1ms);
+
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (loop.timers() > 0 && std::chrono::steady_clock::now() < deadline)
+        loop.runOnce(-1);
+    EXPECT_EQ(ticks, 3);
+}
+
+TEST(EventLoopTest, PostAndStopFromAnotherThread)
+{
+    EventLoop        loop;
+    std::atomic<int> ran{0};
+
+    std::thread producer(
+        [&]()
+        {
+            std::this_thread::sleep_for(10ms);
+            for (int i = 0; i < 100; i++)
+                loop.post([&ran]() { ran++; });
+            loop.post([&loop]() { loop.stop(); });
+        });
+
+    // run() attend sans limite: seuls les post() peuvent le reveiller
+    loop.run();
+    producer.join();
+    EXPECT_EQ(ran, 100);
+}
+
+TEST(EventLoopTest, EachStopEndsOneRunEvenBeforeIt)
+{
+    EventLoop loop;
+
+    // Le stop() arrive avant que run() ne demarre: run() rend la main tout de suite
+    loop.stop();
+    loop.run();
+
+    // Le stop() est consomme: la boucle tourne de nouveau jusqu'au suivant
+    int ran = 0;
+    loop.post([&ran]() { ran++; });
+    loop.addTimer(5ms, [&loop]() { loop.stop(); });
+    loop.run();
+    EXPECT_EQ(ran, 1);
+
+    loop.stop();
+    loop.run();
+    EXPECT_EQ(loop.timers(), 0u);
+}
+
+TEST(EventLoopTest, ThrowingTimerDoesNotStallTheRound)
+{
+    EventLoop loop;
+    int       ran = 0;
+
+    loop.addTimer(0ms, []() { throw std::runtime_error("timer failed"); });
+    loop.addTimer(0ms, [&ran]() { ran++; });
+    loop.post([&ran]() { ran++; });
+    std::this_thread::sleep_for(2ms);
+
+    // Les autres timers et taches passent, puis la premiere exception remonte
+    EXPECT_THROW(loop.runOnce(0), std::runtime_error);
+    EXPECT_EQ(ran, 2);
+    EXPECT_EQ(loop.timers(), 0u);
+    EXPECT_EQ(loop.runOnce(0), 0u);
+}
+
+TEST(EventLoopTest, ServerAndClientsShareOneLoop)
+{
+    const size_t port = 19310;
+    EventLoop    loop;
+
+    Server server("127.0.0.1", port, Server::Backend::EPOLL);
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView& msg)
+                        {
+                            int value;
+                            msg >> value;
+                            Message reply(2);
+                            reply << value + 1;
+                            server.sendTo(reply, clientID);
+                        });
+    server.attach(loop);
+    server.start();
+
+    std::vector<Client> clients(3);
+    std::vector<int>    replies(clients.size(), 0);
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        clients[i].attach(loop);
+        clients[i].connect("127.0.0.1", port);
+        clients[i].defineAction(2, [&replies, i](const MessageView& msg) { msg >> replies[i]; });
+
+        Message msg(1);
+        msg << static_cast<int>(i * 10);
+        clients[i].send(msg);
+    }
+
+    // Ni server.update() ni client.update(): la boucle seule fait tout tourner
+    auto deadline = std::chrono::steady_clock::now() + 3s;
+    while ((replies[0] == 0 || replies[1] == 0 || replies[2] == 0) &&
+           std::chrono::steady_clock::now() < deadline)
+        loop.runOnce(10);
+
+    EXPECT_EQ(replies, (std::vector<int>{1, 11, 21}));
+
+    for (auto& client : clients)
+        client.disconnect();
+    server.stop();
+}
+
+TEST(EventLoopTest, ThrowingHandlerDoesNotStallTheRestOfTheBatch)
+{
+    const size_t port    = 19311;
+    const size_t rawPort = 19312;
+    EventLoop    loop;
+
+    Server server("127.0.0.1", port, Server::Backend::EPOLL);
+    server.attach(loop);
+    server.start();
+
+    // Pair brut du client fautif: lui seul peut envoyer un header invalide
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int opt      = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    sockaddr_in addr     = {};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(rawPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(listen(listener, 1), 0);
+
+    Client broken;
+    broken.attach(loop);
+    broken.connect("127.0.0.1", rawPort);
+    int peer = accept(listener, nullptr, nullptr);
+    ASSERT_GE(peer, 0);
+
+    Client healthy;
+    int    received = 0;
+    healthy.attach(loop);
+    healthy.connect("127.0.0.1", port);
+    healthy.defineAction(2, [&received](const MessageView& msg) { msg >> received; });
+    for (int round = 0; round < 10; round++)
+        loop.runOnce(10);
+
+    // Changement de format inconnu, puis un message pour l'autre client: les deux evenements
+    // (EPOLLET) arrivent dans le meme epoll_wait(), le fautif en premier
+    unsigned char bad[sizeof(int) + sizeof(size_t) + 1];
+    int           type = INT_MIN;
+    size_t        size = 1;
+    memcpy(bad, &type, sizeof(type));
+    memcpy(bad + sizeof(type), &size, sizeof(size));
+    bad[sizeof(bad) - 1] = 0x7F;
+    ASSERT_EQ(write(peer, bad, sizeof(bad)), static_cast<ssize_t>(sizeof(bad)));
+    std::this_thread::sleep_for(20ms);
+
+    Message msg(2);
+    msg << 7;
+    server.sendToAll(msg);
+    std::this_thread::sleep_for(20ms);
+
+    bool threw    = false;
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (received == 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        try
+        {
+            loop.runOnce(10);
+        }
+        catch (const std::runtime_error&)
+        {
+            threw = true;
+        }
+    }
+
+    EXPECT_TRUE(threw);
+    EXPECT_EQ(received, 7);
+
+    healthy.disconnect();
+    server.stop();
+    close(peer);
+    close(listener);
+}
+
+TEST(EventLoopTest, ThrottledServerResumesFromTimer)
+{
+    const size_t port = 19311;
+    EventLoop    loop;
+
+    Server server("127.0.0.1", port, Server::Backend::EPOLL);
+    server.setRateLimit(0, 1000, 10ms);
+
+    int received = 0;
+    server.defineAction(1, [&received](long long&, const MessageView&) { received++; });
+    server.attach(loop);
+    server.start();
+
+    Client client;
+    client.attach(loop);
+    client.connect("127.0.0.1", port);
+    for (int i = 0; i < 100; i++)
+    {
+        Message msg(1);
+        msg << i;
+        client.send(msg);
+    }
+
+    // Plus aucun evenement reseau une fois tout recu: seul le timer de reprise reveille la boucle
+    auto deadline = std::chrono::steady_clock::now() + 3s;
+    while (received < 100 && std::chrono::steady_clock::now() < deadline)
+        loop.runOnce(10);
+
+    EXPECT_EQ(received, 100);
+    EXPECT_GE(server.metrics().throttleEvents, 1u);
+
+    client.disconnect();
+    server.stop();
+}
+
+TEST(EventLoopTest, IdleTimeoutRunsFromLoopTimer)
+{
+    const size_t port = 19312;
+    EventLoop    loop;
+
+    Server server("127.0.0.1", port, Server::Backend::EPOLL);
+    server.setIdleTimeout(200ms, 50ms);
+
+    int received = 0;
+    server.defineAction(1, [&received](long long&, const MessageView&) { received++; });
+    server.attach(loop);
+    server.start();
+
+    // Le client attache repond aux pings depuis la boucle, l'autre n'est jamais mis a jour
+    Client attached;
+    attached.attach(loop);
+    attached.connect("127.0.0.1", port);
+    Client silent("127.0.0.1", port);
+
+    auto deadline = std::chrono::steady_clock::now() + 3s;
+    while (server.metrics().idleClients == 0 && std::chrono::steady_clock::now() < deadline)
+        loop.runOnce(10);
+    EXPECT_EQ(server.metrics().idleClients, 1u);
+    EXPECT_GE(server.metrics().pingsSent, 2u);
+
+    // Toujours connecte bien apres le delai d'inactivite
+    auto later = std::chrono::steady_clock::now() + 300ms;
+    while (std::chrono::steady_clock::now() < later)
+        loop.runOnce(10);
+    Message msg(1);
+    msg << 1;
+    attached.send(msg);
+    deadline = std::chrono::steady_clock::now() + 3s;
+    while (received == 0 && std::chrono::steady_clock::now() < deadline)
+        loop.runOnce(10);
+    EXPECT_EQ(received, 1);
+
+    attached.disconnect();
+    server.stop();
+}
+
+TEST(EventLoopTest, AttachRequiresEpollBackend)
+{
+    EventLoop loop;
+    Server    server(Server::Backend::SELECT);
+    EXPECT_THROW(server.attach(loop), std::invalid_argument);
+
+    Client client(Client::Backend::IO_URING);
+    EXPECT_THROW(client.attach(loop), std::invalid_argument);
+}
@@ -0,0 +1,400 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "libftpp.hpp"
+
+static std::vector<unsigned char> serialize(Message::Type type, int value, const std::string& text)
+{
+    Message msg(type);
+    msg << value << text;
+    return msg.getSerializedData();
+}
+
+TEST(FrameBufferTest, ExtractsCompleteFrames)
+{
+    FrameBuffer inbox;
+    auto        first  = serialize(1, 42, "hello");
+    auto        second = serialize(2, 7, "world");
+
+    inbox.append(first.data(), first.size());
+    inbox.append(second.data(), second.size());
+
+    EXPECT_EQ(inbox.extract(), 2u);
+    ASSERT_EQ(inbox.frames().size(), 2u);
+
+    int         value;
+    std::string text;
+    MessageView view = inbox.view(inbox.frames()[1]);
+    view >> value >> text;
+
+    EXPECT_EQ(view.type(), 2);
+    EXPECT_EQ(value, 7);
+    EXPECT_EQ(text, "world");
+    EXPECT_EQ(view.size(), 0u);
+}
+
+TEST(FrameBufferTest, KeepsPartialFrameAcrossRelease)
+{
+    FrameBuffer inbox;
+    auto        first  = serialize(1, 1, "complete");
+    auto        second = serialize(2, 2, "split in two");
+
+    inbox.append(first.data(), first.size());
+    inbox.append(second.data(), 5);
+
+    EXPECT_EQ(inbox.extract(), 1u);
+    EXPECT_EQ(inbox.pending(), 5u);
+
+    inbox.release();
+    EXPECT_TRUE(inbox.frames().empty());
+    EXPECT_EQ(inbox.pending(), 5u);
+
+    inbox.append(second.data() + 5, second.size() - 5);
+    ASSERT_EQ(inbox.extract(), 1u);
+
+    int         value;
+    std::string text;
+    inbox.view(inbox.frames()[0]) >> value >> text;
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(text, "split in two");
+}
+
+TEST(FrameBufferTest, ReleaseCountKeepsRemainingFrames)
+{
+    FrameBuffer inbox;
+    auto        partial = serialize(4, 4, "not yet");
+    for (int i = 0; i < 3; i++)
+    {
+        auto bytes = serialize(1, i, "frame " + std::to_string(i));
+        inbox.append(bytes.data(), bytes.size());
+    }
+    inbox.append(partial.data(), 3);
+    ASSERT_EQ(inbox.extract(), 3u);
+
+    inbox.release(2);
+    ASSERT_EQ(inbox.frames().size(), 1u);
+    EXPECT_EQ(inbox.pending(), 3u);
+
+    int         value;
+    std::string text;
+    inbox.view(inbox.frames()[0]) >> value >> text;
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(text, "frame 2");
+
+    // La frame partielle se complete derriere la frame restante
+    inbox.append(partial.data() + 3, partial.size() - 3);
+    ASSERT_EQ(inbox.extract(), 1u);
+    inbox.release(1);
+    ASSERT_EQ(inbox.frames().size(), 1u);
+    inbox.view(inbox.frames()[0]) >> value >> text;
+    EXPECT_EQ(value, 4);
+    EXPECT_EQ(text, "not yet");
+}
+
+TEST(FrameBufferTest, ReleaseInSmallBatchesWhileReceiving)
+{
+    FrameBuffer inbox;
+    int         sent     = 0;
+    int         expected = 0;
+
+    // Les frames liberees une a une laissent leur place aux suivantes sans faire grossir le buffer
+    for (int round = 0; round < 200; round++)
+    {
+        for (int i = 0; i < 5; i++, sent++)
+        {
+            auto bytes = serialize(1, sent, "frame");
+            inbox.append(bytes.data(), bytes.size());
+        }
+        inbox.extract();
+
+        for (int i = 0; i < 4; i++, expected++)
+        {
+            int         value;
+            std::string text;
+            inbox.view(inbox.frames()[0]) >> value >> text;
+            ASSERT_EQ(value, expected);
+            inbox.release(1);
+        }
+    }
+    EXPECT_EQ(inbox.frames().size(), static_cast<size_t>(sent - expected));
+    EXPECT_LE(inbox.capacity(), 32768u);
+
+    int         value;
+    std::string text;
+    inbox.view(inbox.frames()[0]) >> value >> text;
+    EXPECT_EQ(value, expected);
+    inbox.release();
+    EXPECT_TRUE(inbox.frames().empty());
+    EXPECT_EQ(inbox.pending(), 0u);
+}
+
+TEST(FrameBufferTest, SwitchesWireFormatMidStream)
+{
+    FrameBuffer inbox;
+    Message     request(MESSAGE_TYPE_WIRE_FORMAT);
+    request << static_cast<unsigned char>(Message::WireFormat::COMPACT);
+    Message msg(3);
+    msg << 42 << std::string("compact");
+
+    auto before = serialize(1, 1, "legacy");
+    auto change = request.getSerializedData();
+    auto after  = msg.getSerializedData(Message::WireFormat::COMPACT);
+    inbox.append(before.data(), before.size());
+    inbox.append(change.data(), change.size());
+    inbox.append(after.data(), 3);
+
+    // La demande de changement n'est pas une frame
+    EXPECT_EQ(inbox.extract(), 1u);
+    EXPECT_EQ(inbox.format(), Message::WireFormat::COMPACT);
+
+    inbox.release();
+    inbox.append(after.data() + 3, after.size() - 3);
+    ASSERT_EQ(inbox.extract(), 1u);
+
+    int         value;
+    std::string text;
+    MessageView view = inbox.view(inbox.frames()[0]);
+    view >> value >> text;
+    EXPECT_EQ(view.type(), 3);
+    EXPECT_EQ(value, 42);
+    EXPECT_EQ(text, "compact");
+
+    inbox.clear();
+    EXPECT_EQ(inbox.format(), Message::WireFormat::LEGACY);
+}
+
+TEST(FrameBufferTest, UnknownWireFormatThrows)
+{
+    FrameBuffer inbox;
+    Message     request(MESSAGE_TYPE_WIRE_FORMAT);
+    request << static_cast<unsigned char>(42);
+
+    auto bytes = request.getSerializedData();
+    inbox.append(bytes.data(), bytes.size());
+    EXPECT_THROW(inbox.extract(), std::runtime_error);
+}
+
+TEST(FrameBufferTest, LegacyCorrelationIdGoesToNextFrame)
+{
+    FrameBuffer   inbox;
+    Message       msg(5);
+    unsigned char header[MESSAGE_HEADER_MAX_SIZE];
+    msg << 1;
+
+    size_t len = msg.serializeHeader(header, Message::WireFormat::LEGACY, 77);
+    EXPECT_EQ(len, 2 * MESSAGE_HEADER_SIZE + sizeof(uint64_t));
+
+    // La frame de correlation arrive seule, le message ensuite
+    inbox.append(header, MESSAGE_HEADER_SIZE + sizeof(uint64_t));
+    EXPECT_EQ(inbox.extract(), 0u);
+    inbox.append(header + MESSAGE_HEADER_SIZE + sizeof(uint64_t),
+                 len - MESSAGE_HEADER_SIZE - sizeof(uint64_t));
+    inbox.append(msg.payload(), msg.payloadSize());
+
+    auto plain = serialize(6, 2, "no id");
+    inbox.append(plain.data(), plain.size());
+
+    ASSERT_EQ(inbox.extract(), 2u);
+    EXPECT_EQ(inbox.frames()[0].type, 5);
+    EXPECT_EQ(inbox.view(inbox.frames()[0]).correlationId(), 77u);
+    EXPECT_EQ(inbox.view(inbox.frames()[1]).correlationId(), 0u);
+}
+
+TEST(FrameBufferTest, ChannelGoesToNextFrameInBothFormats)
+{
+    for (auto format : {Message::WireFormat::LEGACY, Message::WireFormat::COMPACT})
+    {
+        FrameBuffer   inbox;
+        Message       msg(5);
+        unsigned char header[MESSAGE_HEADER_MAX_SIZE];
+        msg << 1;
+
+        inbox.setFormat(format);
+        size_t len = msg.serializeHeader(header, format, 12, 3);
+        inbox.append(header, len);
+        inbox.append(msg.payload(), msg.payloadSize());
+        len = msg.serializeHeader(header, format);
+        inbox.append(header, len);
+        inbox.append(msg.payload(), msg.payloadSize());
+
+        ASSERT_EQ(inbox.extract(), 2u);
+        EXPECT_EQ(inbox.frames()[0].channel, 3u);
+        EXPECT_EQ(inbox.frames()[0].correlationId, 12u);
+        EXPECT_EQ(inbox.frames()[1].channel, 0u);
+    }
+}
+
+TEST(FrameBufferTest, CompressedFramesAreInflated)
+{
+    const Message::Type type = 900;
+    Message::setCompression(type);
+
+    // Etat repetitif (compresse), petit message (jamais compresse), bruit (envoye tel quel)
+    Message state(type);
+    for (int i = 0; i < 200; i++)
+        state << i % 4 << std::string("player");
+    Message small(type);
+    small << 1;
+    Message noise(type);
+    for (unsigned int i = 0, x = 1; i < 200; i++, x = x * 1103515245 + 12345)
+        noise << x;
+
+    for (auto format : {Message::WireFormat::LEGACY, Message::WireFormat::COMPACT})
+    {
+        FrameBuffer inbox;
+        inbox.setFormat(format);
+        auto packed = state.getSerializedData(format);
+        EXPECT_LT(packed.size(), state.payloadSize() / 4);
+
+        inbox.append(packed.data(), packed.size());
+        auto bytes = small.getSerializedData(format);
+        inbox.append(bytes.data(), bytes.size());
+        bytes = noise.getSerializedData(format);
+        EXPECT_GT(bytes.size(), noise.payloadSize());
+        inbox.append(bytes.data(), bytes.size());
+
+        ASSERT_EQ(inbox.extract(), 3u);
+        EXPECT_TRUE(inbox.frames()[0].inflated);
+        EXPECT_FALSE(inbox.frames()[1].inflated);
+        EXPECT_FALSE(inbox.frames()[2].inflated);
+
+        MessageView view = inbox.view(inbox.frames()[0]);
+        ASSERT_EQ(view.size(), state.payloadSize());
+        EXPECT_EQ(memcmp(view.data(), state.payload(), view.size()), 0);
+        EXPECT_EQ(inbox.view(inbox.frames()[2]).size(), noise.payloadSize());
+    }
+    Message::setCompression(type, false);
+    EXPECT_FALSE(Message::compression(type));
+}
+
+TEST(FrameBufferTest, BadCompressedFrameThrows)
+{
+    std::vector<unsigned char> block(LzCodec::bound(1000));
+    std::vector<unsigned char> data(1000, 'a');
+    block.resize(LzCodec::compress(data.data(), data.size(), block.data(), block.size()));
+
+    // Taille annoncee fausse, puis demesuree: rien n'est alloue avant la verification
+    for (size_t original : {static_cast<size_t>(1001), static_cast<size_t>(1) << 40})
+    {
+        FrameBuffer     inbox;
+        unsigned char   header[MESSAGE_HEADER_MAX_SIZE];
+        Message::Header wire = {3, block.size(), 0, 0, original};
+        inbox.setFormat(Message::WireFormat::COMPACT);
+        inbox.append(header, Message::encodeHeader(wire, Message::WireFormat::COMPACT, header));
+        inbox.append(block.data(), block.size());
+        EXPECT_THROW(inbox.extract(), std::runtime_error);
+    }
+}
+
+TEST(FrameBufferTest, OversizedFrameThrowsBeforeItsPayload)
+{
+    FrameBuffer inbox;
+    inbox.setMaxFrameSize(100);
+
+    Message small(1);
+    small << std::string(50, 'a');
+    std::vector<unsigned char> bytes = small.getSerializedData();
+    inbox.append(bytes.data(), bytes.size());
+    EXPECT_EQ(inbox.extract(), 1u);
+    inbox.release();
+
+    // Seul l'en-tete est recu: la taille annoncee suffit a rejeter la frame
+    unsigned char   header[MESSAGE_HEADER_MAX_SIZE];
+    Message::Header wire = {2, static_cast<size_t>(1) << 30, 0, 0, 0};
+    inbox.append(header, Message::encodeHeader(wire, Message::WireFormat::LEGACY, header));
+    EXPECT_THROW(inbox.extract(), std::length_error);
+
+    // Petit bloc compresse qui se decompresserait au-dela de la limite
+    std::vector<unsigned char> data(1000, 'a');
+    std::vector<unsigned char> block(LzCodec::bound(data.size()));
+    block.resize(LzCodec::compress(data.data(), data.size(), block.data(), block.size()));
+
+    FrameBuffer compressed;
+    compressed.setMaxFrameSize(100);
+    compressed.setFormat(Message::WireFormat::COMPACT);
+    wire = {3, block.size(), 0, 0, data.size()};
+    compressed.append(header, Message::encodeHeader(wire, Message::WireFormat::COMPACT, header));
+    compressed.append(block.data(), block.size());
+    EXPECT_THROW(compressed.extract(), std::length_error);
+}
+
+TEST(FrameBufferTest, FramesSurviveReallocation)
+{
+    FrameBuffer inbox;
+    auto        frame = serialize(3, 99, "still here");
+
+    inbox.append(frame.data(), frame.size());
+    ASSERT_EQ(inbox.extract(), 1u);
+
+    // Forcer une reallocation du stockage apres l'extraction
+    std::vector<unsigned char> filler(inbox.capacity() * 4, 0);
+    inbox.append(filler.data(), filler.size());
+
+    int         value;
+    std::string text;
+    inbox.view(inbox.frames()[0]) >> value >> text;
+    EXPECT_EQ(value, 99);
+    EXPECT_EQ(text, "still here");
+}
+
+TEST(FrameBufferTest, CopyKeepsPendingBytes)
+{
+    FrameBuffer inbox;
+    auto        frame = serialize(5, 12, "copied");
+
+    inbox.append(frame.data(), frame.size() - 1);
+    FrameBuffer copy(inbox);
+    copy.append(&frame.back(), 1);
+
+    ASSERT_EQ(copy.extract(), 1u);
+    int         value;
+    std::string text;
+    copy.view(copy.frames()[0]) >> value >> text;
+    EXPECT_EQ(value, 12);
+    EXPECT_EQ(text, "copied");
+}
+
+TEST(FrameBufferTest, PrepareCommitReceivesInPlace)
+{
+    FrameBuffer inbox;
+    auto        frame = serialize(4, 5, "in place");
+
+    unsigned char* dst = inbox.prepare(4096);
+    memcpy(dst, frame.data(), frame.size());
+    inbox.commit(frame.size());
+
+    EXPECT_EQ(inbox.extract(), 1u);
+    EXPECT_THROW(inbox.commit(inbox.capacity() + 1), std::out_of_range);
+}
+
+TEST(MessageViewTest, ReadPastEndThrows)
+{
+    unsigned char bytes[2] = {1, 2};
+    MessageView   view(1, bytes, sizeof(bytes));
+    int           value;
+
+    EXPECT_THROW(view >> value, std::out_of_range);
+}
+
+TEST(MessageViewTest, ConvertsToOwningMessage)
+{
+    Message original(8);
+    original << 1234 << std::string("copy");
+    auto bytes = original.getSerializedData();
+
+    FrameBuffer inbox;
+    inbox.append(bytes.data(), bytes.size());
+    ASSERT_EQ(inbox.extract(), 1u);
+
+    Message copy = inbox.view(inbox.frames()[0]);
+    inbox.clear();
+
+    int         value;
+    std::string text;
+    copy >> value >> text;
+    EXPECT_EQ(copy.type(), 8);
+    EXPECT_EQ(value, 1234);
+    EXPECT_EQ(text, "copy");
+}
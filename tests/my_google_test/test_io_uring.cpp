@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "libftpp.hpp"
+
+class IoUringTest : public ::testing::Test
+{
+protected:
+    int fds[2] = {-1, -1};
+
+    void SetUp() override
+    {
+        if (!IoUring::available())
+            GTEST_SKIP() << "io_uring is not available";
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    }
+
+    void TearDown() override
+    {
+        if (fds[0] >= 0)
+            close(fds[0]);
+        if (fds[1] >= 0)
+            close(fds[1]);
+    }
+
+    // Attend la prochaine completion (le noyau peut la produire un peu apres wait())
+    static bool nextCompletion(IoUring& ring, IoUring::Completion& completion)
+    {
+        for (int i = 0; i < 50; i++)
+        {
+            if (ring.next(completion))
+                return true;
+            ring.wait(10);
+        }
+        return false;
+    }
+};
+
+TEST_F(IoUringTest, RecvMultishotFillsProvidedBuffers)
+{
+    IoUring ring(8);
+    ring.provideBuffers(4, 64);
+    ring.recvMultishot(fds[0], 42);
+    ring.wait(0);
+
+    // Une seule requete, plusieurs receptions
+    for (const std::string text : {"hello", "again", "and again"})
+    {
+        ASSERT_EQ(write(fds[1], text.data(), text.size()), (ssize_t)text.size());
+
+        IoUring::Completion completion;
+        ASSERT_TRUE(nextCompletion(ring, completion));
+        EXPECT_EQ(completion.userData, 42u);
+        ASSERT_TRUE(completion.hasBuffer());
+        ASSERT_EQ(completion.result, (int)text.size());
+        EXPECT_TRUE(completion.more());
+
+        const unsigned char* data = ring.buffer(completion.bufferId());
+        EXPECT_EQ(std::string(data, data + completion.result), text);
+        ring.recycle(completion.bufferId());
+    }
+}
+
+TEST_F(IoUringTest, PeerCloseEndsTheRequest)
+{
+    IoUring ring(8);
+    ring.provideBuffers(4, 64);
+    ring.recvMultishot(fds[0], 7);
+    ring.wait(0);
+
+    close(fds[1]);
+    fds[1] = -1;
+
+    IoUring::Completion completion;
+    ASSERT_TRUE(nextCompletion(ring, completion));
+    EXPECT_EQ(completion.userData, 7u);
+    EXPECT_EQ(completion.result, 0);
+    EXPECT_FALSE(completion.more());
+}
+
+TEST_F(IoUringTest, PollOutReportsWritableSocket)
+{
+    IoUring ring(8);
+    ring.pollOut(fds[0], 3);
+
+    IoUring::Completion completion;
+    ASSERT_TRUE(nextCompletion(ring, completion));
+    EXPECT_EQ(completion.userData, 3u);
+    EXPECT_GT(completion.result, 0);
+}
+
+TEST_F(IoUringTest, WaitTimesOutWithoutCompletion)
+{
+    IoUring ring(8);
+    ring.provideBuffers(4, 64);
+    ring.recvMultishot(fds[0], 1);
+
+    EXPECT_EQ(ring.wait(5), 1); // Soumission de la requete, aucune donnee
+    EXPECT_EQ(ring.wait(5), -ETIME);
+
+    IoUring::Completion completion;
+    EXPECT_FALSE(ring.next(completion));
+}
+
+TEST(IoUringStandaloneTest, ProvidedBufferCountMustBeAPowerOfTwo)
+{
+    if (!IoUring::available())
+        GTEST_SKIP() << "io_uring is not available";
+
+    IoUring ring(4);
+    EXPECT_THROW(ring.provideBuffers(3, 64), std::invalid_argument);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "libftpp.hpp"
+
+TEST(LatencyHistogramTest, BucketsKeepSixPercentPrecision)
+{
+    // Petites valeurs: un bucket chacune
+    for (uint64_t value = 0; value < 16; value++)
+    {
+        EXPECT_EQ(LatencyHistogram::bucketOf(value), value);
+        EXPECT_EQ(LatencyHistogram::highestValueOf(value), value);
+    }
+
+    for (uint64_t value : {16ull, 17ull, 100ull, 1000ull, 123456789ull, ~0ull})
+    {
+        size_t   bucket = LatencyHistogram::bucketOf(value);
+        uint64_t top    = LatencyHistogram::highestValueOf(bucket);
+        EXPECT_LT(bucket, static_cast<size_t>(LATENCY_HISTOGRAM_BUCKETS));
+        EXPECT_GE(top, value);
+        EXPECT_LE(static_cast<double>(top - value), static_cast<double>(value) / 16.0);
+        EXPECT_LT(LatencyHistogram::highestValueOf(bucket - 1), value);
+    }
+}
+
+TEST(LatencyHistogramTest, PercentilesOfUniformValues)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.snapshot().percentile(99), 0u);
+
+    for (uint64_t value = 1; value <= 10000; value++)
+        histogram.record(value * 1000);
+
+    LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 10000u);
+    EXPECT_EQ(snapshot.max, 10000000u);
+    EXPECT_DOUBLE_EQ(snapshot.mean(), 5000500.0);
+
+    for (double percent : {50.0, 90.0, 99.0, 99.9})
+    {
+        double expected = percent * 100000.0;
+        double actual   = static_cast<double>(snapshot.percentile(percent));
+        EXPECT_GE(actual, expected);
+        EXPECT_LE(actual, expected * 1.07);
+    }
+    EXPECT_EQ(snapshot.percentile(100), snapshot.max);
+
+    histogram.reset();
+    EXPECT_EQ(histogram.snapshot().count, 0u);
+}
+
+TEST(LatencyHistogramTest, ConcurrentRecordsAreAllCounted)
+{
+    LatencyHistogram         histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back(
+            [&histogram, t]()
+            {
+                for (uint64_t i = 0; i < 100000; i++)
+                    histogram.record(std::chrono::nanoseconds(i + t));
+            });
+    for (auto& thread : threads)
+        thread.join();
+
+    LatencyHistogram::Snapshot snapshot = histogram.snapshot();
+    uint64_t                   total    = 0;
+    for (uint64_t bucket : snapshot.buckets)
+        total += bucket;
+    EXPECT_EQ(snapshot.count, 400000u);
+    EXPECT_EQ(total, 400000u);
+    EXPECT_EQ(snapshot.max, 100002u);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "libftpp.hpp"
+
+TEST(LockFreeQueueTest, PopsInPushOrder)
+{
+    LockFreeQueue<int> queue;
+    EXPECT_TRUE(queue.empty());
+
+    for (int i = 0; i < 5; i++)
+        queue.push_back(i);
+    EXPECT_FALSE(queue.empty());
+
+    int value;
+    for (int i = 0; i < 5; i++)
+    {
+        ASSERT_TRUE(queue.try_pop_front(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.try_pop_front(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(LockFreeQueueTest, MovesOnlyWhatIsPopped)
+{
+    LockFreeQueue<std::unique_ptr<std::string>> queue;
+    queue.push_back(std::make_unique<std::string>("first"));
+    queue.push_back(std::make_unique<std::string>("second"));
+
+    std::unique_ptr<std::string> value;
+    ASSERT_TRUE(queue.try_pop_front(value));
+    EXPECT_EQ(*value, "first");
+    // "second" est libere par le destructeur de la queue
+}
+
+TEST(LockFreeQueueTest, ManyProducersOneConsumer)
+{
+    const int                nbProducers = 4;
+    const int                perProducer = 20000;
+    LockFreeQueue<int>       queue;
+    std::vector<std::thread> producers;
+
+    for (int p = 0; p < nbProducers; p++)
+        producers.emplace_back(
+            [&queue, p, perProducer]()
+            {
+                for (int i = 0; i < perProducer; i++)
+                    queue.push_back(p * perProducer + i);
+            });
+
+    // L'ordre doit etre conserve pour chaque producteur
+    std::vector<int> last(nbProducers, -1);
+    int              received = 0;
+    bool             ordered  = true;
+    while (received < nbProducers * perProducer)
+    {
+        int value;
+        if (!queue.try_pop_front(value))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        int producer   = value / perProducer;
+        ordered        = ordered && value % perProducer == last[producer] + 1;
+        last[producer] = value % perProducer;
+        received++;
+    }
+
+    for (auto& producer : producers)
+        producer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "libftpp.hpp"
+
+static std::vector<unsigned char> compress(const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> block(LzCodec::bound(data.size()));
+    block.resize(LzCodec::compress(data.data(), data.size(), block.data(), block.size()));
+    return block;
+}
+
+static std::vector<unsigned char> roundTrip(const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> block = compress(data);
+    EXPECT_LE(block.size(), LzCodec::bound(data.size()));
+
+    std::vector<unsigned char> restored(data.size());
+    LzCodec::decompress(block.data(), block.size(), restored.data(), restored.size());
+    return restored;
+}
+
+static std::vector<unsigned char> noise(size_t size)
+{
+    std::vector<unsigned char> data(size);
+    uint32_t                   x = 12345;
+    for (auto& byte : data)
+    {
+        x    = x * 1103515245 + 12345;
+        byte = static_cast<unsigned char>(x >> 16);
+    }
+    return data;
+}
+
+TEST(LzCodecTest, RoundTripsAnySize)
+{
+    // Autour des seuils: pas de match avant 13 octets, longueurs a 15 et 15 + 255
+    for (size_t size : {0, 1, 5, 12, 13, 19, 20, 270, 271, 1000, 70000})
+    {
+        std::vector<unsigned char> text(size);
+        for (size_t i = 0; i < size; i++)
+            text[i] = "abcabcabd"[i % 9];
+        EXPECT_EQ(roundTrip(text), text) << size;
+
+        std::vector<unsigned char> random = noise(size);
+        EXPECT_EQ(roundTrip(random), random) << size;
+    }
+}
+
+TEST(LzCodecTest, CompressesRedundantData)
+{
+    // Etat serialise typique: memes champs, valeurs proches
+    DataBuffer state;
+    for (int i = 0; i < 1000; i++)
+        state << std::string("position") << i % 16 << 1.5f << std::string("alive");
+
+    std::vector<unsigned char> data(state.rawData(), state.rawData() + state.size());
+    std::vector<unsigned char> block = compress(data);
+    EXPECT_LT(block.size(), data.size() / 10);
+    EXPECT_EQ(roundTrip(data), data);
+
+    // Longue repetition d'un octet: match qui chevauche sa propre sortie (offset 1)
+    std::vector<unsigned char> run(100000, 'z');
+    EXPECT_LT(compress(run).size(), 500u);
+    EXPECT_EQ(roundTrip(run), run);
+}
+
+TEST(LzCodecTest, IncompressibleDataStaysUnderBound)
+{
+    std::vector<unsigned char> random = noise(100000);
+    EXPECT_LE(compress(random).size(), LzCodec::bound(random.size()));
+
+    std::vector<unsigned char> small(LzCodec::bound(random.size()) - 1);
+    EXPECT_THROW(LzCodec::compress(random.data(), random.size(), small.data(), small.size()),
+                 std::invalid_argument);
+}
+
+TEST(LzCodecTest, MalformedBlocksThrow)
+{
+    std::vector<unsigned char> data(1000, 'a');
+    std::vector<unsigned char> block = compress(data);
+    std::vector<unsigned char> out(data.size());
+
+    // Taille attendue differente de la taille decodee
+    EXPECT_THROW(LzCodec::decompress(block.data(), block.size(), out.data(), out.size() - 1),
+                 std::runtime_error);
+    EXPECT_THROW(LzCodec::decompress(block.data(), block.size() - 1, out.data(), out.size()),
+                 std::runtime_error);
+
+    // Un literal puis une repetition a 2 octets en arriere: avant le debut de la sortie
+    const unsigned char badOffset[] = {0x10, 'a', 0x02, 0x00};
+    EXPECT_THROW(LzCodec::decompress(badOffset, sizeof(badOffset), out.data(), 5),
+                 std::runtime_error);
+
+    // Plus de literals annonces que d'octets dans le bloc
+    const unsigned char truncated[] = {0xF0, 0x10, 'a'};
+    EXPECT_THROW(LzCodec::decompress(truncated, sizeof(truncated), out.data(), out.size()),
+                 std::runtime_error);
+}
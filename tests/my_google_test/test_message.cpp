@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <climits>
+#include <cstdint>
 #include <stdexcept>
 
 #include "libftpp.hpp"
@@ -78,6 +80,88 @@ TEST(MessageTest, ResetWorks)
     EXPECT_EQ(valOut, valIn); // relu encore une fois
 }
 
+TEST(MessageTest, HeaderAndPayloadMatchSerializedData)
+{
+    Message msg(42);
+    msg << 7 << std::string("payload");
+
+    unsigned char header[MESSAGE_HEADER_SIZE];
+    msg.serializeHeader(header);
+
+    std::vector<unsigned char> scattered(header, header + MESSAGE_HEADER_SIZE);
+    scattered.insert(scattered.end(), msg.payload(), msg.payload() + msg.payloadSize());
+
+    EXPECT_EQ(scattered, msg.getSerializedData());
+    EXPECT_EQ(msg.payloadSize(), sizeof(int) + sizeof(size_t) + 7);
+}
+
+TEST(MessageTest, CompactHeaderRoundTrip)
+{
+    const Message::Type types[] = {0, 1, -1, 63, -64, 1000, INT_MAX, INT_MIN + 1};
+    const size_t        sizes[] = {0, 1, 127, 128, 70000, SIZE_MAX};
+    const uint64_t      ids[]   = {0, 1, 300, UINT64_MAX};
+    const auto          compact = Message::WireFormat::COMPACT;
+
+    for (Message::Type type : types)
+    {
+        for (size_t size : sizes)
+        {
+            for (uint64_t id : ids)
+            {
+                for (uint64_t channel : ids)
+                {
+                    for (size_t original : {static_cast<size_t>(0), size + 1})
+                    {
+                        unsigned char   header[MESSAGE_HEADER_MAX_SIZE];
+                        Message::Header encoded = {type, size, id, channel, original};
+                        size_t          len = Message::encodeHeader(encoded, compact, header);
+
+                        Message::Header decoded;
+                        EXPECT_EQ(Message::decodeHeader(header, len, compact, decoded), len);
+                        EXPECT_EQ(decoded.type, type);
+                        EXPECT_EQ(decoded.size, size);
+                        EXPECT_EQ(decoded.correlationId, id);
+                        EXPECT_EQ(decoded.channel, channel);
+                        EXPECT_EQ(decoded.originalSize, original);
+
+                        // Header tronque: il faut attendre la suite
+                        EXPECT_EQ(Message::decodeHeader(header, len - 1, compact, decoded), 0u);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(MessageTest, CompactHeaderIsSmall)
+{
+    // Types de -16 a 15 et payloads de moins de 128 octets: 2 octets de header
+    Message msg(7);
+    msg << 42;
+
+    std::vector<unsigned char> compact = msg.getSerializedData(Message::WireFormat::COMPACT);
+    EXPECT_EQ(compact.size(), 2 + sizeof(int));
+    EXPECT_EQ(msg.getSerializedData().size(), MESSAGE_HEADER_SIZE + sizeof(int));
+
+    msg.setType(1000);
+    EXPECT_EQ(msg.getSerializedData(Message::WireFormat::COMPACT).size(), 3 + sizeof(int));
+}
+
+TEST(MessageTest, MalformedCompactHeaderThrows)
+{
+    Message::Header header;
+    const auto      compact = Message::WireFormat::COMPACT;
+
+    const unsigned char tooLong[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0x00};
+    EXPECT_THROW(Message::decodeHeader(tooLong, sizeof(tooLong), compact, header),
+                 std::runtime_error);
+
+    // Extension inconnue annoncee par le second bit de flag
+    const unsigned char extension[] = {0x06, 0x00, 0x40};
+    EXPECT_THROW(Message::decodeHeader(extension, sizeof(extension), compact, header),
+                 std::runtime_error);
+}
+
 class MessageComplexTest : public ::testing::Test
 {
 protected:
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <map>
+
+#include "libftpp.hpp"
+
+TEST(NetStatsTest, CountersAndGauges)
+{
+    NetStats stats;
+    stats.connected();
+    stats.connected();
+    stats.read(100);
+    stats.read(50);
+    stats.framesReceived(3, true);
+    stats.framesReceived(1, false);
+    stats.frameSent();
+    stats.wrote(40, true);
+    stats.queued(0, 60);
+    stats.queued(60, 10);
+    stats.disconnected();
+
+    NetStats::Snapshot snapshot = stats.snapshot();
+    EXPECT_EQ(snapshot.bytesIn, 150u);
+    EXPECT_EQ(snapshot.reads, 2u);
+    EXPECT_EQ(snapshot.framesIn, 4u);
+    EXPECT_EQ(snapshot.partialReads, 1u);
+    EXPECT_EQ(snapshot.framesOut, 1u);
+    EXPECT_EQ(snapshot.bytesOut, 40u);
+    EXPECT_EQ(snapshot.blockedWrites, 1u);
+    EXPECT_EQ(snapshot.outputQueued, 10u);
+    EXPECT_EQ(snapshot.connections, 1u);
+}
+
+TEST(NetStatsTest, FramesPerTypeOverflowIntoOtherTypes)
+{
+    NetStats stats;
+    for (int type = 0; type < NET_STATS_TYPES + 10; type++)
+        stats.dispatched(type, 4);
+    stats.dispatched(7, 100);
+    stats.dispatched(MESSAGE_TYPE_PING, 0);
+
+    NetStats::Snapshot snapshot = stats.snapshot();
+    EXPECT_EQ(snapshot.types.size(), static_cast<size_t>(NET_STATS_TYPES));
+
+    std::map<Message::Type, NetStats::TypeCount> byType;
+    uint64_t                                     frames = snapshot.otherTypes.frames;
+    for (const NetStats::TypeCount& count : snapshot.types)
+    {
+        byType[count.type] = count;
+        frames += count.frames;
+    }
+    EXPECT_EQ(frames, static_cast<uint64_t>(NET_STATS_TYPES + 12));
+    EXPECT_EQ(snapshot.otherTypes.frames, 11u);
+    EXPECT_EQ(byType[7].frames, 2u);
+    EXPECT_EQ(byType[7].bytes, 104u);
+}
+
+TEST(NetStatsTest, HistogramsAreFedByTheCaller)
+{
+    NetStats stats;
+    EXPECT_FALSE(stats.timing());
+    stats.setTiming(true);
+    EXPECT_TRUE(stats.timing());
+
+    stats.dispatchDelay(std::chrono::microseconds(5));
+    stats.handlerTime(std::chrono::microseconds(2));
+    stats.handlerTime(std::chrono::microseconds(3));
+
+    NetStats::Snapshot snapshot = stats.snapshot();
+    EXPECT_EQ(snapshot.dispatchDelay.count, 1u);
+    EXPECT_EQ(snapshot.dispatchDelay.max, 5000u);
+    EXPECT_EQ(snapshot.handlerTime.count, 2u);
+    EXPECT_EQ(snapshot.handlerTime.sum, 5000u);
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include "libftpp.hpp"
+
+class OutputQueueTest : public ::testing::Test
+{
+protected:
+    int fds[2];
+
+    void SetUp() override
+    {
+        ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        int small = 4096;
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+    }
+
+    void TearDown() override
+    {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    size_t drain()
+    {
+        std::vector<unsigned char> buffer(65536);
+        size_t                     total = 0;
+        ssize_t                    bytes;
+        while ((bytes = recv(fds[1], buffer.data(), buffer.size(), MSG_DONTWAIT)) > 0)
+            total += bytes;
+        return total;
+    }
+};
+
+TEST_F(OutputQueueTest, SmallWriteIsSentImmediately)
+{
+    OutputQueue                outbox;
+    std::vector<unsigned char> data(100, 'a');
+
+    outbox.push(data.data(), data.size());
+    EXPECT_EQ(outbox.size(), 100u);
+    EXPECT_TRUE(outbox.flush(fds[0]));
+    EXPECT_TRUE(outbox.empty());
+    EXPECT_EQ(drain(), 100u);
+}
+
+TEST_F(OutputQueueTest, PartialWriteIsResumed)
+{
+    OutputQueue  outbox;
+    const size_t total = 1 << 20;
+
+    outbox.push(std::vector<unsigned char>(total, 'b'));
+    EXPECT_TRUE(outbox.flush(fds[0]));
+    EXPECT_FALSE(outbox.empty());
+
+    size_t received = 0;
+    while (!outbox.empty())
+    {
+        received += drain();
+        EXPECT_TRUE(outbox.flush(fds[0]));
+    }
+    received += drain();
+    EXPECT_EQ(received, total);
+}
+
+TEST_F(OutputQueueTest, WaterMarksHaveHysteresis)
+{
+    OutputQueue outbox;
+    outbox.setWaterMarks(1000, 100);
+
+    outbox.push(std::vector<unsigned char>(600, 'c'));
+    EXPECT_FALSE(outbox.congested());
+    outbox.push(std::vector<unsigned char>(600, 'c'));
+    EXPECT_TRUE(outbox.congested());
+
+    outbox.flush(fds[0]);
+    drain();
+    outbox.flush(fds[0]);
+    EXPECT_TRUE(outbox.empty());
+    EXPECT_FALSE(outbox.congested());
+
+    EXPECT_THROW(outbox.setWaterMarks(10, 20), std::invalid_argument);
+}
+
+TEST_F(OutputQueueTest, ClosedPeerIsAnErrorNotASignal)
+{
+    OutputQueue outbox;
+    close(fds[1]);
+    fds[1] = -1;
+
+    outbox.push(std::vector<unsigned char>(10, 'd'));
+    EXPECT_FALSE(outbox.flush(fds[0]));
+}
+
+TEST_F(OutputQueueTest, SharedSegmentIsReferencedNotCopied)
+{
+    OutputQueue              first;
+    OutputQueue              second;
+    OutputQueue::SharedBytes bytes = OutputQueue::share(std::vector<unsigned char>(64, 'c'));
+
+    first.push(bytes);
+    second.push(bytes);
+    EXPECT_EQ(bytes.use_count(), 3);
+    EXPECT_EQ(first.size(), 64u);
+    EXPECT_EQ(second.size(), 64u);
+
+    EXPECT_TRUE(first.flush(fds[0]));
+    EXPECT_TRUE(second.flush(fds[0]));
+    EXPECT_EQ(drain(), 128u);
+    EXPECT_EQ(bytes.use_count(), 1);
+}
+
+TEST_F(OutputQueueTest, WriteSendsScatteredBuffersDirectly)
+{
+    OutputQueue   outbox;
+    unsigned char header[4] = {'h', 'e', 'a', 'd'};
+    unsigned char body[6]   = {'p', 'a', 'y', 'l', 'o', 'd'};
+    iovec         iov[2]    = {{header, sizeof(header)}, {body, sizeof(body)}};
+
+    EXPECT_TRUE(outbox.write(fds[0], iov, 2));
+    EXPECT_TRUE(outbox.empty());
+
+    unsigned char received[16];
+    ASSERT_EQ(recv(fds[1], received, sizeof(received), MSG_DONTWAIT), 10);
+    EXPECT_EQ(std::string(received, received + 10), "headpaylod");
+}
+
+TEST_F(OutputQueueTest, WriteKeepsOnlyTheUnsentTail)
+{
+    OutputQueue                outbox;
+    std::vector<unsigned char> header(8, 'h');
+    std::vector<unsigned char> body(1 << 20, 'b');
+    iovec iov[2] = {{header.data(), header.size()}, {body.data(), body.size()}};
+
+    EXPECT_TRUE(outbox.write(fds[0], iov, 2));
+    EXPECT_FALSE(outbox.empty());
+    EXPECT_LT(outbox.size(), header.size() + body.size());
+
+    // Ecrit apres: doit arriver apres la fin du premier envoi
+    unsigned char tail = 't';
+    iovec         next = {&tail, 1};
+    EXPECT_TRUE(outbox.write(fds[0], &next, 1));
+
+    std::vector<unsigned char> received;
+    unsigned char              buffer[65536];
+    while (!outbox.empty() || received.size() < header.size() + body.size() + 1)
+    {
+        EXPECT_TRUE(outbox.flush(fds[0]));
+        ssize_t bytes = recv(fds[1], buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (bytes > 0)
+            received.insert(received.end(), buffer, buffer + bytes);
+    }
+    ASSERT_EQ(received.size(), header.size() + body.size() + 1);
+    EXPECT_EQ(received.front(), 'h');
+    EXPECT_EQ(received[header.size()], 'b');
+    EXPECT_EQ(received.back(), 't');
+}
+
+TEST_F(OutputQueueTest, FlushCoalescesManySegmentsInOrder)
+{
+    OutputQueue outbox;
+    const int   nbSegments = OUTPUT_MAX_IOVECS * 3 + 5;
+
+    for (int i = 0; i < nbSegments; i++)
+    {
+        unsigned char value = static_cast<unsigned char>(i);
+        outbox.push(&value, 1);
+    }
+    EXPECT_EQ(outbox.size(), static_cast<size_t>(nbSegments));
+
+    EXPECT_TRUE(outbox.flush(fds[0]));
+    EXPECT_TRUE(outbox.empty());
+
+    unsigned char received[1024];
+    ASSERT_EQ(recv(fds[1], received, sizeof(received), MSG_DONTWAIT), nbSegments);
+    for (int i = 0; i < nbSegments; i++)
+        EXPECT_EQ(received[i], static_cast<unsigned char>(i));
+}
+
+TEST_F(OutputQueueTest, ChunksOfADataBufferAreSentWithoutCopy)
+{
+    std::shared_ptr<ChunkPool> pool = std::make_shared<ChunkPool>(256);
+    DataBuffer                 buffer(pool);
+    for (int i = 0; i < 200; i++)
+        buffer << i;
+    int first;
+    buffer >> first;
+
+    OutputQueue outbox;
+    for (const DataBuffer::Chunk& chunk : buffer.takeChunks())
+        outbox.push(chunk.data, chunk.offset);
+    EXPECT_EQ(outbox.size(), 199 * sizeof(int));
+    EXPECT_EQ(pool->available(), 0u);
+
+    EXPECT_TRUE(outbox.flush(fds[0]));
+    EXPECT_TRUE(outbox.empty());
+    EXPECT_EQ(pool->available(), 4u); // Rendus au pool une fois envoyes
+
+    int received[199];
+    ASSERT_EQ(recv(fds[1], received, sizeof(received), MSG_DONTWAIT),
+              static_cast<ssize_t>(sizeof(received)));
+    for (int i = 0; i < 199; i++)
+        EXPECT_EQ(received[i], i + 1);
+}
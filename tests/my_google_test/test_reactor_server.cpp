@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "libftpp.hpp"
+
+using namespace std::chrono_literals;
+
+// Les reactors tournent dans leurs propres threads: le client doit boucler sur update()
+static bool waitFor(Client& client, const std::function<bool()>& done)
+{
+    const auto deadline = std::chrono::steady_clock::now() + 3s;
+    while (!done() && std::chrono::steady_clock::now() < deadline)
+        client.update();
+    return done();
+}
+
+TEST(ReactorServerTest, ClientIdsIdentifyTheirReactor)
+{
+    ReactorServer server(3);
+    EXPECT_EQ(server.size(), 3u);
+    // Generation au-dessus des bits du fd: reactor i attribue i, i + 3, i + 6...
+    EXPECT_EQ(server.reactorOf((0LL << CONNECTION_SLOT_BITS) | 7), 0u);
+    EXPECT_EQ(server.reactorOf((4LL << CONNECTION_SLOT_BITS) | 7), 1u);
+    EXPECT_EQ(server.reactorOf((8LL << CONNECTION_SLOT_BITS) | 9), 2u);
+}
+
+TEST(ReactorServerTest, StartRequiresAPort)
+{
+    // Port 0: chaque reactor aurait son propre port ephemere, sans repartition
+    ReactorServer server(2);
+    EXPECT_THROW(server.start(0), std::invalid_argument);
+}
+
+TEST(ReactorServerTest, EchoFromEveryReactor)
+{
+    const size_t  port = 19200;
+    ReactorServer server("127.0.0.1", port, 3);
+
+    std::mutex          idsMutex;
+    std::set<long long> ids;
+    server.defineAction(1,
+                        [&](long long& clientID, const Message& msg)
+                        {
+                            {
+                                std::lock_guard<std::mutex> lock(idsMutex);
+                                ids.insert(clientID);
+                            }
+                            int value;
+                            msg >> value;
+                            Message reply(2);
+                            reply << value + 1;
+                            server.sendTo(reply, clientID);
+                        });
+    server.start(port);
+
+    std::vector<Client> clients(12);
+    std::vector<int>    replies(clients.size(), 0);
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        clients[i].connect("127.0.0.1", port);
+        clients[i].defineAction(2, [&replies, i](const Message& msg) { msg >> replies[i]; });
+
+        Message msg(1);
+        msg << static_cast<int>(i);
+        clients[i].send(msg);
+    }
+
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        EXPECT_TRUE(waitFor(clients[i], [&replies, i]() { return replies[i] != 0; }));
+        EXPECT_EQ(replies[i], static_cast<int>(i) + 1);
+    }
+
+    server.stop();
+    EXPECT_EQ(ids.size(), clients.size());
+}
+
+TEST(ReactorServerTest, SendFromOutsideIsRoutedToOwner)
+{
+    const size_t  port = 19201;
+    ReactorServer server("127.0.0.1", port, 2);
+
+    std::atomic<long long> lastId{-1};
+    server.defineAction(1, [&lastId](long long& clientID, const Message&) { lastId = clientID; });
+    server.start(port);
+
+    Client client("127.0.0.1", port);
+    Message hello(1);
+    hello << 0;
+    client.send(hello);
+
+    const auto deadline = std::chrono::steady_clock::now() + 3s;
+    while (lastId < 0 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(1ms);
+    ASSERT_GE(lastId.load(), 0);
+
+    std::string received;
+    client.defineAction(3, [&received](const Message& msg) { msg >> received; });
+
+    Message push(3);
+    push << std::string("from main thread");
+    server.sendTo(push, lastId);
+
+    EXPECT_TRUE(waitFor(client, [&received]() { return !received.empty(); }));
+    EXPECT_EQ(received, "from main thread");
+}
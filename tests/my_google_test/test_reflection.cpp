@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "libftpp.hpp"
+
+struct Position
+{
+    float x;
+    float y;
+    float z;
+
+    static constexpr auto schema()
+    {
+        return std::make_tuple(&Position::x, &Position::y, &Position::z);
+    }
+};
+
+struct Player
+{
+    int                   id;
+    std::string           name;
+    Position              position;
+    std::vector<Position> path;
+    std::vector<int>      inventory;
+
+    static constexpr auto schema()
+    {
+        return std::make_tuple(&Player::id, &Player::name, &Player::position, &Player::path,
+                               &Player::inventory);
+    }
+};
+
+// Padding entre flag et value: les champs sont ecrits un par un
+struct Padded
+{
+    char flag;
+    int  value;
+
+    static constexpr auto schema()
+    {
+        return std::make_tuple(&Padded::flag, &Padded::value);
+    }
+};
+
+// Champs listes dans un autre ordre que la declaration: pas de copie en bloc
+struct Swapped
+{
+    int first;
+    int second;
+
+    static constexpr auto schema()
+    {
+        return std::make_tuple(&Swapped::second, &Swapped::first);
+    }
+};
+
+// Type qu'on ne peut pas modifier: le schema est declare a cote
+struct Color
+{
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+};
+
+template <>
+struct Schema<Color>
+{
+    static constexpr auto fields()
+    {
+        return std::make_tuple(&Color::r, &Color::g, &Color::b);
+    }
+};
+
+static Player makePlayer()
+{
+    return {42, "alice", {1, 2, 3}, {{4, 5, 6}, {7, 8, 9}}, {1, 2, 3, 4}};
+}
+
+static void expectSamePlayer(const Player& a, const Player& b)
+{
+    EXPECT_EQ(a.id, b.id);
+    EXPECT_EQ(a.name, b.name);
+    EXPECT_EQ(a.position.z, b.position.z);
+    ASSERT_EQ(a.path.size(), b.path.size());
+    EXPECT_EQ(a.path[1].y, b.path[1].y);
+    EXPECT_EQ(a.inventory, b.inventory);
+}
+
+TEST(ReflectionTest, SchemaIsKnownAtCompileTime)
+{
+    static_assert(IsReflected<Player>::value, "Player declares a schema");
+    static_assert(IsReflected<Color>::value, "Color has a Schema specialization");
+    static_assert(!IsReflected<int>::value, "int has no schema");
+    static_assert(Reflection::fieldCount<Player>() == 5, "five fields");
+
+    EXPECT_TRUE(Reflection::contiguous<Position>());
+    EXPECT_TRUE(Reflection::contiguous<Color>());
+    EXPECT_FALSE(Reflection::contiguous<Padded>());
+    EXPECT_FALSE(Reflection::contiguous<Swapped>());
+    EXPECT_FALSE(Reflection::contiguous<Player>());
+
+    Position position = {1, 2, 3};
+    float    sum      = 0;
+    Reflection::forEachField(position, [&sum](float& field) { sum += field; });
+    EXPECT_EQ(sum, 6);
+}
+
+TEST(ReflectionTest, WireFormatIsFieldsInSchemaOrder)
+{
+    DataBuffer reflected;
+    DataBuffer manual;
+    Player     player = makePlayer();
+
+    reflected << player;
+    manual << player.id << player.name << player.position.x << player.position.y
+           << player.position.z << player.path.size();
+    for (const Position& step : player.path)
+        manual << step.x << step.y << step.z;
+    manual << player.inventory.size();
+    for (int item : player.inventory)
+        manual << item;
+    EXPECT_EQ(reflected.data(), manual.data());
+
+    // Pas de padding sur le fil, et l'ordre du schema prime sur celui de la declaration
+    DataBuffer padded;
+    padded << Padded{'a', 7} << Swapped{1, 2};
+    EXPECT_EQ(padded.size(), sizeof(char) + 3 * sizeof(int));
+    int second;
+    padded.increaseCursor(sizeof(char) + sizeof(int));
+    padded >> second;
+    EXPECT_EQ(second, 2);
+}
+
+TEST(ReflectionTest, RoundTripsThroughEveryArchive)
+{
+    Player player = makePlayer();
+
+    DataBuffer buffer;
+    Player     fromBuffer;
+    buffer << player;
+    buffer >> fromBuffer;
+    expectSamePlayer(player, fromBuffer);
+
+    Message msg(1);
+    Player  fromMessage;
+    Player  fromView;
+    msg << player << Color{1, 2, 3};
+    MessageView view(1, msg.payload(), msg.payloadSize());
+    Color       color;
+    view >> fromView >> color;
+    msg >> fromMessage;
+    expectSamePlayer(player, fromView);
+    expectSamePlayer(player, fromMessage);
+    EXPECT_EQ(color.b, 3);
+
+    Memento::Snapshot snapshot;
+    Player            fromSnapshot;
+    snapshot << player;
+    snapshot >> fromSnapshot;
+    expectSamePlayer(player, fromSnapshot);
+}
+
+TEST(ReflectionTest, ArraysAndSpansAreWrittenInBulk)
+{
+    DataBuffer buffer;
+
+    // Tableau de floats: ses octets, sans compte
+    std::array<float, 3> floats = {1.5f, 2.5f, 3.5f};
+    buffer << floats;
+    EXPECT_EQ(buffer.size(), sizeof(floats));
+
+    std::array<float, 3> floatsRead;
+    buffer >> floatsRead;
+    EXPECT_EQ(floatsRead, floats);
+
+    // Elements non triviaux: un par un
+    std::array<std::string, 2> names = {"alice", "bob"};
+    std::array<std::string, 2> namesRead;
+    buffer << names;
+    buffer >> namesRead;
+    EXPECT_EQ(namesRead, names);
+
+    // Un span s'ecrit comme un vector, et se relit comme tel
+    int values[5] = {1, 2, 3, 4, 5};
+    buffer << Span<const int>{values, 5};
+    EXPECT_EQ(buffer.size(), sizeof(size_t) + sizeof(values));
+    std::vector<int> asVector;
+    buffer >> asVector;
+    EXPECT_EQ(asVector, std::vector<int>(values, values + 5));
+
+    int       into[8] = {};
+    Span<int> span{into, 8};
+    buffer << asVector;
+    buffer >> span;
+    EXPECT_EQ(span.size, 5u);
+    EXPECT_EQ(into[4], 5);
+
+    Span<int> tooSmall{into, 2};
+    buffer << asVector;
+    EXPECT_THROW(buffer >> tooSmall, std::out_of_range);
+}
+
+TEST(ReflectionTest, PortableEncodingRoundTripsWithVarintCounts)
+{
+    Player player = makePlayer();
+
+    DataBuffer host;
+    host << player;
+
+    DataBuffer portable;
+    portable.setEncoding(DataBuffer::Encoding::PORTABLE);
+    portable << player;
+
+    // name, path et inventory: trois tailles d'un octet au lieu de size_t
+    EXPECT_EQ(portable.size(), host.size() - 3 * (sizeof(size_t) - 1));
+
+    Player copy;
+    portable >> copy;
+    expectSamePlayer(player, copy);
+    EXPECT_EQ(portable.size(), 0u);
+
+    // Lu avec le mauvais encodage: les tailles ne correspondent plus
+    portable << player;
+    portable.setEncoding(DataBuffer::Encoding::HOST);
+    EXPECT_THROW(portable >> copy, std::out_of_range);
+}
+
+TEST(ReflectionTest, TruncatedDataThrows)
+{
+    DataBuffer buffer;
+    buffer << makePlayer();
+
+    // Vector annonce avec plus d'elements que d'octets: pas d'allocation geante
+    DataBuffer truncated;
+    truncated << static_cast<size_t>(1000000000000ULL) << Position{1, 2, 3};
+    std::vector<Position> path;
+    EXPECT_THROW(truncated >> path, std::out_of_range);
+
+    std::vector<unsigned char> bytes = buffer.data();
+    MessageView                view(1, bytes.data(), bytes.size() - 1);
+    Player                     player;
+    EXPECT_THROW(view >> player, std::out_of_range);
+}
@@ -0,0 +1,1152 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "libftpp.hpp"
+
+// Serveur et client tournent dans le meme thread: on alterne les update()
+class ServerBackendTest : public ::testing::TestWithParam<Server::Backend>
+{
+protected:
+    void SetUp() override
+    {
+        if (GetParam() == Server::Backend::IO_URING && !IoUring::available())
+            GTEST_SKIP() << "io_uring is not available";
+    }
+
+    static size_t nextPort()
+    {
+        static size_t port = 19100;
+        return port++;
+    }
+
+    // Avec le serveur io_uring, les clients utilisent aussi io_uring
+    static Client::Backend clientBackend()
+    {
+        return GetParam() == Server::Backend::IO_URING ? Client::Backend::IO_URING
+                                                       : Client::Backend::EPOLL;
+    }
+};
+
+TEST_P(ServerBackendTest, EchoRoundTrip)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    EXPECT_EQ(server.backend(), GetParam());
+
+    server.defineAction(1,
+                        [&server](long long& clientID, const Message& msg)
+                        {
+                            int value;
+                            msg >> value;
+                            Message reply(2);
+                            reply << value * 2;
+                            server.sendTo(reply, clientID);
+                        });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+
+    int received = 0;
+    client.defineAction(2, [&received](const Message& msg) { msg >> received; });
+
+    Message msg(1);
+    msg << 21;
+    client.send(msg);
+
+    server.update();
+    client.update();
+
+    EXPECT_EQ(received, 42);
+}
+
+TEST_P(ServerBackendTest, BurstOfRepliesArrivesInOrder)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+
+    // Les reponses envoyees depuis les handlers partent ensemble a la fin de la distribution
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView& msg)
+                        {
+                            int value;
+                            msg >> value;
+                            Message reply(2);
+                            reply << value;
+                            server.sendTo(reply, clientID);
+                        });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+
+    const int        nbMessages = 200;
+    std::vector<int> received;
+    client.defineAction(2,
+                        [&received](const MessageView& msg)
+                        {
+                            int value;
+                            msg >> value;
+                            received.push_back(value);
+                        });
+
+    for (int i = 0; i < nbMessages; i++)
+    {
+        Message msg(1);
+        msg << i;
+        client.send(msg);
+    }
+
+    for (int round = 0; round < 100 && received.size() < nbMessages; round++)
+    {
+        server.update();
+        client.update();
+    }
+
+    ASSERT_EQ(received.size(), static_cast<size_t>(nbMessages));
+    for (int i = 0; i < nbMessages; i++)
+        EXPECT_EQ(received[i], i);
+}
+
+TEST_P(ServerBackendTest, ManyClientsBroadcast)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    server.start();
+
+    std::vector<Client> clients;
+    for (size_t i = 0; i < 20; i++)
+        clients.emplace_back(clientBackend());
+
+    std::vector<int> received(clients.size(), 0);
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        clients[i].connect("127.0.0.1", port);
+        clients[i].defineAction(7, [&received, i](const Message&) { received[i]++; });
+    }
+    server.update();
+
+    Message msg(7);
+    msg << std::string("hello");
+    server.sendToAll(msg);
+
+    for (auto& client : clients)
+        client.update();
+
+    for (int count : received)
+        EXPECT_EQ(count, 1);
+}
+
+TEST_P(ServerBackendTest, CompactWireFormatRoundTrip)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView& msg)
+                        {
+                            int value;
+                            msg >> value;
+                            Message reply(2);
+                            reply << value + 1;
+                            server.sendTo(reply, clientID);
+                        });
+    server.start();
+
+    // Un client compact et un client legacy recoivent la meme diffusion
+    Client compact("127.0.0.1", port, clientBackend());
+    Client legacy("127.0.0.1", port, clientBackend());
+    compact.setWireFormat(Message::WireFormat::COMPACT);
+
+    std::vector<int> replies;
+    int              broadcasts = 0;
+    compact.defineAction(2,
+                         [&replies](const MessageView& msg)
+                         {
+                             int value;
+                             msg >> value;
+                             replies.push_back(value);
+                         });
+    compact.defineAction(3, [&broadcasts](const MessageView&) { broadcasts++; });
+    legacy.defineAction(3, [&broadcasts](const MessageView&) { broadcasts++; });
+
+    for (int i = 0; i < 50; i++)
+    {
+        Message msg(1);
+        msg << i;
+        compact.send(msg);
+    }
+    Message broadcast(3);
+    broadcast << std::string("everyone");
+
+    for (int round = 0; round < 50 && (replies.size() < 50 || broadcasts < 2); round++)
+    {
+        server.update();
+        if (round == 0)
+            server.sendToAll(broadcast);
+        compact.update();
+        legacy.update();
+    }
+
+    EXPECT_EQ(compact.wireFormat(), Message::WireFormat::COMPACT);
+    EXPECT_EQ(legacy.wireFormat(), Message::WireFormat::LEGACY);
+    EXPECT_EQ(broadcasts, 2);
+    ASSERT_EQ(replies.size(), 50u);
+    for (int i = 0; i < 50; i++)
+        EXPECT_EQ(replies[i], i + 1);
+}
+
+TEST_P(ServerBackendTest, CompressedTypesAreTransparent)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    Message::setCompression(4);
+
+    // Le serveur renvoie l'etat a l'expediteur, puis a tout le monde
+    server.defineAction(4,
+                        [&server](long long& clientID, const MessageView& msg)
+                        {
+                            Message reply(4);
+                            reply.appendBytes(msg.data(), msg.size());
+                            server.sendTo(reply, clientID);
+                            server.sendToAll(reply);
+                        });
+    server.start();
+
+    Client compact("127.0.0.1", port, clientBackend());
+    Client legacy("127.0.0.1", port, clientBackend());
+    compact.setWireFormat(Message::WireFormat::COMPACT);
+
+    Message state(4);
+    for (int i = 0; i < 500; i++)
+        state << std::string("entity") << i % 8 << 0.5f;
+    std::vector<unsigned char> expected(state.payload(), state.payload() + state.payloadSize());
+
+    std::vector<std::vector<unsigned char>> received;
+    auto store = [&received](const MessageView& msg)
+    { received.emplace_back(msg.data(), msg.data() + msg.size()); };
+    compact.defineAction(4, store);
+    legacy.defineAction(4, store);
+
+    // Les deux connexions doivent etre acceptees avant la diffusion (select: une par update())
+    server.update();
+    server.update();
+    compact.send(state);
+
+    for (int round = 0; round < 50 && received.size() < 3; round++)
+    {
+        server.update();
+        compact.update();
+        legacy.update();
+    }
+    Message::setCompression(4, false);
+
+    ASSERT_EQ(received.size(), 3u);
+    for (const auto& payload : received)
+        EXPECT_EQ(payload, expected);
+}
+
+TEST_P(ServerBackendTest, PipelinedCallsMatchOutOfOrderResponses)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+
+    // Le serveur repond plus tard, dans l'ordre inverse des requetes
+    std::vector<std::pair<uint64_t, int>> requests;
+    long long                             clientId = -1;
+    server.defineAction(1,
+                        [&requests, &clientId](long long& clientID, const MessageView& request)
+                        {
+                            int value;
+                            request >> value;
+                            requests.push_back({request.correlationId(), value});
+                            clientId = clientID;
+                        });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+
+    int untagged = 0;
+    client.defineAction(2, [&untagged](const MessageView&) { untagged++; });
+
+    const int        nbCalls = 100;
+    std::vector<int> answers(nbCalls, -1);
+    for (int i = 0; i < nbCalls; i++)
+    {
+        Message request(1);
+        request << i;
+        client.call(request,
+                    [&answers, i](const MessageView& response)
+                    {
+                        int value;
+                        response >> value;
+                        answers[i] = value;
+                    });
+    }
+    EXPECT_EQ(client.pendingCalls(), static_cast<size_t>(nbCalls));
+
+    for (int round = 0; round < 50 && client.pendingCalls() > 0; round++)
+    {
+        server.update();
+        for (auto it = requests.rbegin(); it != requests.rend(); ++it)
+        {
+            Message response(2);
+            response << it->second * 2;
+            server.reply(clientId, it->first, response);
+        }
+        requests.clear();
+        client.update();
+    }
+
+    EXPECT_EQ(client.pendingCalls(), 0u);
+    EXPECT_EQ(untagged, 0);
+    for (int i = 0; i < nbCalls; i++)
+        EXPECT_EQ(answers[i], i * 2);
+}
+
+TEST_P(ServerBackendTest, CallReturnsFutureWithCompactFormat)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView& request)
+                        {
+                            std::string name;
+                            request >> name;
+                            Message response(2);
+                            response << std::string("hello " + name);
+                            server.reply(clientID, request, response);
+                        });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    client.setWireFormat(Message::WireFormat::COMPACT);
+    server.update();
+
+    Message request(1);
+    request << std::string("world");
+    std::future<Message> answer = client.call(request);
+
+    for (int round = 0; round < 50; round++)
+    {
+        server.update();
+        client.update(1);
+        if (answer.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            break;
+    }
+
+    ASSERT_EQ(answer.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    Message     response = answer.get();
+    std::string text;
+    response >> text;
+    EXPECT_EQ(text, "hello world");
+
+    // Connexion perdue: la reponse ne viendra jamais
+    std::future<Message> lost = client.call(request);
+    client.disconnect();
+    EXPECT_THROW(lost.get(), std::future_error);
+}
+
+TEST_P(ServerBackendTest, SendToArrayReachesOnlySelectedClients)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+
+    std::vector<long long> ids;
+    server.defineAction(1, [&ids](long long& id, const Message&) { ids.push_back(id); });
+    server.start();
+
+    std::vector<Client> clients;
+    for (size_t i = 0; i < 6; i++)
+        clients.emplace_back(clientBackend());
+
+    std::vector<int> received(clients.size(), 0);
+    for (size_t i = 0; i < clients.size(); i++)
+    {
+        clients[i].connect("127.0.0.1", port);
+        clients[i].defineAction(7, [&received, i](const Message&) { received[i]++; });
+
+        Message hello(1);
+        hello << static_cast<int>(i);
+        clients[i].send(hello);
+        server.update();
+    }
+    ASSERT_EQ(ids.size(), clients.size());
+
+    // Un client sur deux, plus un identifiant inconnu qui doit etre ignore
+    std::vector<long long> targets = {ids[0], ids[2], ids[4], 123456};
+    Message                msg(7);
+    msg << std::string("hello");
+    server.sendToArray(msg, targets);
+
+    for (auto& client : clients)
+        client.update();
+
+    for (size_t i = 0; i < clients.size(); i++)
+        EXPECT_EQ(received[i], i % 2 == 0 ? 1 : 0);
+}
+
+TEST_P(ServerBackendTest, DisconnectedClientIsForgotten)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+
+    int calls = 0;
+    server.defineAction(1, [&calls](long long&, const Message&) { calls++; });
+    server.start();
+
+    {
+        Client client("127.0.0.1", port, clientBackend());
+        server.update();
+        client.disconnect();
+    }
+    server.update();
+
+    Client other("127.0.0.1", port, clientBackend());
+    Message msg(1);
+    msg << 1;
+    other.send(msg);
+    server.update();
+
+    EXPECT_EQ(calls, 1);
+}
+
+TEST_P(ServerBackendTest, SlowReaderDoesNotBlockTheServer)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    server.setOutputWaterMarks(256 * 1024, 64 * 1024);
+
+    std::vector<bool> congestion;
+    server.defineBackpressureAction([&congestion](long long&, bool congested)
+                                    { congestion.push_back(congested); });
+
+    long long clientId = -1;
+    server.defineAction(1, [&clientId](long long& id, const Message&) { clientId = id; });
+    server.start();
+
+    Client  client("127.0.0.1", port, clientBackend());
+    Message hello(1);
+    hello << 0;
+    client.send(hello);
+    server.update();
+    ASSERT_GE(clientId, 0);
+
+    // Le client ne lit pas: bien plus que ce que les buffers du noyau peuvent absorber
+    const int                  nbMessages = 64;
+    std::vector<unsigned char> payload(256 * 1024, 'x');
+    for (int i = 0; i < nbMessages; i++)
+    {
+        Message big(2);
+        big << i;
+        big.appendBytes(payload.data(), payload.size());
+        server.sendTo(big, clientId);
+    }
+    EXPECT_GT(server.pendingOutput(clientId), 0u);
+    ASSERT_FALSE(congestion.empty());
+    EXPECT_TRUE(congestion.front());
+
+    int  received = 0;
+    bool inOrder  = true;
+    client.defineAction(2,
+                        [&received, &inOrder](const MessageView& msg)
+                        {
+                            int index;
+                            msg >> index;
+                            inOrder = inOrder && index == received && msg.size() == 256 * 1024;
+                            received++;
+                        });
+
+    for (int round = 0; round < 1000 && received < nbMessages; round++)
+    {
+        client.update();
+        server.update();
+    }
+
+    EXPECT_EQ(received, nbMessages);
+    EXPECT_TRUE(inOrder);
+    EXPECT_EQ(server.pendingOutput(clientId), 0u);
+    EXPECT_FALSE(congestion.back());
+}
+
+TEST_P(ServerBackendTest, OversizedFrameDropsOnlyThatClient)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    server.setMaxFrameSize(1024);
+
+    int calls = 0;
+    server.defineAction(1, [&calls](long long&, const MessageView&) { calls++; });
+    server.start();
+
+    Client flooder("127.0.0.1", port, clientBackend());
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+    server.update();
+
+    Message huge(1);
+    huge << std::string(100000, 'x');
+    flooder.send(huge);
+    Message small(1);
+    small << 1;
+    client.send(small);
+
+    for (int round = 0; round < 20 && (calls == 0 || server.metrics().droppedClients == 0);
+         round++)
+        server.update();
+
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(server.metrics().droppedClients, 1u);
+    EXPECT_EQ(server.metrics().oversizedFrames, 1u);
+}
+
+TEST_P(ServerBackendTest, MessageRateLimitThrottlesOnlyTheFlooder)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    server.setRateLimit(0, 1000, std::chrono::milliseconds(10)); // Rafale de 10 messages
+
+    std::map<long long, std::vector<int>> received;
+    long long                             flooderId         = -1;
+    size_t                                flooded           = 0;
+    size_t                                floodedWhenServed = 0;
+    server.defineAction(1,
+                        [&](long long& clientID, const MessageView& msg)
+                        {
+                            int value;
+                            msg >> value;
+                            received[clientID].push_back(value);
+                            if (value >= 0)
+                            {
+                                flooderId = clientID;
+                                flooded++;
+                            }
+                            else
+                                floodedWhenServed = flooded;
+                        });
+    server.start();
+
+    Client flooder("127.0.0.1", port, clientBackend());
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+    server.update();
+
+    const int nbMessages = 200;
+    auto      start      = std::chrono::steady_clock::now();
+    for (int i = 0; i < nbMessages; i++)
+    {
+        Message msg(1);
+        msg << i;
+        flooder.send(msg);
+    }
+    server.update();
+    EXPECT_LT(flooded, static_cast<size_t>(nbMessages));
+    EXPECT_TRUE(server.throttled(flooderId));
+
+    // Le client sage passe sans attendre la fin du flot
+    Message msg(1);
+    msg << -1;
+    client.send(msg);
+
+    auto deadline = start + std::chrono::seconds(3);
+    while (flooded < nbMessages && std::chrono::steady_clock::now() < deadline)
+        server.update();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_EQ(flooded, static_cast<size_t>(nbMessages));
+    for (int i = 0; i < nbMessages; i++)
+        EXPECT_EQ(received[flooderId][i], i);
+    EXPECT_LT(floodedWhenServed, static_cast<size_t>(nbMessages));
+    EXPECT_GE(elapsed, std::chrono::milliseconds(150));
+    EXPECT_GE(server.metrics().throttleEvents, 1u);
+    EXPECT_FALSE(server.throttled(flooderId));
+}
+
+TEST_P(ServerBackendTest, ByteRateLimitPacesReads)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    server.setRateLimit(100000, 0, std::chrono::milliseconds(10)); // Rafale de 1000 octets
+
+    std::vector<int> received;
+    server.defineAction(1,
+                        [&received](long long&, const MessageView& msg)
+                        {
+                            int         value;
+                            std::string padding;
+                            msg >> value >> padding;
+                            received.push_back(value);
+                        });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+    server.update();
+
+    // 20 KB a 100 KB/s: au moins 190 ms
+    const int nbMessages = 20;
+    auto      start      = std::chrono::steady_clock::now();
+    for (int i = 0; i < nbMessages; i++)
+    {
+        Message msg(1);
+        msg << i << std::string(1000, 'p');
+        client.send(msg);
+    }
+
+    auto deadline = start + std::chrono::seconds(3);
+    while (received.size() < nbMessages && std::chrono::steady_clock::now() < deadline)
+        server.update();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_EQ(received.size(), static_cast<size_t>(nbMessages));
+    for (int i = 0; i < nbMessages; i++)
+        EXPECT_EQ(received[i], i);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(150));
+    EXPECT_GE(server.metrics().throttleEvents, 1u);
+}
+
+TEST_P(ServerBackendTest, UpdateStopsAtMessageBudget)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+
+    std::vector<int> received;
+    server.defineAction(1,
+                        [&received](long long&, const MessageView& msg)
+                        {
+                            int value;
+                            msg >> value;
+                            received.push_back(value);
+                        });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+
+    const int nbMessages = 100;
+    for (int i = 0; i < nbMessages; i++)
+    {
+        Message msg(1);
+        msg << i;
+        client.send(msg);
+    }
+
+    // Les messages en trop restent en attente et passent en premier au tour suivant
+    for (int round = 0; round < 100 && received.size() < nbMessages; round++)
+    {
+        size_t before = received.size();
+        EXPECT_LE(server.update(10), 10u);
+        EXPECT_LE(received.size() - before, 10u);
+        client.update();
+    }
+
+    ASSERT_EQ(received.size(), static_cast<size_t>(nbMessages));
+    for (int i = 0; i < nbMessages; i++)
+        EXPECT_EQ(received[i], i);
+}
+
+TEST_P(ServerBackendTest, UpdateStopsNearItsDeadlineWithSlowHandlers)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+
+    std::vector<int> received;
+    server.defineAction(1,
+                        [&received](long long&, const MessageView& msg)
+                        {
+                            int value;
+                            msg >> value;
+                            received.push_back(value);
+                            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                        });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+
+    // 50 handlers de 2 ms deja recus: un seul update() en aurait pour 100 ms
+    const int nbMessages = 50;
+    for (int i = 0; i < nbMessages; i++)
+    {
+        Message msg(1);
+        msg << i;
+        client.send(msg);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    server.update(1);
+
+    auto   start      = std::chrono::steady_clock::now();
+    size_t dispatched = server.update(0, std::chrono::milliseconds(10));
+    auto   elapsed    = std::chrono::steady_clock::now() - start;
+
+    EXPECT_LT(elapsed, std::chrono::milliseconds(30));
+    EXPECT_GT(dispatched, 0u);
+    EXPECT_LT(dispatched, static_cast<size_t>(nbMessages - 1));
+
+    // Le reste passe aux tours suivants, dans l'ordre
+    for (int round = 0; round < 100 && received.size() < nbMessages; round++)
+        server.update(0, std::chrono::milliseconds(10));
+    ASSERT_EQ(received.size(), static_cast<size_t>(nbMessages));
+    for (int i = 0; i < nbMessages; i++)
+        EXPECT_EQ(received[i], i);
+}
+
+TEST_P(ServerBackendTest, StopFromAnInlineHandlerEndsTheRound)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+
+    // Les frames suivantes sont encore dans le buffer quand le handler arrete le serveur
+    int calls = 0;
+    server.defineAction(1,
+                        [&server, &calls](long long&, const MessageView&)
+                        {
+                            calls++;
+                            server.stop();
+                        });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+
+    for (int i = 0; i < 3; i++)
+    {
+        Message msg(1);
+        msg << i;
+        client.send(msg);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    for (int round = 0; round < 10 && calls == 0; round++)
+        server.update(0, std::chrono::milliseconds(10));
+
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(server.update(), 0u);
+    EXPECT_THROW(Client("127.0.0.1", port, clientBackend()), std::runtime_error);
+}
+
+TEST_P(ServerBackendTest, ThrowingHandlerLeavesTheServerStoppable)
+{
+    size_t port = nextPort();
+    {
+        Server           server("127.0.0.1", port, GetParam());
+        std::vector<int> handled;
+        server.defineAction(1,
+                            [&server, &handled](long long& clientID, const MessageView& msg)
+                            {
+                                int value;
+                                msg >> value;
+                                handled.push_back(value);
+
+                                Message reply(2);
+                                reply << value;
+                                server.sendTo(reply, clientID);
+                                if (value == 1)
+                                    throw std::runtime_error("handler failed");
+                            });
+        server.start();
+
+        Client client("127.0.0.1", port, clientBackend());
+        server.update();
+
+        std::vector<int> replies;
+        client.defineAction(2,
+                            [&replies](const Message& msg)
+                            {
+                                int value;
+                                msg >> value;
+                                replies.push_back(value);
+                            });
+        for (int i = 0; i < 3; i++)
+        {
+            Message msg(1);
+            msg << i;
+            client.send(msg);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        // Les messages deja traites ne repassent pas, leurs reponses sont parties
+        bool thrown = false;
+        for (int round = 0; round < 10 && !thrown; round++)
+        {
+            try
+            {
+                server.update(0, std::chrono::milliseconds(10));
+            }
+            catch (const std::runtime_error&)
+            {
+                thrown = true;
+            }
+        }
+        ASSERT_TRUE(thrown);
+        for (int round = 0; round < 10 && handled.size() < 3; round++)
+            server.update(0, std::chrono::milliseconds(10));
+        EXPECT_EQ(handled, (std::vector<int>{0, 1, 2}));
+
+        for (int round = 0; round < 10 && replies.size() < 3; round++)
+            client.update(0, std::chrono::milliseconds(10));
+        EXPECT_EQ(replies, (std::vector<int>{0, 1, 2}));
+
+        server.stop();
+        EXPECT_THROW(Client("127.0.0.1", port, clientBackend()), std::runtime_error);
+    }
+
+    // Toutes les sockets ont ete fermees: le port se lie de nouveau
+    Server again("127.0.0.1", port, GetParam());
+    EXPECT_NO_THROW(again.start());
+}
+
+TEST_P(ServerBackendTest, ClientHandlerCanThrowOrReconnect)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView&)
+                        {
+                            for (int i = 0; i < 3; i++)
+                            {
+                                Message reply(2);
+                                reply << i;
+                                server.sendTo(reply, clientID);
+                            }
+                        });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+
+    // Le message qui leve n'est pas rejoue, ni ceux d'avant
+    std::vector<int> received;
+    bool             reconnect = false;
+    client.defineAction(2,
+                        [&](const MessageView& msg)
+                        {
+                            int value;
+                            msg >> value;
+                            received.push_back(value);
+                            if (value == 1 && reconnect)
+                                client.connect("127.0.0.1", port);
+                            else if (value == 1)
+                                throw std::runtime_error("handler failed");
+                        });
+
+    client.send(Message(1));
+    server.update();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    bool thrown = false;
+    for (int round = 0; round < 10 && !thrown; round++)
+    {
+        try
+        {
+            client.update(0, std::chrono::milliseconds(10));
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+    }
+    ASSERT_TRUE(thrown);
+    for (int round = 0; round < 10 && received.size() < 3; round++)
+        client.update(0, std::chrono::milliseconds(10));
+    EXPECT_EQ(received, (std::vector<int>{0, 1, 2}));
+
+    // Reconnecte depuis un handler: les frames de l'ancienne connexion sont abandonnees
+    received.clear();
+    reconnect = true;
+    client.send(Message(1));
+    server.update();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    for (int round = 0; round < 10 && received.size() < 2; round++)
+        client.update(0, std::chrono::milliseconds(10));
+    EXPECT_EQ(received, (std::vector<int>{0, 1}));
+    client.update(0, std::chrono::milliseconds(10));
+    EXPECT_EQ(received, (std::vector<int>{0, 1}));
+}
+
+TEST_P(ServerBackendTest, UpdateReturnsUnderContinuousLoad)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+
+    size_t received = 0;
+    server.defineAction(1, [&received](long long&, const MessageView&) { received++; });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    server.update();
+
+    // Un message toutes les millisecondes: le serveur n'est jamais inactif pendant 10 ms
+    std::atomic<bool> sending{true};
+    std::thread       sender(
+        [&client, &sending]()
+        {
+            Message msg(1);
+            msg << 42;
+            while (sending)
+            {
+                client.send(msg);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+    auto   start      = std::chrono::steady_clock::now();
+    size_t dispatched = server.update(0, std::chrono::milliseconds(30));
+    auto   elapsed    = std::chrono::steady_clock::now() - start;
+
+    sending = false;
+    sender.join();
+
+    EXPECT_LT(elapsed, std::chrono::milliseconds(500));
+    EXPECT_GT(dispatched, 0u);
+    EXPECT_EQ(dispatched, received);
+}
+
+TEST_P(ServerBackendTest, IdleTimeoutPingsThenDropsSilentClients)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    server.setIdleTimeout(std::chrono::milliseconds(300), std::chrono::milliseconds(100));
+
+    int calls = 0;
+    server.defineAction(1, [&calls](long long&, const MessageView&) { calls++; });
+    server.start();
+
+    // Aucun des deux n'envoie rien: seul celui qui appelle update() repond aux pings
+    Client answering("127.0.0.1", port, clientBackend());
+    Client silent("127.0.0.1", port, clientBackend());
+
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(700))
+    {
+        server.update();
+        answering.update();
+    }
+
+    EXPECT_EQ(server.metrics().idleClients, 1u);
+    EXPECT_GE(server.metrics().pingsSent, 3u);
+
+    Message msg(1);
+    msg << 1;
+    answering.send(msg);
+    for (int round = 0; round < 20 && calls == 0; round++)
+        server.update();
+    EXPECT_EQ(calls, 1);
+    EXPECT_THROW(server.setIdleTimeout(std::chrono::milliseconds(100),
+                                       std::chrono::milliseconds(100)),
+                 std::invalid_argument);
+}
+
+TEST_P(ServerBackendTest, StatsMatchTheTrafficOnBothSides)
+{
+    size_t port = nextPort();
+    Server server("127.0.0.1", port, GetParam());
+    server.stats().setTiming(true);
+    server.defineAction(1,
+                        [&server](long long& clientID, const MessageView&)
+                        {
+                            Message reply(2);
+                            reply << 42;
+                            server.sendTo(reply, clientID);
+                        });
+    server.start();
+
+    Client client("127.0.0.1", port, clientBackend());
+    client.stats().setTiming(true);
+    int replies = 0;
+    client.defineAction(2, [&replies](const MessageView&) { replies++; });
+
+    for (int i = 0; i < 10; i++)
+    {
+        Message msg(1);
+        msg << std::string(100, 'x');
+        client.send(msg);
+    }
+    client.send(Message(3));
+    for (int round = 0; round < 50 && replies < 10; round++)
+    {
+        server.update();
+        client.update();
+    }
+    ASSERT_EQ(replies, 10);
+
+    NetStats::Snapshot serverStats = server.stats().snapshot();
+    NetStats::Snapshot clientStats = client.stats().snapshot();
+    EXPECT_EQ(serverStats.connections, 1u);
+    EXPECT_EQ(clientStats.connections, 1u);
+    EXPECT_EQ(serverStats.bytesIn, clientStats.bytesOut);
+    EXPECT_EQ(clientStats.bytesIn, serverStats.bytesOut);
+    EXPECT_EQ(serverStats.framesIn, 11u);
+    EXPECT_EQ(clientStats.framesOut, 11u);
+    EXPECT_EQ(serverStats.framesOut, 10u);
+    EXPECT_EQ(clientStats.framesIn, 10u);
+    EXPECT_EQ(serverStats.outputQueued, 0u);
+
+    // Les frames sans handler sont comptees par type, mais pas chronometrees
+    std::map<Message::Type, uint64_t> frames;
+    for (const NetStats::TypeCount& count : serverStats.types)
+        frames[count.type] = count.frames;
+    EXPECT_EQ(frames[1], 10u);
+    EXPECT_EQ(frames[3], 1u);
+    EXPECT_EQ(serverStats.handlerTime.count, 10u);
+    EXPECT_EQ(serverStats.dispatchDelay.count, 10u);
+    EXPECT_EQ(clientStats.handlerTime.count, 10u);
+
+    client.disconnect();
+    for (int round = 0; round < 20 && server.stats().snapshot().connections > 0; round++)
+        server.update();
+    EXPECT_EQ(server.stats().snapshot().connections, 0u);
+    EXPECT_EQ(client.stats().snapshot().connections, 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends,
+                         ServerBackendTest,
+                         ::testing::Values(Server::Backend::SELECT,
+                                           Server::Backend::EPOLL,
+                                           Server::Backend::IO_URING));
+
+TEST(ServerWorkerPoolTest, HandlersKeepPerClientOrderAndReplyFromWorkers)
+{
+    const size_t port = 19190;
+    WorkerPool   pool(4);
+    Server       server("127.0.0.1", port, Server::Backend::EPOLL);
+    server.setWorkerPool(&pool);
+
+    std::mutex                            mutex;
+    std::map<long long, std::vector<int>> seen;
+    server.defineAction(1,
+                        [&](long long& clientID, const MessageView& msg)
+                        {
+                            int value;
+                            msg >> value;
+                            {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                seen[clientID].push_back(value);
+                            }
+                            Message reply(2);
+                            reply << value;
+                            server.sendTo(reply, clientID);
+                        });
+    server.start();
+
+    const int           nbMessages = 50;
+    std::vector<Client> clients(3);
+    std::vector<int>    replies(clients.size(), 0);
+    std::vector<bool>   inOrder(clients.size(), true);
+    for (size_t c = 0; c < clients.size(); c++)
+    {
+        clients[c].connect("127.0.0.1", port);
+        clients[c].defineAction(2,
+                                [&replies, &inOrder, c](const MessageView& msg)
+                                {
+                                    int value;
+                                    msg >> value;
+                                    inOrder[c] = inOrder[c] && value == replies[c];
+                                    replies[c]++;
+                                });
+        for (int i = 0; i < nbMessages; i++)
+        {
+            Message msg(1);
+            msg << i;
+            clients[c].send(msg);
+        }
+    }
+
+    for (int round = 0; round < 300; round++)
+    {
+        server.update();
+        bool done = true;
+        for (size_t c = 0; c < clients.size(); c++)
+        {
+            clients[c].update();
+            done = done && replies[c] == nbMessages;
+        }
+        if (done)
+            break;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(seen.size(), clients.size());
+    for (auto& [clientId, values] : seen)
+    {
+        ASSERT_EQ(values.size(), static_cast<size_t>(nbMessages));
+        for (int i = 0; i < nbMessages; i++)
+            EXPECT_EQ(values[i], i);
+    }
+    for (size_t c = 0; c < clients.size(); c++)
+    {
+        EXPECT_EQ(replies[c], nbMessages);
+        EXPECT_TRUE(inOrder[c]);
+    }
+}
+
+TEST(ServerWorkerPoolTest, SlowHandlerDoesNotBlockUpdate)
+{
+    const size_t port = 19191;
+    WorkerPool   pool(2);
+    Server       server("127.0.0.1", port, Server::Backend::EPOLL);
+    server.setWorkerPool(&pool);
+
+    std::atomic<int> handled{0};
+    server.defineAction(1,
+                        [&handled](long long&, const MessageView&)
+                        {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(300));
+                            handled++;
+                        });
+    server.start();
+
+    Client  client("127.0.0.1", port);
+    Message msg(1);
+    msg << 1;
+    client.send(msg);
+
+    auto start = std::chrono::steady_clock::now();
+    server.update();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_LT(elapsed, std::chrono::milliseconds(200));
+    EXPECT_EQ(handled.load(), 0);
+
+    // stop() attend les handlers en cours
+    server.stop();
+    EXPECT_EQ(handled.load(), 1);
+}
+
+TEST(ServerWorkerPoolTest, StopFromAHandlerIsDoneByTheUpdateThread)
+{
+    const size_t port = 19192;
+    WorkerPool   pool(2);
+    Server       server("127.0.0.1", port, Server::Backend::EPOLL);
+    server.setWorkerPool(&pool);
+
+    // stop() depuis un worker ne peut pas attendre son propre handler: il rend la main
+    std::atomic<bool> stopped{false};
+    server.defineAction(1,
+                        [&server, &stopped](long long&, const MessageView&)
+                        {
+                            server.stop();
+                            stopped = true;
+                        });
+    server.start();
+
+    Client  client("127.0.0.1", port);
+    Message msg(1);
+    msg << 1;
+    client.send(msg);
+
+    for (int round = 0; round < 100 && !stopped; round++)
+        server.update(0, std::chrono::milliseconds(10));
+    ASSERT_TRUE(stopped);
+
+    // Le tour suivant de update() ferme le serveur
+    server.update(0, std::chrono::milliseconds(10));
+    EXPECT_THROW(Client("127.0.0.1", port), std::runtime_error);
+}
@@ -143,3 +143,20 @@ TEST(ThreadSafeQueue_ConcurrentPushPopManyThreads, StressTestProducersConsumers)
     }
     EXPECT_EQ(sum.load(), expected_sum);
 }
+
+TEST(ThreadSafeQueueTest, TryPopFrontDoesNotThrowWhenEmpty)
+{
+    ThreadSafeQueue<int> q;
+    int                  value = -1;
+
+    EXPECT_FALSE(q.try_pop_front(value));
+    EXPECT_EQ(value, -1);
+
+    q.push_back(1);
+    q.push_back(2);
+    EXPECT_TRUE(q.try_pop_front(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(q.try_pop_front(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(q.try_pop_front(value));
+}
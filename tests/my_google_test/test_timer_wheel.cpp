@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+#include "libftpp.hpp"
+
+using Clock = TimerWheel::Clock;
+using std::chrono::milliseconds;
+
+TEST(TimerWheelTest, FiresOnTheTickOfItsDeadlineNeverBefore)
+{
+    Clock::time_point   start = Clock::now();
+    TimerWheel          wheel(milliseconds(10), start);
+    std::vector<size_t> fired;
+    auto                record = [&fired](size_t key) { fired.push_back(key); };
+
+    wheel.schedule(1, start + milliseconds(25));
+    wheel.schedule(2, start + milliseconds(5));
+    wheel.schedule(3, start + milliseconds(1000));
+    EXPECT_EQ(wheel.size(), 3u);
+
+    EXPECT_EQ(wheel.advance(start + milliseconds(9), record), 0u);
+    EXPECT_EQ(wheel.advance(start + milliseconds(10), record), 1u);
+
+    // 25 ms arrondi au tick superieur: 30 ms
+    EXPECT_EQ(wheel.advance(start + milliseconds(29), record), 0u);
+    EXPECT_EQ(wheel.advance(start + milliseconds(30), record), 1u);
+    EXPECT_EQ(wheel.advance(start + milliseconds(999), record), 0u);
+    EXPECT_EQ(wheel.advance(start + milliseconds(1000), record), 1u);
+
+    EXPECT_EQ(fired, (std::vector<size_t>{2, 1, 3}));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheelTest, RescheduleMovesAndCancelRemoves)
+{
+    Clock::time_point start = Clock::now();
+    TimerWheel        wheel(milliseconds(1), start);
+    size_t            fired = 0;
+    auto              count = [&fired](size_t) { fired++; };
+
+    wheel.schedule(7, start + milliseconds(50));
+    wheel.schedule(7, start + milliseconds(100));
+    EXPECT_EQ(wheel.size(), 1u);
+    wheel.advance(start + milliseconds(60), count);
+    EXPECT_EQ(fired, 0u);
+    EXPECT_TRUE(wheel.scheduled(7));
+
+    EXPECT_TRUE(wheel.cancel(7));
+    EXPECT_FALSE(wheel.cancel(7));
+    EXPECT_FALSE(wheel.scheduled(42));
+    wheel.advance(start + milliseconds(200), count);
+    EXPECT_EQ(fired, 0u);
+
+    // Echeance deja passee: le prochain tick
+    wheel.schedule(3, start);
+    wheel.advance(start + milliseconds(201), count);
+    EXPECT_EQ(fired, 1u);
+}
+
+TEST(TimerWheelTest, DistantDeadlinesCascadeDownOnTime)
+{
+    Clock::time_point start = Clock::now();
+    TimerWheel        wheel(milliseconds(1), start);
+
+    // Une echeance par roue, et une au-dela de la derniere (64^4 ticks)
+    std::vector<long long> ticks = {63, 64 * 64 + 5, 2 * 64 * 64 * 64 + 7, 16777216 + 100};
+    for (size_t key = 0; key < ticks.size(); key++)
+        wheel.schedule(key, start + milliseconds(ticks[key]));
+
+    std::vector<size_t> fired;
+    auto                record = [&fired](size_t key) { fired.push_back(key); };
+    for (size_t key = 0; key < ticks.size(); key++)
+    {
+        wheel.advance(start + milliseconds(ticks[key] - 1), record);
+        EXPECT_EQ(fired.size(), key) << "timer " << key << " fired early";
+        wheel.advance(start + milliseconds(ticks[key]), record);
+        ASSERT_EQ(fired.size(), key + 1) << "timer " << key << " is late";
+        EXPECT_EQ(fired.back(), key);
+    }
+}
+
+TEST(TimerWheelTest, CallbackMayRearmItsOwnKey)
+{
+    Clock::time_point start = Clock::now();
+    TimerWheel        wheel(milliseconds(1), start);
+    Clock::time_point now   = start;
+    size_t            fired = 0;
+
+    // Timer periodique: rearme depuis son propre callback, toutes les 10 ms
+    wheel.schedule(0, start + milliseconds(10));
+    for (int ms = 1; ms <= 100; ms++)
+    {
+        now = start + milliseconds(ms);
+        wheel.advance(now,
+                      [&](size_t key)
+                      {
+                          fired++;
+                          wheel.schedule(key, now + milliseconds(10));
+                      });
+    }
+    EXPECT_EQ(fired, 10u);
+    EXPECT_TRUE(wheel.scheduled(0));
+    EXPECT_THROW(TimerWheel(milliseconds(0)), std::invalid_argument);
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "libftpp.hpp"
+
+using Clock = TokenBucket::Clock;
+
+TEST(TokenBucketTest, UnlimitedBucketNeverRunsOut)
+{
+    TokenBucket bucket;
+    EXPECT_TRUE(bucket.unlimited());
+    bucket.consume(1e12);
+    EXPECT_EQ(bucket.allowance(4096), 4096u);
+    EXPECT_EQ(bucket.delay(1e9), Clock::duration::zero());
+}
+
+TEST(TokenBucketTest, BurstThenSustainedRate)
+{
+    TokenBucket       bucket(1000, 100); // 1000 jetons/s, rafale de 100
+    Clock::time_point start = Clock::now();
+
+    EXPECT_EQ(bucket.allowance(500, start), 100u);
+    bucket.consume(100);
+    EXPECT_EQ(bucket.allowance(1, start), 0u);
+
+    // 10 ms plus tard: 10 jetons de plus
+    Clock::time_point later = start + std::chrono::milliseconds(10);
+    EXPECT_EQ(bucket.allowance(500, later), 10u);
+
+    // Le seau ne depasse jamais sa capacite
+    EXPECT_EQ(bucket.allowance(500, start + std::chrono::seconds(10)), 100u);
+}
+
+TEST(TokenBucketTest, DebtIsRepaidBeforeAnythingElse)
+{
+    TokenBucket       bucket(1000, 100);
+    Clock::time_point start = Clock::now();
+
+    EXPECT_EQ(bucket.allowance(100, start), 100u);
+    bucket.consume(300); // 200 jetons de dette
+
+    EXPECT_EQ(bucket.allowance(1, start + std::chrono::milliseconds(150)), 0u);
+    EXPECT_EQ(bucket.allowance(100, start + std::chrono::milliseconds(250)), 50u);
+
+    // Attente jusqu'a 100 jetons, plafonnee a la capacite pour une demande plus grande
+    Clock::duration wait = bucket.delay(1000, start + std::chrono::milliseconds(250));
+    EXPECT_GE(wait, std::chrono::milliseconds(50));
+    EXPECT_LE(wait, std::chrono::milliseconds(51));
+}
+
+TEST(TokenBucketTest, NegativeRateThrows)
+{
+    EXPECT_THROW(TokenBucket(-1, 10), std::invalid_argument);
+    EXPECT_THROW(TokenBucket(10, -1), std::invalid_argument);
+}